@@ -71,7 +71,12 @@ int main() {
   auto renderer = std::dynamic_pointer_cast<FractalRenderer>(f->renderer());
   auto shader = renderer->shader();
 
-  f->SetPosition(glm::vec3(0, 0, 1));
+  // the transform belongs to the update threads, set it from one of them
+  core->Spawn([](std::shared_ptr<content::objects::Fractal> fractal)
+                  -> engine::core::Task {
+    fractal->SetPosition(glm::vec3(0, 0, 1));
+    co_return;
+  }(f));
 
       
 
@@ -95,6 +100,10 @@ int main() {
 
   while (!window->ShouldClose()) {
     shader_update_lambda();
+    // state of the last finished tick, read by the renderers; the main
+    // thread never touches the live transforms
+    auto const& frame = engine::core::RenderSnapshot::Objects().Acquire();
+    glm::mat4x3 const* fractal_model = frame.model_matrix(f->entity());
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
     glClearColor(0.1F, 0.1F, 0.15F, 1.0F);
     glm::mat4 matrix = glm::perspective(player.camera()->FOV(),
@@ -105,13 +114,21 @@ int main() {
     shader.lock()->Use();
     shader.lock()->SetMat4("fullMatrix", matrix);
     shader.lock()->SetFloat("time", (float)glfwGetTime());
-    renderer->Draw(f);
+    // not published before the first tick boundary after its creation
+    if (fractal_model != nullptr) {
+      renderer->Draw(f);
+    }
     window->SwapBuffers();
     window->PollEvents();
-    double t = abs(player.position().z -  f->position().z);
-    double u = log1p(t);
-    player.SetVelocity((float)u);
+    if (fractal_model != nullptr) {
+      double t = abs(player.position().z - (*fractal_model)[3].z);
+      double u = log1p(t);
+      player.SetVelocity((float)u);
+    }
   }
+  // the update threads keep the Core alive, stop them before the window
+  // and the objects they tick are destroyed
+  core->Stop();
 }
 /*
 uniform mat4 model;
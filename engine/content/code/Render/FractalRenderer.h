@@ -32,7 +32,12 @@ class FractalRenderer : public engine::client::render::Renderer {
   }
 
   void Draw(std::weak_ptr<engine::core::Object> object) override {
-    fractal_shader_->SetMat4("model", object.lock().get()->model_matrix());
+    auto model = object.lock().get()->published_model_matrix();
+    // not published before the first tick boundary after its creation
+    if (!model) {
+      return;
+    }
+    fractal_shader_->SetMat4("model", *model);
     mesh_->Draw(fractal_shader_);
   }
 
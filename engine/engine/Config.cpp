@@ -0,0 +1,6 @@
+#include "Config.h"
+namespace engine::core {
+
+std::shared_ptr<Config> Config::config_ptr_ = std::shared_ptr<Config>(nullptr);
+std::mutex Config::config_creation_mutex_;
+}  // namespace engine::core
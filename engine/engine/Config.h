@@ -1,5 +1,8 @@
+#pragma once
 #include <memory>
 #include <mutex>
+#include <fstream>
+#include <string_view>
 #include <glm/glm.hpp>
 #include <unordered_map>
 #include <iostream>
@@ -31,31 +34,31 @@ class Config {
     return config_ptr_;
   }
 
-  static std::string_view version() inline noexcept { 
+  static std::string_view version() noexcept { 
     return kEngineVersion; 
   }
 
-  static std::string_view version_major() inline noexcept {
+  static std::string_view version_major() noexcept {
     return kEngineVersionMajor;
   }
 
-  static std::string_view version_minor() inline noexcept {
+  static std::string_view version_minor() noexcept {
     return kEngineVersionMinor;
   }
 
-  static std::string_view version_patch() inline noexcept {
+  static std::string_view version_patch() noexcept {
     return kEngineVersionPatch;
   }
 
-  static uint32_t OGL_version_major() inline noexcept {
+  static uint32_t OGL_version_major() noexcept {
     return kOpenGLVersionMajor;
   }
 
-  static uint32_t OGL_version_minor() inline noexcept {
+  static uint32_t OGL_version_minor() noexcept {
     return kOpenGLVersionMinor;
   }
 
-  std::string_view operator[](std::string temp) const inline noexcept {
+  std::string_view operator[](std::string const& temp) const noexcept {
     if (config_.find(temp) == config_.end()) {
       return "";
     }
@@ -69,9 +72,14 @@ class Config {
     conf_file.open("config.json");
     std::string conf((std::istreambuf_iterator<char>(conf_file)),
                     std::istreambuf_iterator<char>());
-    auto temp = nlohmann::json::parse(conf);
+    // a missing or broken file leaves the config empty, every caller has
+    // to handle absent keys anyway
+    auto temp = nlohmann::json::parse(conf, nullptr, false);
+    if (temp.is_discarded() || !temp.is_object()) {
+      return;
+    }
     for (auto& [key, val] : temp.items()) {
-      config_[key] = std::string(val);
+      config_[key] = val.is_string() ? val.get<std::string>() : val.dump();
     }
   }
 
@@ -1,4 +1,12 @@
 #include "Core.h"
+
+#include <typeindex>
+#include <unordered_map>
+
+#include "Config.h"
+#include "Object.h"
+#include "core/Affinity.h"
+#include "core/World.h"
 namespace engine::core {
 
 std::shared_ptr<Core> Core::core_ptr_ = std::shared_ptr<Core>(nullptr);
@@ -17,15 +25,9 @@ std::shared_ptr<Core> Core::GetInstance() noexcept {
   return core_ptr_;
 }
 
-double Core::time() {
-  std::chrono::time_point<std::chrono::system_clock> now =
-      std::chrono::system_clock::now();
-  double microseconds =
-      (double)std::chrono::duration_cast<std::chrono::microseconds>(
-          now.time_since_epoch())
-          .count();
-  return microseconds / 1e6;
-}
+double Core::time() { return double(Clock::Now()) / 1e9; }
+
+int64_t Core::timestamp() noexcept { return Clock::Now(); }
 
 uint64_t Core::global_tick() noexcept { return core_ptr_->global_tick_; }
 
@@ -33,175 +35,1037 @@ uint32_t Core::CalcTickrate(uint32_t times_per_second) {
   return (uint32_t)ceil(double(core_ptr_->tickrate_) / times_per_second);
 }
 
-double Core::tick_delta() { return core_ptr_->last_tick_timedelta_; }
+double Core::tick_delta() { return double(tick_delta_ns()) / 1e9; }
+
+int64_t Core::tick_delta_ns() noexcept {
+  return core_ptr_->last_tick_timedelta_.load(std::memory_order_relaxed);
+}
+
+int64_t Core::tick_timestamp() noexcept {
+  return core_ptr_->last_tick_timestamp_.load(std::memory_order_relaxed);
+}
+
+namespace {
+// ticker currently updated by this thread and the number of objects it
+// added so far, orders objects added from Update in deterministic mode
+thread_local Ticker const* current_ticker = nullptr;
+thread_local uint64_t current_ticker_adds = 0;
+// index of the update thread running on this thread, SIZE_MAX on other
+// threads
+thread_local size_t current_thread_index = SIZE_MAX;
+
+uint64_t Mix(uint64_t x) noexcept {
+  // splitmix64 finalizer
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ull;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBull;
+  x ^= x >> 31;
+  return x;
+}
+
+// Object tickers run in the default system and write their transforms,
+// so systems of World::Objects() touching them are ordered after it
+SystemDesc DefaultSystem() {
+  SystemDesc desc;
+  desc.writes.push_back(ObjectTransformResource());
+  return desc;
+}
+}  // namespace
 
 int Core::AddTickingObject(std::weak_ptr<Ticker> object) {
   auto temp = object.lock();
   if (temp == nullptr || threads_.empty()) {
     return 0;
   }
-  std::scoped_lock<std::mutex> lock(threads_mutex_);
+  if (deterministic()) {
+    StageObject(std::move(object));
+    return 1;
+  }
+  AssignPhase(*temp);
+  UpdateThread* thread = BoundThread(*temp);
+  if (thread == nullptr) {
+    thread = LeastLoadedThread();
+  }
+  thread->AddObject(std::move(object));
+  return 1;
+}
+
+size_t Core::AddTickingObjects(
+    std::span<const std::weak_ptr<Ticker>> objects) {
+  if (threads_.empty()) {
+    return 0;
+  }
+  if (deterministic()) {
+    size_t added = 0;
+    for (auto const& object : objects) {
+      if (!object.expired()) {
+        StageObject(object);
+        added++;
+      }
+    }
+    return added;
+  }
+  // unbound objects are dealt round-robin starting from the least loaded
+  // thread, each thread receives its share as one batch
+  std::vector<UpdateThread*> order;
+  order.reserve(threads_.size());
+  for (auto const& thread : threads_) {
+    if (thread->placement().accepts_work) {
+      order.push_back(thread.get());
+    }
+  }
+  std::sort(order.begin(), order.end(),
+            [](UpdateThread const* a, UpdateThread const* b) {
+              return a->exec_time() < b->exec_time();
+            });
+  std::vector<std::vector<std::weak_ptr<Ticker>>> batches(threads_.size());
+  size_t added = 0;
+  size_t next = 0;
+  for (auto const& object : objects) {
+    auto temp = object.lock();
+    if (temp == nullptr) {
+      continue;
+    }
+    AssignPhase(*temp);
+    UpdateThread* thread = BoundThread(*temp);
+    if (thread == nullptr) {
+      thread = order[next++ % order.size()];
+    }
+    batches[thread->index()].push_back(object);
+    added++;
+  }
+  for (size_t i = 0; i < threads_.size(); i++) {
+    threads_[i]->AddObjects(batches[i]);
+  }
+  return added;
+}
 
-  // add object thread with desired id
-  if (!temp->thread_id().expired()) {
-    auto k = temp->thread_id().lock();
+void Core::StageObject(std::weak_ptr<Ticker> object) {
+  std::scoped_lock<std::mutex> lock(pending_mutex_);
+  if (current_ticker != nullptr) {
+    pending_objects_.push_back(
+        {current_ticker->id(), current_ticker_adds++, std::move(object)});
+  } else {
+    pending_objects_.push_back(
+        {0, external_sequence_++, std::move(object)});
+  }
+}
 
-    auto t = std::find_if(std::begin(threads_), std::end(threads_),
-                          [&k](std::unique_ptr<UpdateThread> const& thread) {
-                            return *k == thread->thread_id();
-                          });
-    t->get()->AddObject(object);
-    return 1;
+void Core::MergePendingObjects() {
+  std::vector<PendingObject> pending;
+  {
+    std::scoped_lock<std::mutex> lock(pending_mutex_);
+    pending.swap(pending_objects_);
+    external_sequence_ = 0;
+  }
+  std::sort(pending.begin(), pending.end(),
+            [](PendingObject const& a, PendingObject const& b) {
+              return a.parent != b.parent ? a.parent < b.parent
+                                          : a.sequence < b.sequence;
+            });
+  std::vector<UpdateThread*> workers;
+  for (auto const& thread : threads_) {
+    if (thread->placement().accepts_work) {
+      workers.push_back(thread.get());
+    }
   }
+  for (auto& entry : pending) {
+    auto object = entry.object.lock();
+    if (object == nullptr) {
+      continue;
+    }
+    if (object->id_ == 0) {
+      object->id_ = next_object_id_++;
+    }
+    AssignPhase(*object);
+    UpdateThread* thread = BoundThread(*object);
+    if (thread == nullptr) {
+      thread = workers[object->id_ % workers.size()];
+    }
+    // drained by the owner before the next round
+    thread->AddObject(std::move(entry.object));
+  }
+}
 
+void Core::PublishStateHash() {
+  uint64_t hash = 0;
+  for (auto const& thread : threads_) {
+    hash += thread->TakeStateHash();
+  }
+  if (state_hash_callback_) {
+    state_hash_callback_(global_tick_, hash);
+  }
+}
+
+void Core::AssignPhase(Ticker& object) noexcept {
+  if (object.phase_ != Ticker::kAutoPhase || object.tickrate() <= 1) {
+    return;
+  }
+  const uint64_t key = (uint64_t(object.domain()) << 32) | object.tickrate();
+  const size_t counter =
+      size_t((key * 0x9E3779B97F4A7C15ull) >> 32) % kPhaseCounters;
+  object.phase_ =
+      phase_counters_[counter].fetch_add(1, std::memory_order_relaxed) %
+      object.tickrate();
+}
+
+Core::UpdateThread* Core::BoundThread(Ticker const& object) const {
+  auto id = object.thread_id().lock();
+  if (id == nullptr) {
+    return nullptr;
+  }
+  auto t = std::find_if(std::begin(threads_), std::end(threads_),
+                        [&id](std::unique_ptr<UpdateThread> const& thread) {
+                          return *id == thread->thread_id();
+                        });
+  return t == std::end(threads_) ? nullptr : t->get();
+}
+
+Core::UpdateThread* Core::LeastLoadedThread() const {
   // search for the thread with minimum execution time
-  auto min_execution_thread = threads_.begin();
-  for (auto i = threads_.begin() + 1; i != threads_.end(); i++) {
-    if ((*i).get()->exec_time() < min_execution_thread->get()->exec_time()) {
-      min_execution_thread = i;
+  UpdateThread* min_execution_thread = nullptr;
+  for (auto const& thread : threads_) {
+    if (!thread->placement().accepts_work) {
+      continue;
+    }
+    if (min_execution_thread == nullptr ||
+        thread->exec_time() < min_execution_thread->exec_time()) {
+      min_execution_thread = thread.get();
     }
   }
-  min_execution_thread->get()->AddObject(object);
+  return min_execution_thread;
+}
 
-  return 1;
+std::chrono::nanoseconds Core::ThreadReady(std::thread::id id) {
+  if (operational_thread_id_ != id) {
+    return barrier_->ArriveAndWait();
+  }
+  return barrier_->ArriveAndComplete([this]() { CompleteTick(); });
 }
 
-std::chrono::nanoseconds Core::calc_overhead() {
-  using namespace std::chrono;
-  constexpr size_t tests = 1001;
-  constexpr auto timer = 200us;
+void Core::CompleteTick() {
+  if (round_start_ != 0) {
+    tick_costs_.Record(Clock::Now() - round_start_);
+  }
+  if (++round_ < rounds_) {
+    BeginRound();
+    return;
+  }
+
+  if (deterministic()) {
+    PublishStateHash();
+  }
+  CollectMetrics();
+  // every update thread is parked: structural changes deferred during the
+  // tick can't move components under a running ticker, and the transforms
+  // of this tick are final
+  World::FlushAll();
+  RenderSnapshot::Objects().Publish(global_tick_);
+  const Control control = AwaitControl();
+  if (control == Control::kStop) {
+    stopping_ = true;
+    return;
+  }
+  if (deterministic()) {
+    MergePendingObjects();
+  }
+
+  constexpr int64_t kSecond = 1'000'000'000;
+  int64_t now = Clock::Now();
+  int64_t deadline = now;
+  if (control == Control::kRun) {
+    if (resume_pacing_) {
+      // don't catch up on the time spent paused
+      resume_pacing_ = false;
+      pacing_origin_ = now;
+      paced_ticks_ = 0;
+      simulated_time_ = now;
+    }
+    paced_ticks_ += 1;
+    deadline = pacing_origin_ + paced_ticks_ * kSecond / tickrate_;
+    if (now < deadline) {
+      pacer_.SleepUntil(Clock::ToTimePoint(deadline));
+      now = Clock::Now();
+    } else if (now - deadline > kSecond / tickrate_) {
+      // we are more than a tick behind, pacing restarts from now and the
+      // domains catch up on the lost time
+      pacing_origin_ = now;
+      paced_ticks_ = 0;
+    }
+  }
+  int64_t simulated_time;
+  if (control == Control::kStep || deterministic()) {
+    // exactly one interval per tick, a late tick slows the simulation down
+    // instead of being caught up. The interval lengths come from a counter
+    // of their own, so their rounding is the same in every run.
+    fixed_intervals_ += 1;
+    simulated_time = simulated_time_ +
+                     (fixed_intervals_ * kSecond / tickrate_ -
+                      (fixed_intervals_ - 1) * kSecond / tickrate_);
+  } else {
+    // simulated time follows the deadlines, so wake-up jitter doesn't make
+    // a domain skip or double a step, and follows the clock when we are
+    // late
+    simulated_time = std::max(now, deadline);
+  }
+
+  {
+    std::scoped_lock<std::mutex> lock(graph_mutex_);
+    if (graph_dirty_) {
+      graph_ = next_graph_;
+      graph_dirty_ = false;
+    }
+  }
+  {
+    std::scoped_lock<std::mutex> lock(domains_mutex_);
+    rounds_ = domains_.Advance(simulated_time - simulated_time_);
+    if (domain_rates_.size() != domains_.size()) {
+      domain_rates_ = domains_.rates();
+    }
+  }
+  simulated_time_ = simulated_time;
+  round_ = 0;
+
+  intervals_ += 1;
+  // once per second, work stays where it is in deterministic mode
+  if (intervals_ % tickrate_ == 0 && !deterministic()) {
+    Rebalance();
+  }
+  last_tick_timedelta_.store(
+      now - last_tick_timestamp_.load(std::memory_order_relaxed),
+      std::memory_order_relaxed);
+  last_tick_timestamp_.store(now, std::memory_order_relaxed);
+  BeginRound();
+}
+
+Core::Control Core::AwaitControl() {
+  bool waited = false;
+  while (true) {
+    // read before the state and the metrics request, so that a change of
+    // either after this point makes the wait below return
+    const uint32_t control = control_.load(std::memory_order_seq_cst);
+    const auto state = RunState(state_.load(std::memory_order_acquire));
+    if (state == RunState::kStopping || state == RunState::kStopped) {
+      return Control::kStop;
+    }
+    if (state == RunState::kRunning) {
+      resume_pacing_ = resume_pacing_ || waited;
+      parked_.store(false, std::memory_order_release);
+      return Control::kRun;
+    }
+    if (state == RunState::kStepping) {
+      uint32_t left = steps_left_.load(std::memory_order_acquire);
+      while (left != 0 && !steps_left_.compare_exchange_weak(
+                              left, left - 1, std::memory_order_acq_rel)) {
+      }
+      if (left != 0) {
+        // leaving step mode always goes through a pause
+        resume_pacing_ = true;
+        parked_.store(false, std::memory_order_release);
+        return Control::kStep;
+      }
+      auto expected = uint32_t(RunState::kStepping);
+      state_.compare_exchange_strong(expected, uint32_t(RunState::kPaused),
+                                     std::memory_order_acq_rel);
+      continue;
+    }
+    // paused
+    if (!parked_.load(std::memory_order_relaxed)) {
+      parked_.store(true, std::memory_order_release);
+      settled_.fetch_add(1, std::memory_order_acq_rel);
+      FutexWakeAll(settled_);
+    }
+    // QueryTickerMetrics wakes us while paused
+    CollectMetrics();
+    waited = true;
+    FutexWait(control_, control);
+  }
+}
+
+bool Core::Pause() {
+  const uint32_t generation = settled_.load(std::memory_order_acquire);
+  uint32_t state = state_.load(std::memory_order_acquire);
+  do {
+    if (state == uint32_t(RunState::kPaused)) {
+      if (parked_.load(std::memory_order_acquire)) {
+        return true;
+      }
+      break;
+    }
+    if (state != uint32_t(RunState::kRunning) &&
+        state != uint32_t(RunState::kStepping)) {
+      return false;
+    }
+  } while (!state_.compare_exchange_weak(state, uint32_t(RunState::kPaused),
+                                         std::memory_order_acq_rel));
+  steps_left_.store(0, std::memory_order_release);
+  WaitSettled(generation);
+  return true;
+}
+
+bool Core::Resume() {
+  uint32_t state = state_.load(std::memory_order_acquire);
+  do {
+    if (state == uint32_t(RunState::kRunning)) {
+      return true;
+    }
+    if (state != uint32_t(RunState::kPaused) &&
+        state != uint32_t(RunState::kStepping)) {
+      return false;
+    }
+  } while (!state_.compare_exchange_weak(state, uint32_t(RunState::kRunning),
+                                         std::memory_order_acq_rel));
+  steps_left_.store(0, std::memory_order_release);
+  WakeControl();
+  return true;
+}
+
+bool Core::Step(uint32_t ticks) {
+  const uint32_t generation = settled_.load(std::memory_order_acquire);
+  // the steps have to be there before the tick loop sees kStepping
+  steps_left_.fetch_add(ticks, std::memory_order_acq_rel);
+  uint32_t state = state_.load(std::memory_order_acquire);
+  do {
+    if (state != uint32_t(RunState::kPaused) &&
+        state != uint32_t(RunState::kStepping)) {
+      steps_left_.fetch_sub(ticks, std::memory_order_acq_rel);
+      return false;
+    }
+  } while (!state_.compare_exchange_weak(state,
+                                         uint32_t(RunState::kStepping),
+                                         std::memory_order_acq_rel));
+  WakeControl();
+  WaitSettled(generation);
+  return true;
+}
+
+void Core::Stop() {
+  uint32_t state = state_.load(std::memory_order_acquire);
+  do {
+    if (state == uint32_t(RunState::kStopping) ||
+        state == uint32_t(RunState::kStopped)) {
+      break;
+    }
+  } while (!state_.compare_exchange_weak(state,
+                                         uint32_t(RunState::kStopping),
+                                         std::memory_order_acq_rel));
+  WakeControl();
+  settled_.fetch_add(1, std::memory_order_acq_rel);
+  FutexWakeAll(settled_);
+  // a query waiting for the tick loop is served no more
+  metrics_generation_.fetch_add(1, std::memory_order_acq_rel);
+  FutexWakeAll(metrics_generation_);
+  if (IsUpdateThread()) {
+    return;
+  }
+  std::scoped_lock<std::mutex> lock(stop_mutex_);
+  for (auto& thread : threads_) {
+    thread->Join();
+  }
+  state_.store(uint32_t(RunState::kStopped), std::memory_order_release);
+}
+
+void Core::WaitSettled(uint32_t generation) {
+  if (IsUpdateThread()) {
+    return;
+  }
+  while (true) {
+    const uint32_t current = settled_.load(std::memory_order_acquire);
+    const auto state = RunState(state_.load(std::memory_order_acquire));
+    if (state == RunState::kStopping || state == RunState::kStopped ||
+        (current != generation && parked_.load(std::memory_order_acquire))) {
+      return;
+    }
+    FutexWait(settled_, current);
+  }
+}
+
+void Core::WakeControl() noexcept {
+  control_.fetch_add(1, std::memory_order_seq_cst);
+  FutexWakeAll(control_);
+}
+
+std::vector<TickerMetrics> Core::QueryTickerMetrics() {
+  ticker_histograms_.store(true, std::memory_order_relaxed);
+  const uint32_t generation =
+      metrics_generation_.load(std::memory_order_acquire);
+  metrics_requested_.store(true, std::memory_order_release);
+  if (!IsUpdateThread()) {
+    // wakes a paused tick loop, it serves the request and parks again
+    WakeControl();
+    while (true) {
+      const uint32_t current =
+          metrics_generation_.load(std::memory_order_acquire);
+      const auto state = RunState(state_.load(std::memory_order_acquire));
+      if (current != generation || state == RunState::kStopping ||
+          state == RunState::kStopped) {
+        break;
+      }
+      FutexWait(metrics_generation_, current);
+    }
+  }
+  std::scoped_lock<std::mutex> lock(metrics_mutex_);
+  return metrics_;
+}
 
-  std::condition_variable t;
-  auto init = [&timer, &t]() {
-    auto end = steady_clock::now() + timer;
-    while (steady_clock::now() < end);
-    time();
-    t.notify_all();
+void Core::CollectMetrics() {
+  if (!metrics_requested_.exchange(false, std::memory_order_acq_rel)) {
+    return;
+  }
+  struct Aggregate {
+    std::vector<uint64_t> counts =
+        std::vector<uint64_t>(LatencyHistogram::kBuckets);
+    TickerMetrics metrics;
   };
+  std::unordered_map<std::type_index, Aggregate> types;
+  for (auto const& thread : threads_) {
+    thread->ForEachTicker([&types](Ticker& object) {
+      Aggregate& aggregate = types[typeid(object)];
+      UpdateStats const& stats = object.update_stats();
+      if (LatencyHistogram const* histogram = stats.histogram()) {
+        histogram->AddTo(aggregate.counts);
+      }
+      aggregate.metrics.tickers++;
+      aggregate.metrics.updates += object.calls_counter();
+      aggregate.metrics.mean += stats.mean();
+      aggregate.metrics.max = std::max(aggregate.metrics.max, stats.max());
+    });
+  }
+  std::vector<TickerMetrics> metrics;
+  metrics.reserve(types.size());
+  for (auto& [type, aggregate] : types) {
+    TickerMetrics& m = aggregate.metrics;
+    m.name = Demangle(type.name());
+    m.mean /= double(m.tickers);
+    m.p50 = double(LatencyHistogram::Percentile(aggregate.counts, 0.5)) / 1e9;
+    m.p99 = double(LatencyHistogram::Percentile(aggregate.counts, 0.99)) / 1e9;
+    metrics.push_back(std::move(m));
+  }
+  std::sort(metrics.begin(), metrics.end(),
+            [](TickerMetrics const& a, TickerMetrics const& b) {
+              return a.p99 > b.p99;
+            });
+  {
+    std::scoped_lock<std::mutex> lock(metrics_mutex_);
+    metrics_ = std::move(metrics);
+  }
+  metrics_generation_.fetch_add(1, std::memory_order_acq_rel);
+  FutexWakeAll(metrics_generation_);
+}
 
-  time_point<steady_clock> start;
-  nanoseconds dur[tests];
+bool Core::RunParallel(size_t count, size_t grain, ParallelJob::Body body,
+                       void* context) {
+  if (current_thread_index >= threads_.size()) {
+    return false;
+  }
+  // idle threads of the round sleep on the graph epoch
+  graph_.Notify();
+  return threads_[current_thread_index]->parallel_job().Run(count, grain,
+                                                            body, context);
+}
 
-  for (auto& d : dur) {
-    start = steady_clock::now();
-    init();
-    d = steady_clock::now() - start - timer;
+bool Core::IsUpdateThread() const noexcept {
+  const auto id = std::this_thread::get_id();
+  return std::any_of(threads_.begin(), threads_.end(),
+                     [&id](std::unique_ptr<UpdateThread> const& thread) {
+                       return thread->thread_id() == id;
+                     });
+}
+
+void Core::BeginRound() {
+  {
+    std::scoped_lock<std::mutex> lock(domains_mutex_);
+    domains_.BeginRound(round_, round_ticks_);
   }
-  std::sort(std::begin(dur), std::end(dur));
-  return dur[tests / 2];
+  const bool stepped =
+      round_ticks_[TickDomains::kDefaultDomain] != TickDomains::kIdle;
+  // the tick the tickers of the default domain get, kept while it idles
+  if (stepped) {
+    global_tick_ = round_ticks_[TickDomains::kDefaultDomain];
+  }
+  tasks_->BeginRound(global_tick_, stepped);
+  graph_.Reset(uint32_t(threads_.size()));
+  round_start_ = Clock::Now();
 }
 
-inline void Core::busy_sleep(std::chrono::nanoseconds t) const {
-  auto end = std::chrono::steady_clock::now() + t - overhead_;
-  while (std::chrono::steady_clock::now() < end)
-    ;
+SystemId Core::RegisterSystem(SystemDesc const& desc) {
+  std::scoped_lock<std::mutex> lock(graph_mutex_);
+  SystemId id = next_graph_.Register(desc);
+  if (id != TaskGraph::kInvalidSystem) {
+    graph_dirty_ = true;
+  }
+  return id;
 }
 
-void Core::ThreadReady(std::thread::id id) {
-  std::unique_lock lock(sync_mutex_);
+SystemId Core::FindSystem(std::string_view name) {
+  std::scoped_lock<std::mutex> lock(graph_mutex_);
+  return next_graph_.Find(name);
+}
 
-  if (operational_thread_id_ != id) {
-    sync_threads_ += 1;
-    sync_var_.wait(lock);
-  } else {
-    lock.unlock();
-    while ((sync_threads_ + 1) < threads_.size()) {
-      std::this_thread::sleep_for(std::chrono::microseconds(1));
+DomainId Core::RegisterTickDomain(TickDomainDesc const& desc) {
+  std::scoped_lock<std::mutex> lock(domains_mutex_);
+  return domains_.Register(desc);
+}
+
+DomainId Core::FindTickDomain(std::string_view name) {
+  std::scoped_lock<std::mutex> lock(domains_mutex_);
+  return domains_.Find(name);
+}
+
+uint64_t Core::domain_tick(DomainId id) {
+  std::scoped_lock<std::mutex> lock(domains_mutex_);
+  return id < domains_.size() ? domains_.tick(id) : 0;
+}
+
+double Core::domain_dropped_time(DomainId id) {
+  std::scoped_lock<std::mutex> lock(domains_mutex_);
+  return id < domains_.size() ? double(domains_.dropped(id)) / 1e9 : 0;
+}
+
+double Core::domain_alpha(DomainId id) {
+  std::scoped_lock<std::mutex> lock(domains_mutex_);
+  return id < domains_.size() ? domains_.alpha(id) : 0;
+}
+
+void Core::Rebalance() {
+  for (size_t i = 0; i < balance_groups_.size(); i++) {
+    Rebalance(i);
+  }
+}
+
+void Core::Rebalance(size_t group_index) {
+  std::vector<size_t> const& group = balance_groups_[group_index];
+  const size_t n = group.size();
+  if (n < 2) {
+    return;
+  }
+  std::vector<double> loads(n);
+  double mean = 0;
+  for (size_t i = 0; i < n; i++) {
+    loads[i] = threads_[group[i]]->exec_time();
+    mean += loads[i];
+  }
+  mean /= double(n);
+  if (mean <= 0) {
+    return;
+  }
+
+  double max_imbalance = 0;
+  for (size_t i = 0; i < n; i++) {
+    double imbalance = loads[i] / mean - 1;
+    threads_[group[i]]->SetLoadImbalance(imbalance);
+    max_imbalance = std::max(max_imbalance, std::abs(imbalance));
+  }
+  char& rebalancing = rebalancing_[group_index];
+  if (max_imbalance > kRebalanceStart) {
+    rebalancing = 1;
+  } else if (max_imbalance < kRebalanceStop) {
+    rebalancing = 0;
+  }
+  if (rebalancing == 0) {
+    return;
+  }
+
+  // move surplus of the most loaded threads to the least loaded ones
+  std::vector<size_t> order(n);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&loads](size_t a, size_t b) { return loads[a] < loads[b]; });
+  size_t low = 0;
+  size_t high = n - 1;
+  double surplus = (loads[order[high]] - mean) * kRebalanceDamping;
+  double deficit = (mean - loads[order[low]]) * kRebalanceDamping;
+  while (low < high && loads[order[high]] / mean - 1 > kRebalanceStop) {
+    double budget = std::min(surplus, deficit);
+    if (budget > 0) {
+      threads_[group[order[high]]]->MigrateTo(*threads_[group[order[low]]],
+                                              budget, domain_rates_);
     }
-    lock.lock();
-    double t = time();
-    double wait_t =
-        (1.0e9 / double(tickrate_)) - 1.0e9 * (t - last_tick_timestamp_);
-    if (wait_t > 0) {
-      busy_sleep(std::chrono::nanoseconds((uint32_t)wait_t));
+    surplus -= budget;
+    deficit -= budget;
+    if (surplus <= 0) {
+      high--;
+      surplus = (loads[order[high]] - mean) * kRebalanceDamping;
     }
+    if (deficit <= 0) {
+      low++;
+      deficit = (mean - loads[order[low]]) * kRebalanceDamping;
+    }
+    if (surplus <= 0 || deficit <= 0) {
+      break;
+    }
+  }
+}
+
+void Core::StartProfiling(size_t events_per_thread) {
+  profiler_->Start(events_per_thread);
+}
+
+void Core::WriteTrace(std::ostream& out, uint64_t first_tick,
+                      uint64_t last_tick) const {
+  profiler_->WriteChromeTrace(out, first_tick, last_tick);
+}
 
-    t = time();
-    global_tick_ += 1;
-    last_tick_timedelta_ = t - last_tick_timestamp_;
-    last_tick_timestamp_ = t;
+std::vector<double> Core::load_imbalance() const {
+  std::vector<double> rv;
+  rv.reserve(threads_.size());
+  for (auto const& thread : threads_) {
+    rv.push_back(thread->load_imbalance());
+  }
+  return rv;
+}
 
-    sync_threads_ = 0;
-    sync_var_.notify_all();
+std::vector<std::chrono::nanoseconds> Core::barrier_wait_times() const {
+  std::vector<std::chrono::nanoseconds> rv;
+  rv.reserve(threads_.size());
+  for (auto const& thread : threads_) {
+    rv.push_back(thread->barrier_wait_time());
   }
+  return rv;
 }
 
-Core::Core() {
-  last_tick_timestamp_ = time();
-  for (size_t i = 0; i < std::thread::hardware_concurrency(); i++) {
-    auto ptr = std::make_unique<UpdateThread>(global_tick_);
+Core::Core()
+    : config_(CoreConfig::Load(*Config::GetInstance())),
+      graph_(DefaultSystem()),
+      next_graph_(DefaultSystem()),
+      tickrate_(config_.tickrate),
+      domains_(tickrate_) {
+  last_tick_timestamp_ = Clock::Now();
+  pacing_origin_ = last_tick_timestamp_;
+  simulated_time_ = last_tick_timestamp_;
+  domain_rates_ = domains_.rates();
+  pacer_.SetMode(config_.pacing);
+
+  std::vector<ThreadPlacement> placements = PlaceThreads(config_);
+  const auto thread_count = uint32_t(placements.size());
+  barrier_ = std::make_unique<TickBarrier>(thread_count);
+  profiler_ = std::make_unique<TickProfiler>(thread_count);
+  tasks_ = std::make_unique<TaskScheduler>(thread_count);
+  graph_.Reset(thread_count);
+  rounds_ = 0;
+
+  // group threads by NUMA node, the operational thread only takes part if
+  // it accepts work
+  for (size_t i = 0; i < thread_count; i++) {
+    if (!placements[i].accepts_work) {
+      continue;
+    }
+    const uint32_t node = config_.numa ? placements[i].numa_node : 0;
+    auto group = std::find_if(
+        balance_groups_.begin(), balance_groups_.end(),
+        [&](std::vector<size_t> const& g) {
+          return placements[g.front()].numa_node == node || !config_.numa;
+        });
+    if (group == balance_groups_.end()) {
+      balance_groups_.emplace_back();
+      group = balance_groups_.end() - 1;
+    }
+    group->push_back(i);
+  }
+  rebalancing_.assign(balance_groups_.size(), 0);
+
+  // nearest victims first: same node, then the rest, each in ring order
+  std::vector<std::vector<size_t>> steal_orders(thread_count);
+  for (size_t i = 0; i < thread_count; i++) {
+    for (size_t k = 1; k < thread_count; k++) {
+      steal_orders[i].push_back((i + k) % thread_count);
+    }
+    std::stable_partition(
+        steal_orders[i].begin(), steal_orders[i].end(), [&](size_t victim) {
+          return placements[victim].numa_node == placements[i].numa_node;
+        });
+  }
+
+  // threads can't start ticking before the constructor returns, they wait
+  // for core_creation_mutex_ in GetInstance
+  for (size_t i = 0; i < thread_count; i++) {
+    auto ptr =
+        std::make_unique<UpdateThread>(i, global_tick_, placements[i]);
+    ptr->SetStealOrder(std::move(steal_orders[i]));
     threads_.push_back(std::move(ptr));
   }
   operational_thread_id_ = threads_[0]->thread_id();
 }
 
-Core::UpdateThread::UpdateThread(uint32_t tick) : local_tick_(tick) {
+Core::UpdateThread::UpdateThread(size_t index, uint32_t tick,
+                                 ThreadPlacement placement)
+    : index_(index), placement_(std::move(placement)), local_tick_(tick) {
   this->thread_ =
       std::make_unique<std::thread>(&UpdateThread::ThreadFunction, this);
 }
-Core::UpdateThread::~UpdateThread() {
-  die_ = true;
-  thread_->join();
+Core::UpdateThread::~UpdateThread() { Join(); }
+
+void Core::UpdateThread::Join() {
+  if (!thread_->joinable()) {
+    return;
+  }
+  // the last reference to the Core can be dropped by an exiting update
+  // thread, which then destroys itself
+  if (thread_->get_id() == std::this_thread::get_id()) {
+    thread_->detach();
+  } else {
+    thread_->join();
+  }
+}
+double Core::UpdateThread::exec_time() const noexcept {
+  return exec_time_.load(std::memory_order_relaxed);
+}
+
+double Core::UpdateThread::load_imbalance() const noexcept {
+  return load_imbalance_.load(std::memory_order_relaxed);
+}
+
+void Core::UpdateThread::MigrateTo(UpdateThread& to, double budget,
+                                   std::vector<uint32_t> const& domain_rates) {
+  std::vector<std::weak_ptr<Ticker>> moved;
+  const double cost = registry_.Extract(budget, domain_rates, moved);
+  // the receiver drains its inbox before scheduling the next tick, so the
+  // moved tickers don't miss an update
+  to.AddObjects(moved);
+  exec_time_.store(registry_.exec_time(domain_rates),
+                   std::memory_order_relaxed);
+  to.exec_time_.store(to.exec_time() + cost, std::memory_order_relaxed);
 }
-double Core::UpdateThread::exec_time() const noexcept { return exec_time_; }
 
 void Core::UpdateThread::AddObject(std::weak_ptr<Ticker> object) {
-  std::scoped_lock<std::mutex> lock(objects_to_add_mutex_);
-  objects_to_add_.push_back(object);
+  inbox_.Push(std::move(object));
+}
+
+void Core::UpdateThread::AddObjects(
+    std::vector<std::weak_ptr<Ticker>> const& objects) {
+  inbox_.PushRange(objects.begin(), objects.end());
+}
+
+void Core::UpdateThread::DrainInbox() {
+  std::weak_ptr<Ticker> object;
+  while (inbox_.Pop(object)) {
+    registry_.Add(std::move(object));
+  }
 }
 
 std::thread::id Core::UpdateThread::thread_id() const noexcept {
   return thread_->get_id();
 }
 
-#ifdef _MSC_VER
-#define malatindez_FORCE_INLINE [[msvc::forceinline]]
-#else
-#define malatindez_FORCE_INLINE __attribute__((always_inline))
-#endif
+std::chrono::nanoseconds Core::UpdateThread::barrier_wait_time()
+    const noexcept {
+  return std::chrono::nanoseconds(
+      barrier_wait_time_.load(std::memory_order_relaxed));
+}
 
-void Core::UpdateThread::ThreadFunction() {
-  std::shared_ptr<Core> core = Core::GetInstance();
-  core->ThreadReady(thread_->get_id());
-  auto update_objects = [this, &core]() malatindez_FORCE_INLINE {
-    for (auto itr = objects_.begin(); itr != objects_.end();) {
-      if (itr->expired()) {  // if object is expired, remove it from objects_
-        itr = objects_.erase(itr);
-      } else {  // update non-expired object
-        itr->lock()->UpdateExecutionTime(core->global_tick_);
-        itr++;
-      }
+namespace {
+// unknown system ids fall back to the default system
+SystemId SystemOf(Ticker const& object, size_t systems) noexcept {
+  return object.system() < systems ? object.system()
+                                   : TaskGraph::kDefaultSystem;
+}
+
+// tick of the object's domain in the current round, unknown domains follow
+// the default one
+uint64_t TickOf(Ticker const& object,
+                std::vector<uint64_t> const& ticks) noexcept {
+  return object.domain() < ticks.size() ? ticks[object.domain()]
+                                        : ticks[TickDomains::kDefaultDomain];
+}
+}  // namespace
+
+void Core::UpdateThread::ScheduleObjects(std::vector<uint64_t> const& ticks,
+                                         TaskGraph& graph) {
+  const size_t systems = graph.size();
+  due_.resize(systems);
+  due_pinned_.resize(systems);
+  // the registry keeps the objects alive until the next round
+  registry_.ForEachDue(ticks, [this, systems](Ticker& object, bool pinned) {
+    const SystemId system = SystemOf(object, systems);
+    if (pinned) {
+      due_pinned_[system].push_back(&object);
+    } else {
+      due_[system].push_back(&object);
     }
-  };
+  });
+  contributed_.assign(systems, 0);
+  contributed_count_ = 0;
+  graph_epoch_ = 0;
+  completed_count_ = 0;
+  // nothing to wait for in these, so nobody waits for us either
+  for (SystemId id = 0; id < systems; id++) {
+    if (due_[id].empty() && due_pinned_[id].empty()) {
+      contributed_[id] = 1;
+      contributed_count_++;
+      graph.ContributionDone(id);
+    }
+  }
+}
 
-  // 16 times per second
-  auto add_objects_tickrate = (uint32_t)ceil((double)core->tickrate_ / 16);
-  // 4 times per second
-  auto update_exec_time_tickrate = (uint32_t)ceil((double)core->tickrate_ / 4);
+void Core::UpdateThread::ContributeRunnableSystems(TaskGraph& graph,
+                                                  uint32_t epoch) {
+  if (contributed_count_ == contributed_.size() || epoch == graph_epoch_) {
+    return;
+  }
+  graph_epoch_ = epoch;
+  for (SystemId id = 0; id < contributed_.size(); id++) {
+    if (contributed_[id] != 0 || !graph.runnable(id)) {
+      continue;
+    }
+    contributed_[id] = 1;
+    contributed_count_++;
 
-  auto exec_time_accumulate_ =
-      [](double a, std::weak_ptr<Ticker> object) malatindez_FORCE_INLINE {
-        return a +
-               object.lock()->average_update_time() / object.lock()->tickrate();
-      };
+    auto& objects = due_[id];
+    auto& pinned = due_pinned_[id];
+    graph.Contribute(id, int64_t(objects.size() + pinned.size()));
+    for (Ticker* object : objects) {
+      deque_.Push(object);
+    }
+    pinned_.insert(pinned_.end(), pinned.begin(), pinned.end());
+    objects.clear();
+    pinned.clear();
+    graph.ContributionDone(id);
+  }
+}
+
+void Core::UpdateThread::ReportCompletedWork(TaskGraph& graph) {
+  if (completed_count_ != 0) {
+    graph.CompleteWork(completed_system_, completed_count_);
+    completed_count_ = 0;
+  }
+}
+
+bool Core::UpdateThread::StealObject(Core& core, Ticker*& out) {
+  if (!placement_.accepts_work || core.deterministic()) {
+    return false;
+  }
+  bool found_work = true;
+  while (found_work) {
+    found_work = false;
+    for (size_t victim_index : steal_order_) {
+      auto& victim = core.threads_[victim_index]->deque_;
+      if (victim.Empty()) {
+        continue;
+      }
+      found_work = true;
+      if (victim.Steal(out)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
 
-  while (!die_) {
-    update_objects();
+bool Core::UpdateThread::HelpParallelJobs(Core& core) {
+  if (!placement_.accepts_work) {
+    return false;
+  }
+  bool helped = false;
+  for (size_t victim_index : steal_order_) {
+    helped = core.threads_[victim_index]->parallel_job_.Help() || helped;
+  }
+  return helped;
+}
 
-    // add objects 16 times per second
-    if ((local_tick_ % add_objects_tickrate) == 0 && !objects_to_add_.empty()) {
-      std::scoped_lock<std::mutex> lock(objects_to_add_mutex_);
-      objects_.insert(objects_.end(), objects_to_add_.begin(),
-                      objects_to_add_.end());
-      objects_to_add_.clear();
+void Core::UpdateThread::RunScheduledObjects(
+    Core& core, std::vector<uint64_t> const& ticks) {
+  // an isolated thread can't steal, so there is nothing to spin for
+  const uint32_t spin_count = placement_.accepts_work ? 1024 : 0;
+  TaskGraph& graph = core.graph_;
+  uint32_t idle = 0;
+  Ticker* object = nullptr;
+  while (!graph.finished()) {
+    // read before looking for work, so that work showing up later ends the
+    // wait below
+    const uint32_t epoch = graph.epoch();
+    ContributeRunnableSystems(graph, epoch);
+    if (!pinned_.empty()) {
+      object = pinned_.back();
+      pinned_.pop_back();
+    } else if (!deque_.Pop(object)) {
+      // our share is done, let the dependents of these systems start
+      ReportCompletedWork(graph);
+      if (!StealObject(core, object)) {
+        if (HelpParallelJobs(core)) {
+          idle = 0;
+          continue;
+        }
+        if (idle < spin_count) {
+          idle++;
+          CpuRelax();
+          continue;
+        }
+        if (!placement_.accepts_work &&
+            contributed_count_ == contributed_.size()) {
+          // nothing of ours is left and nothing to help with
+          break;
+        }
+        // woken when a system becomes runnable, a ParallelFor starts or
+        // the graph finishes
+        graph.WaitForEpoch(epoch);
+        idle = 0;
+        continue;
+      }
+    }
+    idle = 0;
+    TickContext context{TickOf(*object, ticks), index_, frame_allocator_,
+                        core.ticker_histograms_.load(std::memory_order_relaxed),
+                        &core};
+    current_ticker = object;
+    current_ticker_adds = 0;
+    if (core.profiler_->enabled()) {
+      ProfileEvent event;
+      event.begin = Clock::Cycles();
+      object->UpdateExecutionTime(context.tick, context);
+      event.end = Clock::Cycles();
+      event.tick = core.global_tick_;
+      event.name = typeid(*object).name();
+      event.object = reinterpret_cast<uintptr_t>(object);
+      event.system = object->system();
+      core.profiler_->Record(index_, event);
+    } else {
+      object->UpdateExecutionTime(context.tick, context);
     }
+    current_ticker = nullptr;
+    if (core.deterministic() && object->due(context.tick)) {
+      state_hash_ += Mix(object->id() ^ Mix(object->StateHash()));
+    }
+    // consecutive tickers of a system are reported at once
+    const SystemId system = SystemOf(*object, graph.size());
+    if (system != completed_system_) {
+      ReportCompletedWork(graph);
+      completed_system_ = system;
+    }
+    completed_count_++;
+  }
+}
+
+void Core::UpdateThread::ThreadFunction() {
+  // pin before the thread allocates anything, so that the registry and
+  // queues it fills are first touched on its own NUMA node
+  if (!placement_.cpus.empty()) {
+    PinCurrentThread(placement_.cpus);
+  }
+  std::shared_ptr<Core> core = Core::GetInstance();
+  current_thread_index = index_;
+  core->ThreadReady(thread_->get_id());
+
+  while (!core->stopping_) {
+    DrainInbox();
+    core->tasks_->RunDue(index_, core->deterministic());
+    ScheduleObjects(core->round_ticks_, core->graph_);
+    RunScheduledObjects(*core, core->round_ticks_);
 
-    if ((local_tick_ % update_exec_time_tickrate) == 0) {
-      exec_time_ = std::accumulate(std::begin(objects_), std::end(objects_),
-                                   0.0, exec_time_accumulate_);
-      exec_time_ *= core->tickrate_;
+    exec_time_.store(registry_.exec_time(core->domain_rates_),
+                     std::memory_order_relaxed);
+    ProfileEvent wait;
+    wait.type = ProfileEvent::Type::kBarrierWait;
+    wait.tick = core->global_tick_;
+    wait.begin = Clock::Cycles();
+    auto waited = core->ThreadReady(thread_->get_id());
+    barrier_wait_time_.store(waited.count(), std::memory_order_relaxed);
+    if (core->profiler_->enabled()) {
+      wait.end = Clock::Cycles();
+      core->profiler_->Record(index_, wait);
     }
-    core->ThreadReady(thread_->get_id());
+    // every thread passed the barrier, nothing from the last tick is in use
+    frame_allocator_.Reset();
     local_tick_ = core->global_tick_;
   }
 }
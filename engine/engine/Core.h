@@ -2,6 +2,8 @@
 #include <GLFW/glfw3.h>
 
 #include <map>
+#include <span>
+#include <array>
 #include <mutex>
 #include <chrono>
 #include <memory>
@@ -10,14 +12,43 @@
 #include <iostream>
 #include <algorithm>
 #include <functional>
-#include <condition_variable>
 
 
 #include "Ticker.h"
+#include "core/Clock.h"
+#include "core/CoreConfig.h"
+#include "core/CostHistogram.h"
+#include "core/FrameAllocator.h"
+#include "core/Futex.h"
+#include "core/MpscQueue.h"
+#include "core/ParallelJob.h"
+#include "core/RenderSnapshot.h"
+#include "core/TickBarrier.h"
+#include "core/TaskGraph.h"
+#include "core/TaskScheduler.h"
+#include "core/TickDomains.h"
+#include "core/TickPacer.h"
+#include "core/TickProfiler.h"
+#include "core/TickerRegistry.h"
+#include "core/WorkStealingDeque.h"
 #include "engine/client/render/Shader.h"
 
 namespace engine::core {
 
+// Update time statistics of all tickers of one type, in seconds.
+struct TickerMetrics {
+  // demangled type name
+  std::string name;
+  size_t tickers = 0;
+  uint64_t updates = 0;
+  // mean of the decayed means of the tickers
+  double mean = 0;
+  // percentiles of the merged distributions
+  double p50 = 0;
+  double p99 = 0;
+  double max = 0;
+};
+
 // Singleton class instance of which you can get by calling the GetInstance
 // function.
 // GetInstance SHOULD be called before calling any static function inside Core.
@@ -25,19 +56,39 @@ namespace engine::core {
 // nullptr.
 class Core final {
  public:
+  enum class RunState : uint32_t {
+    kRunning = 0,
+    kPaused = 1,
+    // running the ticks requested with Step, pauses afterwards
+    kStepping = 2,
+    kStopping = 3,
+    kStopped = 4
+  };
+
   /* Disable copy and move semantics. */
   Core(const Core&) = delete;
   Core(Core&&) = delete;
   Core& operator=(const Core&) = delete;
   Core& operator=(Core&&) = delete;
+  // The update threads hold the Core, so it is only destroyed after Stop;
+  // stopping here as well keeps a Core dropped early from leaving them
+  // running.
   ~Core() {
+    Stop();
     for (auto& thread : threads_) {
       thread.reset();
     }
   }
 
+  // Seconds since engine start on a monotonic clock.
   [[nodiscard]] static double time();
 
+  // Nanoseconds since engine start on a monotonic clock.
+  [[nodiscard]] static int64_t timestamp() noexcept;
+
+  // Tick of the current (or, in a round where it doesn't step, the last)
+  // step of the default tick domain. Equal to the tick passed to
+  // Ticker::Update of the default domain's tickers in that step.
   [[nodiscard]] static uint64_t global_tick() noexcept;
 
   // returns shared pointer to the Core.
@@ -51,46 +102,430 @@ class Core final {
   /// called</param> <returns>Tickrate</returns>
   [[nodiscard]] static uint32_t CalcTickrate(uint32_t times_per_second);
 
+  // Time between the starts of the last two ticks in seconds.
   [[nodiscard]] static double tick_delta();
 
+  // Time between the starts of the last two ticks in nanoseconds.
+  [[nodiscard]] static int64_t tick_delta_ns() noexcept;
+
+  // timestamp() at which the current tick started.
+  [[nodiscard]] static int64_t tick_timestamp() noexcept;
+
   // returns 1 if succeed
   // 0 if failed
+  // Lock-free, the object is updated starting from the next tick.
+  // Unless Ticker::SetPhase was called, the object gets the next phase of
+  // its domain and tickrate, so tickers of one rate are spread over the
+  // ticks instead of all running on the same one.
+  // The update threads share ownership of the object and drop it once
+  // every other owner has released it.
   int AddTickingObject(std::weak_ptr<Ticker> object);
 
+  // Adds a batch of objects, each update thread receives its share with a
+  // single atomic operation. Returns the number of objects added.
+  size_t AddTickingObjects(std::span<const std::weak_ptr<Ticker>> objects);
+
+  /// <summary>
+  /// Runs a coroutine on the update threads, starting on the next tick.
+  /// The task is resumed at the start of the ticks of the default domain
+  /// it waits for (co_await next_tick, ticks(n), when_all or an
+  /// AsyncResult) and costs nothing while suspended. The Core owns the
+  /// task until it finishes. Can be called from any thread.
+  /// </summary>
+  /// <param name="task">task to run</param>
+  void Spawn(Task task) { tasks_->Spawn(std::move(task)); }
+
+  /// <summary>
+  /// Calls fn(begin, end) over [0, count) in chunks of grain elements.
+  /// Called from an update thread (e.g. from Ticker::Update) the chunks
+  /// are claimed by the idle update threads of the round as well, the
+  /// call returns once every chunk finished. Elsewhere, or nested inside
+  /// another ParallelFor of the same thread, fn runs inline.
+  /// Chunks run concurrently and must not depend on each other.
+  /// </summary>
+  /// <param name="count">number of elements</param>
+  /// <param name="grain">elements per chunk</param>
+  /// <param name="fn">loop body over a chunk</param>
+  template <typename Function>
+  void ParallelFor(size_t count, size_t grain, Function&& fn) {
+    using Body = std::remove_reference_t<Function>;
+    if (count == 0) {
+      return;
+    }
+    if (count <= grain ||
+        !RunParallel(count, grain,
+                     [](void* context, size_t begin, size_t end) {
+                       (*static_cast<Body*>(context))(begin, end);
+                     },
+                     const_cast<void*>(static_cast<const void*>(&fn)))) {
+      fn(size_t(0), count);
+    }
+  }
+
+  // Number of update threads, the operational thread included.
+  [[nodiscard]] size_t thread_count() const noexcept {
+    return threads_.size();
+  }
+
+  // Returns how long each update thread waited at the tick barrier during
+  // the last tick. Index 0 is the operational thread.
+  [[nodiscard]] std::vector<std::chrono::nanoseconds> barrier_wait_times()
+      const;
+
+  /// <summary>
+  /// True if the Core runs in deterministic (lockstep) mode, enabled with
+  /// "core_deterministic" in config.json. In this mode:
+  /// - added objects are merged only at tick boundaries, ordered by the
+  ///   ticker that added them (or the external add order) and get stable
+  ///   ids in that order;
+  /// - unbound tickers are partitioned over the threads by id and never
+  ///   stolen or rebalanced, each thread runs its partition in a fixed
+  ///   order;
+  /// - every tick simulates exactly one interval, late ticks slow the
+  ///   simulation down instead of catching up;
+  /// - the Ticker::StateHash of every updated ticker is combined into a
+  ///   per-tick state hash.
+  /// Runs over the same input then update the same tickers in the same
+  /// order per thread and produce the same hashes, provided that tickers
+  /// are only added from one external thread or from Update, and released
+  /// deterministically.
+  /// </summary>
+  [[nodiscard]] bool deterministic() const noexcept {
+    return config_.deterministic;
+  }
+
+  // Called on the operational thread after every tick in deterministic
+  // mode with global_tick() and the combined state hash of that tick.
+  // Should be set before adding objects.
+  void SetStateHashCallback(
+      std::function<void(uint64_t tick, uint64_t hash)> callback) {
+    state_hash_callback_ = std::move(callback);
+  }
+
+  // Distribution of the wall time of the ticks (rounds) since start or
+  // the last reset, see CostHistogram for the bucket bounds.
+  [[nodiscard]] CostHistogram& tick_cost_histogram() noexcept {
+    return tick_costs_;
+  }
+
+  /// <summary>
+  /// Starts recording the begin and end of every ticker update and barrier
+  /// wait on every update thread into per-thread ring buffers.
+  /// </summary>
+  /// <param name="events_per_thread">ring capacity, only used by the first
+  /// call</param>
+  void StartProfiling(size_t events_per_thread = size_t(1) << 16);
+  void StopProfiling() noexcept { profiler_->Stop(); }
+
+  // Writes the recorded events of global ticks [first_tick, last_tick] as
+  // Chrome Trace Event JSON, viewable in chrome://tracing or Perfetto.
+  // Can be called while profiling, the rings keep the latest events.
+  void WriteTrace(std::ostream& out, uint64_t first_tick,
+                  uint64_t last_tick) const;
+
+  /// <summary>
+  /// Collects the update time statistics of every ticker grouped by type,
+  /// sorted by descending p99. The tickers are read at the next tick
+  /// boundary, so the call blocks for up to one tick. Called from an
+  /// update thread or on a stopped Core it returns the previous result.
+  /// The first call turns on the update time histograms of the tickers,
+  /// percentiles only cover the updates since.
+  /// </summary>
+  /// <returns>statistics per ticker type</returns>
+  std::vector<TickerMetrics> QueryTickerMetrics();
+
+  // Returns the relative load of each update thread compared to the mean
+  // (0.0 is balanced, 0.5 means 50% above the mean) measured at the last
+  // rebalancing pass.
+  [[nodiscard]] std::vector<double> load_imbalance() const;
+
+  // Selects how the operational thread waits for the next tick.
+  // kHybrid (default) sleeps on an OS timer and spins only for the measured
+  // wake-up jitter, kBusySpin spins for the whole interval.
+  void SetPacingMode(TickPacer::Mode mode) noexcept { pacer_.SetMode(mode); }
+  [[nodiscard]] TickPacer const& pacer() const noexcept { return pacer_; }
+
+  /// <summary>
+  /// Registers a system, a named group of tickers with declared access to
+  /// shared resources. Every tick the systems form a dependency graph: a
+  /// system starts only after each earlier system it conflicts with and
+  /// each system from desc.after has finished. Independent systems run in
+  /// parallel. Tickers join a system through Ticker::SetSystem.
+  /// The graph change takes effect from the next tick.
+  /// </summary>
+  /// <param name="desc">system name and resource access</param>
+  /// <returns>system id or TaskGraph::kInvalidSystem if the name is taken
+  /// or desc.after names an unknown system</returns>
+  SystemId RegisterSystem(SystemDesc const& desc);
+
+  // returns TaskGraph::kInvalidSystem if there is no such system
+  [[nodiscard]] SystemId FindSystem(std::string_view name);
+
+  /// <summary>
+  /// Registers a tick domain, a group of tickers stepped at its own fixed
+  /// rate independent of the pacing interval. Each pacing interval every
+  /// domain takes the steps its accumulated time allows, catching up after
+  /// slow intervals with at most desc.max_steps steps; anything beyond that
+  /// is dropped. Tickers join a domain through Ticker::SetDomain.
+  /// </summary>
+  /// <param name="desc">domain name, rate and catch-up limit</param>
+  /// <returns>domain id or TickDomains::kInvalidDomain if the name is taken
+  /// or the rate is zero</returns>
+  DomainId RegisterTickDomain(TickDomainDesc const& desc);
+
+  /// <summary>
+  /// Pauses the update threads at the next tick boundary. The threads park
+  /// on the tick barrier and use no CPU until Resume, Step or Stop.
+  /// Blocks until the threads are parked, unless called from an update
+  /// thread.
+  /// </summary>
+  /// <returns>false if the Core is stopping or stopped</returns>
+  bool Pause();
+
+  // Continues a paused or stepping Core. Tick pacing restarts from now, the
+  // paused time is not caught up.
+  // Returns false if the Core is stopping or stopped.
+  bool Resume();
+
+  /// <summary>
+  /// Runs the given number of ticks (pacing intervals with all their
+  /// rounds) on a paused Core and pauses again. Steps run back to back and
+  /// every step simulates exactly one interval.
+  /// Blocks until the steps ran, unless called from an update thread.
+  /// </summary>
+  /// <param name="ticks">number of ticks to run</param>
+  /// <returns>false if the Core isn't paused or stepping</returns>
+  bool Step(uint32_t ticks);
+
+  // Stops the update threads at the next tick boundary and joins them.
+  // Called from an update thread it only requests the stop, the threads
+  // exit once the current tick finishes. A stopped Core can't be restarted.
+  void Stop();
+
+  [[nodiscard]] RunState state() const noexcept {
+    return RunState(state_.load(std::memory_order_acquire));
+  }
+
+  // returns TickDomains::kInvalidDomain if there is no such domain
+  [[nodiscard]] DomainId FindTickDomain(std::string_view name);
+
+  // Steps taken by the domain so far.
+  [[nodiscard]] uint64_t domain_tick(DomainId id);
+
+  // Simulated seconds the domain dropped because it fell more than
+  // max_steps behind.
+  [[nodiscard]] double domain_dropped_time(DomainId id);
+
+  // Fraction of the next step of the domain already elapsed, for
+  // interpolating between its last two states.
+  [[nodiscard]] double domain_alpha(DomainId id);
 
  private:
   class UpdateThread {
    public:
-    explicit UpdateThread(uint32_t tick);
+    UpdateThread(size_t index, uint32_t tick, ThreadPlacement placement);
     ~UpdateThread();
+
+    // Waits for the thread to exit, should only be called after the Core
+    // has been asked to stop.
+    void Join();
     [[nodiscard]] double exec_time() const noexcept;
 
+    // Can be called from any thread.
     void AddObject(std::weak_ptr<Ticker> object);
+    void AddObjects(std::vector<std::weak_ptr<Ticker>> const& objects);
 
     [[nodiscard]] std::thread::id thread_id() const noexcept;
+
+    [[nodiscard]] size_t index() const noexcept { return index_; }
+
+    // Calls fn(Ticker&) for the tickers owned by this thread. Must only be
+    // called while the thread waits at the barrier.
+    template <typename Function>
+    void ForEachTicker(Function&& fn) const {
+      registry_.ForEach(std::forward<Function>(fn));
+    }
+
+    // Returns and clears the state hash of the tickers updated by this
+    // thread since the last call. Must only be called at the barrier.
+    uint64_t TakeStateHash() noexcept {
+      uint64_t rv = state_hash_;
+      state_hash_ = 0;
+      return rv;
+    }
+
+    [[nodiscard]] ThreadPlacement const& placement() const noexcept {
+      return placement_;
+    }
+    // Victims in the order they are tried when stealing, threads of the
+    // same NUMA node first. Set once before the thread starts ticking.
+    void SetStealOrder(std::vector<size_t> order) {
+      steal_order_ = std::move(order);
+    }
+
+    [[nodiscard]] double load_imbalance() const noexcept;
+    [[nodiscard]] ParallelJob& parallel_job() noexcept {
+      return parallel_job_;
+    }
+    void SetLoadImbalance(double value) noexcept {
+      load_imbalance_.store(value, std::memory_order_relaxed);
+    }
+
+    // Moves tickers worth at most budget seconds per second to another
+    // thread. Must only be called while both threads wait at the barrier.
+    // The tickers go through the inbox of the receiver, so its storage is
+    // allocated by the receiving thread.
+    void MigrateTo(UpdateThread& to, double budget,
+                   std::vector<uint32_t> const& domain_rates);
+
+    [[nodiscard]] std::chrono::nanoseconds barrier_wait_time() const noexcept;
     
     
    private:
-    [[noreturn]] void ThreadFunction();
-    bool die_ = false;
+    void ThreadFunction();
+
+    // Moves objects added since the last tick into the registry.
+    void DrainInbox();
+    // Sorts objects due in this round by system. Objects bound to this
+    // thread are kept apart and never stolen. Systems without any due object
+    // are reported as done right away.
+    void ScheduleObjects(std::vector<uint64_t> const& ticks, TaskGraph& graph);
+    // Pushes this thread's share of every system runnable as of epoch into
+    // the deque (or pinned_ for bound objects).
+    void ContributeRunnableSystems(TaskGraph& graph, uint32_t epoch);
+    // Reports the tickers updated since the last call.
+    void ReportCompletedWork(TaskGraph& graph);
+    // Runs pinned objects, drains own deque, steals from the others and
+    // helps their ParallelFor loops until the graph has finished. An idle
+    // thread sleeps on the graph epoch; a thread which can't steal returns
+    // as soon as it has pushed its share of every system.
+    void RunScheduledObjects(Core& core, std::vector<uint64_t> const& ticks);
+    [[nodiscard]] bool StealObject(Core& core, Ticker*& out);
+    // Runs chunks of the ParallelFor loops of the other threads.
+    [[nodiscard]] bool HelpParallelJobs(Core& core);
+
+    const size_t index_;
+    const ThreadPlacement placement_;
+    std::vector<size_t> steal_order_;
+
+    MpscQueue<std::weak_ptr<Ticker>> inbox_;
+    TickerRegistry registry_;
+    // scratch memory of the tickers run on this thread, reset every tick
+    FrameAllocator frame_allocator_;
+    // deterministic mode only, order independent sum of the ticker hashes
+    uint64_t state_hash_ = 0;
+
+    // ParallelFor loop of a ticker running on this thread
+    ParallelJob parallel_job_;
+
+    // Ticker::Update calls pending for the current tick. Other threads
+    // steal from the top of the deque.
+    WorkStealingDeque<Ticker*> deque_;
+    std::vector<Ticker*> pinned_;
+
+    // objects due on this tick, indexed by system
+    std::vector<std::vector<Ticker*>> due_;
+    std::vector<std::vector<Ticker*>> due_pinned_;
+    std::vector<char> contributed_;
+    size_t contributed_count_ = 0;
+    uint32_t graph_epoch_ = 0;
+    // tickers of one system updated but not yet reported to the graph
+    SystemId completed_system_ = TaskGraph::kDefaultSystem;
+    int64_t completed_count_ = 0;
 
-    std::mutex objects_to_add_mutex_;
-    std::vector<std::weak_ptr<Ticker>> objects_to_add_;
-    std::vector<std::weak_ptr<Ticker>> objects_;
     std::unique_ptr<std::thread> thread_;
-    double exec_time_ = 0;
+    std::atomic<double> exec_time_ = 0;
+    std::atomic<double> load_imbalance_ = 0;
+    std::atomic<int64_t> barrier_wait_time_ = 0;
 
     // stores current local tick
     uint64_t local_tick_ = 0;
   };
 
-  static std::chrono::nanoseconds calc_overhead();
+  // Tick barrier. The operational thread paces the tick and advances
+  // global_tick_ once every other thread has arrived.
+  // Returns the time the calling thread spent waiting for the others.
+  std::chrono::nanoseconds ThreadReady(std::thread::id id);
+
+  // Runs on the operational thread while every other thread is parked.
+  // Starts the next round of the pacing interval, or waits for the next
+  // interval once every round has run.
+  void CompleteTick();
+  void BeginRound();
+
+  enum class Control { kRun, kStep, kStop };
+  // Called by CompleteTick before every interval. Parks the operational
+  // thread while the Core is paused, the others stay parked on the barrier.
+  Control AwaitControl();
+  // Blocks until the tick loop settled (parked or exited) after
+  // generation, returns immediately on update threads.
+  void WaitSettled(uint32_t generation);
+  // Bumps control_ and wakes a paused tick loop.
+  void WakeControl() noexcept;
+  [[nodiscard]] bool IsUpdateThread() const noexcept;
 
-  const std::chrono::nanoseconds overhead_ = calc_overhead();
+  // Runs the loop in the ParallelJob of the calling update thread. Returns
+  // false if the caller isn't an update thread or already runs a loop.
+  bool RunParallel(size_t count, size_t grain, ParallelJob::Body body,
+                   void* context);
+
+  // Serves a pending QueryTickerMetrics, every update thread is parked.
+  void CollectMetrics();
+
+  // Deterministic mode: objects are staged with a sort key and handed to
+  // the threads at the tick boundary.
+  struct PendingObject {
+    // id of the ticker that added the object, 0 for external adds
+    uint64_t parent;
+    uint64_t sequence;
+    std::weak_ptr<Ticker> object;
+  };
+  void StageObject(std::weak_ptr<Ticker> object);
+  void MergePendingObjects();
+  void PublishStateHash();
 
-  inline void busy_sleep(std::chrono::nanoseconds t) const;
+  std::mutex pending_mutex_;
+  std::vector<PendingObject> pending_objects_;
+  uint64_t external_sequence_ = 0;
+  uint64_t next_object_id_ = 1;
+  std::function<void(uint64_t, uint64_t)> state_hash_callback_;
 
-  void ThreadReady(std::thread::id id);
+  std::atomic<bool> metrics_requested_ = false;
+  // set by the first QueryTickerMetrics, tickers allocate their histogram
+  // on the next update
+  std::atomic<bool> ticker_histograms_ = false;
+  // bumped after each collection, QueryTickerMetrics waits on it
+  std::atomic<uint32_t> metrics_generation_ = 0;
+  std::mutex metrics_mutex_;
+  std::vector<TickerMetrics> metrics_;
+
+  // RunState, transitions are CAS loops in the control functions
+  std::atomic<uint32_t> state_ = uint32_t(RunState::kRunning);
+  std::atomic<uint32_t> steps_left_ = 0;
+  // bumped by every state change and metrics request, a paused tick loop
+  // waits on it
+  std::atomic<uint32_t> control_ = 0;
+  // bumped each time the tick loop parks or is asked to stop, Pause and
+  // Step wait on it
+  std::atomic<uint32_t> settled_ = 0;
+  std::atomic<bool> parked_ = false;
+  std::mutex stop_mutex_;
+  // written in CompleteTick only, the barrier publishes them
+  bool stopping_ = false;
+  bool resume_pacing_ = false;
+
+  // Migrates tickers from the most to the least loaded threads based on
+  // their measured execution time. Starts once the load of some thread is
+  // kRebalanceStart away from the mean and keeps going until every thread
+  // is within kRebalanceStop, so small fluctuations don't move anything.
+  // With NUMA grouping every node is balanced on its own.
+  void Rebalance();
+  void Rebalance(size_t group_index);
+
+  static constexpr double kRebalanceStart = 0.25;
+  static constexpr double kRebalanceStop = 0.05;
+  // share of the difference moved per pass, damps oscillation
+  static constexpr double kRebalanceDamping = 0.5;
 
   Core();
 
@@ -98,20 +533,67 @@ class Core final {
   static std::mutex core_creation_mutex_;
   static std::shared_ptr<Core> core_ptr_;
 
+  CoreConfig config_;
   std::thread::id operational_thread_id_;
-  std::mutex sync_mutex_;
-  std::condition_variable sync_var_;
-  size_t sync_threads_ = 0;
+  std::unique_ptr<TickBarrier> barrier_;
+  std::unique_ptr<TickProfiler> profiler_;
+  std::unique_ptr<TaskScheduler> tasks_;
+  TickPacer pacer_;
+
+  // indices of the threads accepting unbound tickers, one group per NUMA
+  // node if enabled
+  std::vector<std::vector<size_t>> balance_groups_;
+  // per group, set while a rebalancing pass is in progress
+  std::vector<char> rebalancing_;
+
+  // graph_ is executed by the update threads, registrations go to
+  // next_graph_ and are copied over between ticks
+  TaskGraph graph_;
+  TaskGraph next_graph_;
+  bool graph_dirty_ = false;
+  std::mutex graph_mutex_;
+
 
+  std::atomic<int64_t> last_tick_timestamp_ = 0;
+  std::atomic<int64_t> last_tick_timedelta_ = 0;
 
-  double last_tick_timestamp_ = 0;
-  double last_tick_timedelta_ = 0;
+  // Tick deadlines are computed as pacing_origin_ + n * period from an
+  // integer tick count, so rounding never accumulates into drift.
+  int64_t pacing_origin_ = 0;
+  int64_t paced_ticks_ = 0;
 
   uint64_t global_tick_ = 0;
 
-  const uint32_t tickrate_ = 64;
+  // pacing intervals per second
+  const uint32_t tickrate_;
+
+  TickDomains domains_;
+  std::mutex domains_mutex_;
+  // updated between rounds, read by the update threads during a round
+  std::vector<uint64_t> round_ticks_;
+  std::vector<uint32_t> domain_rates_;
+  uint32_t round_ = 0;
+  uint32_t rounds_ = 1;
+  // simulated time handed to the domains so far
+  int64_t simulated_time_ = 0;
+  // ticks which simulated exactly one interval (steps, deterministic mode)
+  int64_t fixed_intervals_ = 0;
+  uint64_t intervals_ = 0;
+
+  // Picks the phase of an object without one. Every (domain, tickrate) pair
+  // hashes to a counter which deals phases round-robin.
+  void AssignPhase(Ticker& object) noexcept;
+
+  static constexpr size_t kPhaseCounters = 256;
+  std::array<std::atomic<uint32_t>, kPhaseCounters> phase_counters_{};
+
+  CostHistogram tick_costs_;
+  int64_t round_start_ = 0;
+
+  // Returns the thread the object is bound to or nullptr.
+  [[nodiscard]] UpdateThread* BoundThread(Ticker const& object) const;
+  [[nodiscard]] UpdateThread* LeastLoadedThread() const;
 
   std::vector<std::unique_ptr<UpdateThread>> threads_;
-  std::mutex threads_mutex_;
 };
 }  // namespace engine::core
\ No newline at end of file
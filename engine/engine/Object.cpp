@@ -1,44 +1,136 @@
-
 #include "Object.h"
 
+#include <atomic>
+#include <memory>
+
 namespace engine::core {
+
+namespace {
+const glm::vec3 kAxisX(1.0F, 0.0F, 0.0F);
+const glm::vec3 kAxisY(0.0F, 1.0F, 0.0F);
+const glm::vec3 kAxisZ(0.0F, 0.0F, 1.0F);
+
+// rotations are applied in object space, like glm::rotate on the matrix
+glm::quat Rotated(glm::quat const& rotation, float angle,
+                  glm::vec3 const& axis) noexcept {
+  return glm::normalize(rotation * glm::angleAxis(angle, axis));
+}
+}  // namespace
+
+Object::~Object() {
+  World::Objects().Defer([entity = entity_](World& world) {
+    ObjectTransform const* transform = world.Get<ObjectTransform>(entity);
+    if (transform != nullptr) {
+      ObjectScene::GetInstance().Remove(*transform);
+    }
+    world.Destroy(entity);
+    // reported once gone, a publish before the flush keeps the object
+    RenderSnapshot::Objects().MarkChanged(entity);
+  });
+}
+
+void Object::Spawn(glm::vec3 const& coords, glm::vec3 const& angle,
+                   glm::vec3 const& scale) {
+  RenderSnapshot::Objects().StartSystem();
+  World& world = World::Objects();
+  // read before queueing: a flush running the command in between bumps
+  // the version, so the cached block is never used after it is freed
+  transform_version_.store(world.structure_version(),
+                           std::memory_order_relaxed);
+  auto pending = std::make_shared<ObjectTransform>();
+  pending->position = coords;
+  pending->rotation = Rotated(pending->rotation, angle.x, kAxisX);
+  pending->rotation = Rotated(pending->rotation, angle.y, kAxisY);
+  pending->rotation = Rotated(pending->rotation, angle.z, kAxisZ);
+  pending->scale = scale;
+  // reported by the command, changes until then are published with it
+  pending->snapshot_pending = true;
+  transform_.store(pending.get(), std::memory_order_release);
+  world.Defer([entity = entity_, pending](World& world) {
+    world.CreateReserved(entity, std::move(*pending));
+    RenderSnapshot::Objects().MarkChanged(entity);
+  });
+}
+
+ObjectTransform& Object::transform() const noexcept {
+  World& world = World::Objects();
+  const uint64_t version = world.structure_version();
+  if (transform_version_.load(std::memory_order_acquire) != version) {
+    // nullptr while the entity waits for its create command, the pending
+    // block is still alive then
+    if (ObjectTransform* current = world.Get<ObjectTransform>(entity_)) {
+      transform_.store(current, std::memory_order_relaxed);
+      transform_version_.store(version, std::memory_order_release);
+      return *current;
+    }
+  }
+  return *transform_.load(std::memory_order_acquire);
+}
+
 [[nodiscard]] glm::mat4 Object::translation_matrix() const noexcept {
-  return translation_matrix_;
+  return glm::translate(glm::mat4(1.0F), position());
 }
-[[nodiscard]] glm::mat4 Object::rotation_matrix() const noexcept { 
-  return rotation_matrix_; 
+[[nodiscard]] glm::mat4 Object::rotation_matrix() const noexcept {
+  return glm::mat4_cast(rotation());
 }
-[[nodiscard]] glm::mat4 Object::scale_matrix() const noexcept { 
-  return scale_matrix_; 
+[[nodiscard]] glm::mat4 Object::scale_matrix() const noexcept {
+  return glm::scale(glm::mat4(1.0F), scale());
 }
 
-[[nodiscard]] glm::mat4 Object::model_matrix() noexcept {
-  UpdateModelMatrix();
-  return full_matrix_;
+[[nodiscard]] glm::mat4 Object::model_matrix() const noexcept {
+  return transform().model_matrix();
+}
+
+[[nodiscard]] std::optional<glm::mat4> Object::published_model_matrix()
+    const noexcept {
+  glm::mat4x3 const* published =
+      RenderSnapshot::Objects().frame().model_matrix(entity_);
+  if (published == nullptr) {
+    return std::nullopt;
+  }
+  // the frame leaves out the last row, (0, 0, 0, 1)
+  return glm::mat4(*published);
 }
 
 [[nodiscard]] glm::vec3 Object::position() const noexcept {
-  return glm::vec3(translation_matrix_[3][0], translation_matrix_[3][1],
-                   translation_matrix_[3][2]);
+  return transform().position;
+}
+[[nodiscard]] glm::quat Object::rotation() const noexcept {
+  return transform().rotation;
 }
 [[nodiscard]] glm::vec3 Object::scale() const noexcept {
-  return glm::vec3(scale_matrix_[0][0], scale_matrix_[1][1],
-                   scale_matrix_[2][2]);
+  return transform().scale;
+}
+
+void Object::SetParent(Object const* parent) {
+  ObjectScene::GetInstance().SetParent(
+      entity_, parent != nullptr ? parent->entity_ : Entity());
+}
+
+[[nodiscard]] bool Object::transform_dirty() const noexcept {
+  return transform().dirty;
+}
+void Object::ClearTransformDirty() noexcept {
+  transform().dirty = false;
 }
 
 void Object::Move(glm::vec3 const& coords) noexcept {
-  translation_matrix_ = glm::translate(translation_matrix_, coords);
+  ObjectTransform& current = transform();
+  current.position += coords;
+  MarkChanged(current);
 }
 
 void Object::Move(const float x, const float y, const float z) noexcept {
-  translation_matrix_ = glm::translate(translation_matrix_, glm::vec3(x, y, z));
+  this->Move(glm::vec3(x, y, z));
 }
 
 void Object::SetTranslationMatrix(glm::mat4 const& mat) noexcept {
-  this->translation_matrix_ = mat;
+  this->SetPosition(glm::vec3(mat[3]));
 }
 void Object::SetPosition(glm::vec3 const& pos) noexcept {
-  this->translation_matrix_ = glm::translate(glm::mat4(1.0F), pos);
+  ObjectTransform& current = transform();
+  current.position = pos;
+  MarkChanged(current);
 }
 
 void Object::Rotate(const float anglex, const float angley,
@@ -53,79 +145,88 @@ void Object::Rotate(const glm::vec3 angle) noexcept {
 }
 
 void Object::RotateX(const float angle) noexcept {
-  rotation_matrix_ =
-      glm::rotate(rotation_matrix_, angle, glm::vec3(1.0F, 0.0F, 0.0F));
+  ObjectTransform& current = transform();
+  current.rotation = Rotated(current.rotation, angle, kAxisX);
+  MarkChanged(current);
 }
 
 void Object::RotateY(const float angle) noexcept {
-  rotation_matrix_ =
-      glm::rotate(rotation_matrix_, angle, glm::vec3(0.0F, 1.0F, 0.0F));
+  ObjectTransform& current = transform();
+  current.rotation = Rotated(current.rotation, angle, kAxisY);
+  MarkChanged(current);
 }
 
 void Object::RotateZ(const float angle) noexcept {
-  rotation_matrix_ =
-      glm::rotate(rotation_matrix_, angle, glm::vec3(0.0F, 0.0F, 1.0F));
+  ObjectTransform& current = transform();
+  current.rotation = Rotated(current.rotation, angle, kAxisZ);
+  MarkChanged(current);
 }
 
 void Object::SetRotationMatrix(glm::mat4 const& mat) noexcept {
-  this->rotation_matrix_ = mat;
+  this->SetRotation(glm::normalize(glm::quat_cast(glm::mat3(mat))));
+}
+void Object::SetRotation(glm::quat const& rotation) noexcept {
+  ObjectTransform& current = transform();
+  current.rotation = rotation;
+  MarkChanged(current);
 }
 void Object::SetRotation(glm::vec3 const& angle) noexcept {
-  this->rotation_matrix_ = glm::mat4(1.0F);
-  this->RotateX(angle.x);
-  this->RotateY(angle.y);
-  this->RotateZ(angle.z);
+  this->SetRotation(angle.x, angle.y, angle.z);
 }
 void Object::SetRotation(const float anglex, const float angley,
                          const float anglez) noexcept {
-  this->rotation_matrix_ = glm::mat4(1.0F);
+  this->SetRotation(glm::quat(1.0F, 0.0F, 0.0F, 0.0F));
   this->RotateX(anglex);
   this->RotateY(angley);
   this->RotateZ(anglez);
 }
 
 void Object::Scale(glm::vec3 const& scale) noexcept {
-  scale_matrix_ = glm::scale(scale_matrix_, scale);
+  ObjectTransform& current = transform();
+  current.scale *= scale;
+  MarkChanged(current);
 }
 
 void Object::Scale(const int x, const int y, const int z) noexcept {
-  scale_matrix_ = glm::scale(scale_matrix_, glm::vec3(x, y, z));
+  this->Scale(glm::vec3(x, y, z));
 }
 void Object::ScaleX(const int scale) noexcept {
-  scale_matrix_ = glm::scale(scale_matrix_, glm::vec3(scale, 0, 0));
+  this->Scale(glm::vec3(scale, 0, 0));
 }
 void Object::ScaleY(const int scale) noexcept {
-  scale_matrix_ = glm::scale(scale_matrix_, glm::vec3(0, scale, 0));
+  this->Scale(glm::vec3(0, scale, 0));
 }
 void Object::ScaleZ(const int scale) noexcept {
-  scale_matrix_ = glm::scale(scale_matrix_, glm::vec3(0, 0, scale));
+  this->Scale(glm::vec3(0, 0, scale));
 }
 
 void Object::SetScaleMatrix(glm::mat4 const& mat) noexcept {
-  this->scale_matrix_ = mat;
+  this->SetScale(glm::vec3(mat[0][0], mat[1][1], mat[2][2]));
 }
 
 void Object::SetScale(glm::vec3 const& scale) noexcept {
-  this->scale_matrix_ = glm::scale(glm::mat4(1.0F), scale);
+  ObjectTransform& current = transform();
+  current.scale = scale;
+  MarkChanged(current);
+}
+
+void ReportTransformChanged(Entity entity, ObjectTransform& transform) {
+  transform.dirty = true;
+  // atomic, the consumer clears it while other threads may set it
+  if (!std::atomic_ref<bool>(transform.snapshot_pending)
+           .exchange(true, std::memory_order_relaxed)) {
+    // attached objects are published once their world matrix is rebuilt
+    if (transform.node.valid()) {
+      ObjectScene::GetInstance().MarkChanged(entity);
+    } else {
+      RenderSnapshot::Objects().MarkChanged(entity);
+    }
+  }
 }
 
-
-void Object::UpdateModelMatrix() noexcept {
-  bool flag = false;
-  if (translation_matrix_buf_ != translation_matrix_) {
-    translation_matrix_buf_ = translation_matrix_;
-    flag = true;
-  }
-  if (rotation_matrix_buf_ != rotation_matrix_) {
-    rotation_matrix_buf_ = rotation_matrix_;
-    flag = true;
-  }
-  if (scale_matrix_buf_ != scale_matrix_) {
-    scale_matrix_buf_ = scale_matrix_;
-    flag = true;
-  }
-  if (flag) {
-    full_matrix_ = translation_matrix_ * rotation_matrix_ * scale_matrix_;
-  }
+std::string const& ObjectTransformResource() {
+  static const std::string name =
+      World::Objects().ResourceName<ObjectTransform>();
+  return name;
 }
-}  // namespace engine::core
\ No newline at end of file
+}  // namespace engine::core
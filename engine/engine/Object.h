@@ -4,36 +4,118 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <atomic>
 #include <string>
+#include <optional>
 
 #include "Ticker.h"
+#include "core/ObjectScene.h"
+#include "core/RenderSnapshot.h"
+#include "core/World.h"
 #include "engine/client/render/Renderer.h"
 
 namespace engine::client::render {
 class Renderer;
 }
 namespace engine::core {
+// Transform of an Object, a component of its entity in World::Objects().
+struct ObjectTransform {
+  glm::vec3 position = glm::vec3(0.0F);
+  glm::quat rotation = glm::quat(1.0F, 0.0F, 0.0F, 0.0F);
+  glm::vec3 scale = glm::vec3(1.0F);
+  // node in ObjectScene's graph once attached to a parent or a parent of
+  // others; the transform is then relative to the parent
+  Handle node;
+  bool dirty = true;
+  // reported to RenderSnapshot::Objects(), or to ObjectScene for entities
+  // with a node, since they last took it; only accessed through
+  // std::atomic_ref
+  alignas(std::atomic_ref<bool>::required_alignment) bool snapshot_pending =
+      false;
+
+  // translation * rotation * scale
+  [[nodiscard]] glm::mat4 model_matrix() const noexcept {
+    glm::mat4 model = glm::mat4_cast(rotation);
+    model[0] *= scale.x;
+    model[1] *= scale.y;
+    model[2] *= scale.z;
+    model[3] = glm::vec4(position, 1.0F);
+    return model;
+  }
+};
+
+// Flags the transform of the entity dirty and reports it to the render
+// snapshot, or to ObjectScene for attached entities, once per tick. Called
+// by every write of an ObjectTransform; node and snapshot_pending are left
+// to ObjectScene and the snapshot.
+void ReportTransformChanged(Entity entity, ObjectTransform& transform);
+
+// Resource name of the ObjectTransform components of World::Objects() in
+// system descs. The default system writes it, since Object tickers run
+// there; an Object moved to another system needs that system to declare
+// it as well.
+[[nodiscard]] std::string const& ObjectTransformResource();
+
+// Queries and systems of World::Objects() writing transforms report them
+// like the Object setters do.
+template <>
+struct ComponentWritten<ObjectTransform> {
+  static constexpr bool kEnabled = true;
+  static void Report(Entity entity, ObjectTransform& transform) {
+    ReportTransformChanged(entity, transform);
+  }
+};
+
+// Ticker with a transform, kept for compatibility on top of the entity
+// component store: the state of every Object is an entity of
+// World::Objects() with an ObjectTransform, so systems of that world can
+// iterate the transforms of all objects linearly. Such systems conflict
+// with the default system the objects tick in, see
+// ObjectTransformResource(), and their writes are reported through
+// ComponentWritten; code writing transforms through ForEachChunk or Get
+// calls ReportTransformChanged itself. The transform is kept as
+// position, rotation quaternion and scale; the matrices are derived from
+// them when asked for.
+//
+// Objects are created and destroyed through deferred commands of the
+// world, so its structure only changes at the tick boundary and any thread
+// may create or destroy objects. The accessors don't lock: they keep a
+// pointer to the transform and look it up again only when the structure
+// of the world changed. Until the tick boundary a new object keeps its
+// transform in a block handed over to the world by the create command.
+// Like the tickers writing the transforms, accessors called from threads
+// other than the update threads race with that boundary. The entity of an
+// object must only be destroyed by the object.
 class Object : public Ticker {
  public:
   explicit Object(const uint32_t tickrate, glm::vec3 coords = glm::vec3(0.0F),
          glm::vec3 angle = glm::vec3(2 * 3.1415927F),
          glm::vec3 scale = glm::vec3(1.0F))
-      : Ticker(tickrate) {
-    this->Move(coords);
-    this->Rotate(angle);
-    this->Scale(scale);
+      : Ticker(tickrate),
+        entity_(World::Objects().Reserve()) {
+    Spawn(coords, angle, scale);
   }
   explicit Object(const uint32_t tickrate, std::thread::id const& thread_id,
          glm::vec3 coords = glm::vec3(0.0F),
          glm::vec3 angle = glm::vec3(2 * 3.1415927F),
          glm::vec3 scale = glm::vec3(1.0F))
-      : Ticker(tickrate, thread_id) {
-    this->Move(coords);
-    this->Rotate(angle);
-    this->Scale(scale);
+      : Ticker(tickrate, thread_id),
+        entity_(World::Objects().Reserve()) {
+    Spawn(coords, angle, scale);
   }
+  ~Object() override;
 
+  /* Disable copy and move semantics. */
+  Object(const Object&) = delete;
+  Object(Object&&) = delete;
+  Object& operator=(const Object&) = delete;
+  Object& operator=(Object&&) = delete;
+
+  // Entity of the object in World::Objects(), created at the next tick
+  // boundary. Other components can be added to it by deferred commands.
+  [[nodiscard]] Entity entity() const noexcept { return entity_; }
 
   [[nodiscard]] virtual std::shared_ptr<engine::client::render::Renderer>
   renderer()  {
@@ -45,16 +127,36 @@ class Object : public Ticker {
   [[nodiscard]] glm::mat4 translation_matrix() const noexcept;
   [[nodiscard]] glm::mat4 rotation_matrix() const noexcept;
   [[nodiscard]] glm::mat4 scale_matrix() const noexcept;
-  [[nodiscard]] glm::mat4 model_matrix() noexcept;
+  // translation * rotation * scale, relative to the parent for attached
+  // objects
+  [[nodiscard]] glm::mat4 model_matrix() const noexcept;
+  // Model matrix in the frame the render thread took last with
+  // RenderSnapshot::Objects().Acquire(), i.e. as of the end of a tick; the
+  // world matrix for attached objects. Empty for objects not published in
+  // that frame, which the renderer skips. Render thread only.
+  [[nodiscard]] std::optional<glm::mat4> published_model_matrix()
+      const noexcept;
 
   [[nodiscard]] glm::vec3 position() const noexcept;
+  [[nodiscard]] glm::quat rotation() const noexcept;
   [[nodiscard]] glm::vec3 scale() const noexcept;
 
+  // Attaches the object below parent, its transform becoming relative to
+  // the parent's, or detaches it for nullptr. Applied at the next tick
+  // boundary, see ObjectScene; ignored if parent is attached below this
+  // object. Destroying the parent detaches the object.
+  void SetParent(Object const* parent);
+
+  // true if the transform changed since the last ClearTransformDirty, so
+  // whoever caches the model matrix (e.g. a renderer) knows to rebuild it
+  [[nodiscard]] bool transform_dirty() const noexcept;
+  void ClearTransformDirty() noexcept;
+
   // move object by this coords(object.x += coords.x, object.y += coords.y etc.)
   void Move(glm::vec3 const& coords) noexcept;
   // move object by this coords(object.x += coords.x, object.y += coords.y etc.)
   void Move(const float x, const float y, const float z) noexcept;
-  // set translation matrix
+  // set translation matrix, only its translation column is kept
   void SetTranslationMatrix(glm::mat4 const& mat) noexcept;
   // set current position
   void SetPosition(glm::vec3 const& pos) noexcept;
@@ -75,8 +177,10 @@ class Object : public Ticker {
   // angle should be defined in radians
   // rotate object by given angle
   void RotateZ(const float angle) noexcept;
-  // set rotation matrix
+  // set rotation matrix, it should be a pure rotation
   void SetRotationMatrix(glm::mat4 const& mat) noexcept;
+  // rotation should be normalized
+  void SetRotation(glm::quat const& rotation) noexcept;
   // set rotation angles
   void SetRotation(glm::vec3 const& angle) noexcept;
   // set rotation angles
@@ -93,21 +197,28 @@ class Object : public Ticker {
   void ScaleY(const int scale) noexcept;
   // scale object by value (transforms current scale)
   void ScaleZ(const int scale) noexcept;
-  // set scale matrix
+  // set scale matrix, only its diagonal is kept
   void SetScaleMatrix(glm::mat4 const& mat) noexcept;
   // set current scale
   void SetScale(glm::vec3 const& scale) noexcept;
 
  private:
-  void UpdateModelMatrix() noexcept;
-
-  glm::mat4 translation_matrix_ = glm::mat4(1.0F);
-  glm::mat4 rotation_matrix_ = glm::mat4(1.0F);
-  glm::mat4 scale_matrix_ = glm::mat4(1.0F);
-  glm::mat4 full_matrix_ = glm::mat4(1.0F);
+  // Queues the creation of the entity, its transform pending until then.
+  // Doesn't touch the world, so objects can be created from any thread.
+  void Spawn(glm::vec3 const& coords, glm::vec3 const& angle,
+             glm::vec3 const& scale);
+  // Transform of the object, looked up again after structural changes.
+  [[nodiscard]] ObjectTransform& transform() const noexcept;
+  // ReportTransformChanged for the entity of the object.
+  void MarkChanged(ObjectTransform& transform) const {
+    ReportTransformChanged(entity_, transform);
+  }
 
-  glm::mat4 translation_matrix_buf_ = glm::mat4(1.0F);
-  glm::mat4 rotation_matrix_buf_ = glm::mat4(1.0F);
-  glm::mat4 scale_matrix_buf_ = glm::mat4(1.0F);
+  const Entity entity_;
+  // transform_ is valid for World::Objects().structure_version() ==
+  // transform_version_; both are written by whichever thread notices a
+  // change first
+  mutable std::atomic<ObjectTransform*> transform_ = nullptr;
+  mutable std::atomic<uint64_t> transform_version_ = 0;
 };
-}  // namespace engine::core
\ No newline at end of file
+}  // namespace engine::core
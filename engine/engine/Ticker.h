@@ -1,9 +1,22 @@
 #pragma once
+#include <atomic>
 #include <chrono>
+#include <memory>
+#include <limits>
 #include <thread>
+
+#include "core/HandleTable.h"
+#include "core/MpscQueue.h"
+#include "core/TickContext.h"
+#include "core/UpdateStats.h"
 namespace engine::core {
+class Core;
+class TickerRegistry;
 class Ticker {
  public:
+  // phase() is picked by the Core when the ticker is added
+  static constexpr uint32_t kAutoPhase = std::numeric_limits<uint32_t>::max();
+
   /// <summary>
   /// Ticker class constructor.
   /// If tickrate is zero, 
@@ -23,20 +36,17 @@ class Ticker {
   /// </summary>
   /// <param name="tick"></param>
   /// <param name="time_delta"></param>
-  void UpdateExecutionTime(const uint64_t tick) {
-    if ( (tick % tickrate() != 0) || !needs_update_) {
+  void UpdateExecutionTime(const uint64_t tick, TickContext& context) {
+    if (!due(tick)) {
       return;
     }
-    auto start = std::chrono::high_resolution_clock::now();
-    Update(tick);
-    double exec_time =
-        (double(std::chrono::duration_cast<std::chrono::nanoseconds>(
-                    std::chrono::high_resolution_clock::now() - start)
-                    .count())) /
-        10e9;
-    this->average_update_time_ =
-        average_update_time_ * double(calls_counter_) + exec_time;
-    this->average_update_time_ /= ++calls_counter_;
+    auto start = std::chrono::steady_clock::now();
+    Update(tick, context);
+    stats_.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count(),
+                  context.record_histogram);
+    calls_counter_++;
   }
   /// <summary>
   /// 
@@ -47,8 +57,31 @@ class Ticker {
     // Intentionally unimplemented
   }
 
+  /// <summary>
+  /// Called by the update threads. Override this instead of Update(tick)
+  /// to get the per-thread frame allocator, memory from it is valid until
+  /// the end of the tick.
+  /// </summary>
+  /// <param name="tick">current engine tick</param>
+  /// <param name="context">thread the ticker runs on and its allocator</param>
+  virtual void Update(const uint64_t tick, TickContext& /*context*/) {
+    Update(tick);
+  }
+
   [[nodiscard]] uint32_t tickrate() const noexcept { return tickrate_; }
 
+  // Returns true if Update should be called on this tick
+  [[nodiscard]] bool due(const uint64_t tick) const noexcept {
+    return needs_update() && tickrate_ != 0 && (tick % tickrate_) == phase();
+  }
+
+  // The ticker is updated on ticks where tick % tickrate() == phase().
+  // Spreading the phases of tickers with the same tickrate keeps them from
+  // all landing on the same tick.
+  [[nodiscard]] uint32_t phase() const noexcept {
+    return (phase_ == kAutoPhase || tickrate_ == 0) ? 0 : phase_ % tickrate_;
+  }
+
   // If the thread_id() is not equal to nullptr, then we should update this
   // object only in the thread with this id
   [[nodiscard]] std::weak_ptr<std::thread::id> thread_id() const {
@@ -56,15 +89,43 @@ class Ticker {
   }
 
   /// <summary>
-  /// Returns average Update execution time(in seconds).
+  /// Returns average Update execution time(in seconds). The mean is
+  /// exponentially decayed, so it follows the recent updates.
   /// </summary>
   /// <returns>Average Update execution time.</returns>
   [[nodiscard]] double average_update_time() const noexcept {
-    return average_update_time_;
+    return stats_.mean();
   }
-  [[nodiscard]] int calls_counter() const noexcept { return calls_counter_; }
+  // Distribution, percentiles and maximum of the Update execution time.
+  [[nodiscard]] UpdateStats const& update_stats() const noexcept {
+    return stats_;
+  }
+  [[nodiscard]] uint64_t calls_counter() const noexcept {
+    return calls_counter_;
+  }
+
+  [[nodiscard]] bool needs_update() const noexcept {
+    return needs_update_.load(std::memory_order_relaxed);
+  }
+
+  // Stable id assigned by the Core in deterministic mode, in the order the
+  // tickers were added. 0 until assigned.
+  [[nodiscard]] uint64_t id() const noexcept { return id_; }
+
+  // Hash of the state of the ticker. In deterministic mode the Core
+  // combines the hashes of every updated ticker into a per-tick state hash
+  // which two runs over the same input can compare.
+  [[nodiscard]] virtual uint64_t StateHash() const { return 0; }
+
+  // Id of the system registered with Core::RegisterSystem this ticker
+  // belongs to. Tickers of one system run only after every system it
+  // depends on has finished for the current tick.
+  [[nodiscard]] uint32_t system() const noexcept { return system_; }
 
-  [[nodiscard]] bool needs_update() const noexcept { return needs_update_; }
+  // Id of the tick domain registered with Core::RegisterTickDomain this
+  // ticker belongs to. The tick passed to Update counts the steps of that
+  // domain and tickrate() divides it.
+  [[nodiscard]] uint32_t domain() const noexcept { return domain_; }
 
  protected:
   void SetTickrate(uint32_t tickrate) { tickrate_ = tickrate; }
@@ -72,15 +133,53 @@ class Ticker {
     thread_id_ = std::make_shared<std::thread::id>(id);
   }
 
-  void DisableUpdating() { needs_update_ = false; }
-  void EnableUpdating() { needs_update_ = true; }
+  // Should be called before the object is added to the Core
+  void SetSystem(uint32_t system) noexcept { system_ = system; }
+  // Should be called before the object is added to the Core
+  void SetDomain(uint32_t domain) noexcept { domain_ = domain; }
+  // Should be called before the object is added to the Core, otherwise the
+  // Core assigns a phase itself
+  void SetPhase(uint32_t phase) noexcept { phase_ = phase; }
+
+  // A disabled ticker is taken out of scheduling the next time it is due
+  // and costs nothing until EnableUpdating, which can be called from any
+  // thread and schedules it again from the next tick.
+  void DisableUpdating() {
+    needs_update_.store(false, std::memory_order_seq_cst);
+  }
+  void EnableUpdating() {
+    needs_update_.store(true, std::memory_order_seq_cst);
+    // pairs with the check in TickerRegistry::Flush; while kWaking the
+    // registry waits before destroying the queue or parking us again
+    ParkState expected = ParkState::kParked;
+    if (parked_.compare_exchange_strong(expected, ParkState::kWaking,
+                                        std::memory_order_seq_cst)) {
+      parked_in_->Push(parked_handle_);
+      parked_.store(ParkState::kNone, std::memory_order_release);
+    }
+  }
 
  private:
+  friend class Core;
+  friend class TickerRegistry;
+
   uint32_t tickrate_;
-  int calls_counter_ = 0;
-  double average_update_time_ = 0;
+  uint64_t calls_counter_ = 0;
+  UpdateStats stats_;
+
+  enum class ParkState : uint32_t { kNone = 0, kParked = 1, kWaking = 2 };
 
-  bool needs_update_ = true;
+  std::atomic<bool> needs_update_ = true;
+  // kParked while the registry of parked_in_ holds the ticker out of
+  // scheduling, EnableUpdating pushes parked_handle_ to wake it. The
+  // registry resets it to kNone when it drops the ticker or is destroyed.
+  std::atomic<ParkState> parked_ = ParkState::kNone;
+  MpscQueue<Handle>* parked_in_ = nullptr;
+  Handle parked_handle_;
+  uint32_t system_ = 0;
+  uint32_t domain_ = 0;
+  uint32_t phase_ = kAutoPhase;
+  uint64_t id_ = 0;
 
   std::shared_ptr<std::thread::id> thread_id_ =
       std::shared_ptr<std::thread::id>(nullptr);
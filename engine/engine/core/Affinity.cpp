@@ -0,0 +1,137 @@
+#include "Affinity.h"
+
+#include <thread>
+#include <string>
+#include <charconv>
+#include <algorithm>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <fstream>
+#elif defined(_WIN32)
+#include <Windows.h>
+#endif
+
+namespace engine::core {
+
+std::vector<uint32_t> ParseCpuList(std::string_view list) {
+  std::vector<uint32_t> rv;
+  while (!list.empty()) {
+    size_t comma = list.find(',');
+    std::string_view item = list.substr(0, comma);
+    list = comma == std::string_view::npos ? std::string_view()
+                                           : list.substr(comma + 1);
+    while (!item.empty() && (item.front() == ' ' || item.front() == '\n')) {
+      item.remove_prefix(1);
+    }
+    while (!item.empty() && (item.back() == ' ' || item.back() == '\n')) {
+      item.remove_suffix(1);
+    }
+    uint32_t first = 0;
+    uint32_t last = 0;
+    size_t dash = item.find('-');
+    std::string_view a = item.substr(0, dash);
+    auto [pa, ea] = std::from_chars(a.data(), a.data() + a.size(), first);
+    if (ea != std::errc() || pa != a.data() + a.size() || first >= kMaxCpus) {
+      continue;
+    }
+    last = first;
+    if (dash != std::string_view::npos) {
+      std::string_view b = item.substr(dash + 1);
+      auto [pb, eb] = std::from_chars(b.data(), b.data() + b.size(), last);
+      if (eb != std::errc() || pb != b.data() + b.size() || last < first ||
+          last >= kMaxCpus) {
+        continue;
+      }
+    }
+    for (uint32_t cpu = first; cpu <= last; cpu++) {
+      rv.push_back(cpu);
+    }
+  }
+  return rv;
+}
+
+uint32_t CpuCount() {
+  return std::max<uint32_t>(1, std::thread::hardware_concurrency());
+}
+
+#if defined(__linux__)
+
+std::vector<uint32_t> CpuNumaNodes() {
+  std::vector<uint32_t> rv(CpuCount(), 0);
+  for (uint32_t node = 0;; node++) {
+    std::ifstream file("/sys/devices/system/node/node" +
+                       std::to_string(node) + "/cpulist");
+    if (!file.is_open()) {
+      break;
+    }
+    std::string list;
+    std::getline(file, list);
+    for (uint32_t cpu : ParseCpuList(list)) {
+      if (cpu >= rv.size()) {
+        rv.resize(cpu + 1, 0);
+      }
+      rv[cpu] = node;
+    }
+  }
+  return rv;
+}
+
+bool PinCurrentThread(std::vector<uint32_t> const& cpus) {
+  if (cpus.empty()) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (uint32_t cpu : cpus) {
+    if (cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+#elif defined(_WIN32)
+
+std::vector<uint32_t> CpuNumaNodes() {
+  std::vector<uint32_t> rv(CpuCount(), 0);
+  ULONG highest = 0;
+  if (!GetNumaHighestNodeNumber(&highest)) {
+    return rv;
+  }
+  for (USHORT node = 0; node <= highest; node++) {
+    ULONGLONG mask = 0;
+    if (!GetNumaNodeProcessorMask(UCHAR(node), &mask)) {
+      continue;
+    }
+    for (uint32_t cpu = 0; cpu < 64 && cpu < rv.size(); cpu++) {
+      if ((mask >> cpu) & 1) {
+        rv[cpu] = node;
+      }
+    }
+  }
+  return rv;
+}
+
+bool PinCurrentThread(std::vector<uint32_t> const& cpus) {
+  // only the first processor group is supported
+  DWORD_PTR mask = 0;
+  for (uint32_t cpu : cpus) {
+    if (cpu < sizeof(DWORD_PTR) * 8) {
+      mask |= DWORD_PTR(1) << cpu;
+    }
+  }
+  return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+}
+
+#else
+
+std::vector<uint32_t> CpuNumaNodes() {
+  return std::vector<uint32_t>(CpuCount(), 0);
+}
+
+bool PinCurrentThread(std::vector<uint32_t> const&) { return false; }
+
+#endif
+}  // namespace engine::core
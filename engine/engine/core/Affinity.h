@@ -0,0 +1,27 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+namespace engine::core {
+
+// Highest number of logical CPUs ParseCpuList accepts, the size of a Linux
+// cpu_set_t.
+inline constexpr uint32_t kMaxCpus = 1024;
+
+// Parses a CPU list in the Linux cpulist format, e.g. "0-3,8,10-11".
+// Malformed entries, reversed ranges and entries naming a CPU id of
+// kMaxCpus or above are skipped.
+[[nodiscard]] std::vector<uint32_t> ParseCpuList(std::string_view list);
+
+// Number of logical CPUs the process may run on.
+[[nodiscard]] uint32_t CpuCount();
+
+// NUMA node of every logical CPU, indexed by CPU id.
+// Every CPU is reported on node 0 if the topology is unknown.
+[[nodiscard]] std::vector<uint32_t> CpuNumaNodes();
+
+// Restricts the calling thread to the given CPUs.
+// Returns false if the platform refused or doesn't support it.
+bool PinCurrentThread(std::vector<uint32_t> const& cpus);
+}  // namespace engine::core
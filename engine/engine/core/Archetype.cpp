@@ -0,0 +1,83 @@
+#include "Archetype.h"
+
+namespace engine::core {
+
+Archetype::Archetype(std::vector<ComponentId> components)
+    : components_(std::move(components)) {
+  size_t row_bytes = sizeof(Handle);
+  // worst case alignment padding of the column arrays
+  size_t padding = 0;
+  for (ComponentId id : components_) {
+    ComponentInfo const& info = GetComponentInfo(id);
+    infos_.push_back(&info);
+    sizes_.push_back(info.size);
+    row_bytes += info.size;
+    padding += info.alignment;
+  }
+  chunk_bytes_ = std::max(kChunkBytes, row_bytes + padding);
+  capacity_ = (chunk_bytes_ - padding) / row_bytes;
+  size_t offset = sizeof(Handle) * capacity_;
+  for (ComponentInfo const* info : infos_) {
+    offset = (offset + info->alignment - 1) / info->alignment * info->alignment;
+    offsets_.push_back(offset);
+    offset += info->size * capacity_;
+  }
+}
+
+Archetype::~Archetype() {
+  for (size_t chunk = 0; chunk < chunk_count(); chunk++) {
+    const size_t rows = chunk_size(chunk);
+    for (size_t column = 0; column < infos_.size(); column++) {
+      auto* data = static_cast<std::byte*>(column_data(chunk, column));
+      for (size_t row = 0; row < rows; row++) {
+        infos_[column]->destroy(data + row * sizes_[column]);
+      }
+    }
+  }
+}
+
+uint32_t Archetype::Append(Handle entity) {
+  const auto row = uint32_t(size_);
+  if (size_ == chunks_.size() * capacity_) {
+    chunks_.emplace_back(static_cast<std::byte*>(
+        ::operator new[](chunk_bytes_, std::align_val_t(64))));
+  }
+  size_++;
+  new (&entity_slot(row)) Handle(entity);
+  return row;
+}
+
+Handle Archetype::Remove(uint32_t row, bool destroy) {
+  if (destroy) {
+    for (size_t column = 0; column < infos_.size(); column++) {
+      infos_[column]->destroy(component(row, column));
+    }
+  }
+  const auto last = uint32_t(size_ - 1);
+  Handle moved;
+  if (row != last) {
+    for (size_t column = 0; column < infos_.size(); column++) {
+      infos_[column]->relocate(component(row, column),
+                               component(last, column));
+    }
+    moved = entity(last);
+    entity_slot(row) = moved;
+  }
+  size_--;
+  return moved;
+}
+
+Archetype* Archetype::edge(ComponentId id, bool add) const noexcept {
+  auto const& edges = add ? add_edges_ : remove_edges_;
+  for (auto const& [component, archetype] : edges) {
+    if (component == id) {
+      return archetype;
+    }
+  }
+  return nullptr;
+}
+
+void Archetype::SetEdge(ComponentId id, bool add, Archetype* archetype) {
+  (add ? add_edges_ : remove_edges_).emplace_back(id, archetype);
+}
+}  // namespace engine::core
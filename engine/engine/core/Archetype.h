@@ -0,0 +1,113 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+#include "Component.h"
+#include "HandleTable.h"
+
+namespace engine::core {
+
+// Storage of every entity with one exact set of component types.
+//
+// Entities are rows packed densely into chunks of kChunkBytes. A chunk
+// holds the entity handles followed by one array per component type, so a
+// query walks each component as a contiguous array. Removing a row moves
+// the last row into its place. Not thread safe.
+class Archetype {
+ public:
+  static constexpr size_t kChunkBytes = 16 * 1024;
+  static constexpr size_t kNoColumn = SIZE_MAX;
+
+  // components have to be sorted and unique
+  explicit Archetype(std::vector<ComponentId> components);
+  // destroys the components of the remaining rows
+  ~Archetype();
+
+  /* Disable copy and move semantics. */
+  Archetype(const Archetype&) = delete;
+  Archetype(Archetype&&) = delete;
+  Archetype& operator=(const Archetype&) = delete;
+  Archetype& operator=(Archetype&&) = delete;
+
+  [[nodiscard]] std::vector<ComponentId> const& components() const noexcept {
+    return components_;
+  }
+  // Column of the component type, kNoColumn if the archetype lacks it.
+  [[nodiscard]] size_t column(ComponentId id) const noexcept {
+    auto it = std::lower_bound(components_.begin(), components_.end(), id);
+    return it == components_.end() || *it != id
+               ? kNoColumn
+               : size_t(it - components_.begin());
+  }
+
+  [[nodiscard]] ComponentInfo const& info(size_t column) const noexcept {
+    return *infos_[column];
+  }
+
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+  [[nodiscard]] size_t chunk_count() const noexcept {
+    return (size_ + capacity_ - 1) / capacity_;
+  }
+  [[nodiscard]] size_t chunk_capacity() const noexcept { return capacity_; }
+  // rows in the chunk
+  [[nodiscard]] size_t chunk_size(size_t chunk) const noexcept {
+    return std::min(capacity_, size_ - chunk * capacity_);
+  }
+
+  [[nodiscard]] Handle const* entities(size_t chunk) const noexcept {
+    return reinterpret_cast<Handle const*>(chunks_[chunk].get());
+  }
+  [[nodiscard]] void* column_data(size_t chunk, size_t column) noexcept {
+    return chunks_[chunk].get() + offsets_[column];
+  }
+  [[nodiscard]] Handle entity(uint32_t row) const noexcept {
+    return entities(row / capacity_)[row % capacity_];
+  }
+  [[nodiscard]] void* component(uint32_t row, size_t column) noexcept {
+    return static_cast<std::byte*>(column_data(row / capacity_, column)) +
+           (row % capacity_) * sizes_[column];
+  }
+
+  // Appends a row for the entity and returns it. The components of the
+  // row are left unconstructed.
+  uint32_t Append(Handle entity);
+  // Removes the row, destroying its components unless destroy is false
+  // (they were relocated already). Returns the entity moved into the row,
+  // an invalid handle if the row was the last one.
+  Handle Remove(uint32_t row, bool destroy);
+
+  // Archetype with the component added or removed, nullptr until set.
+  [[nodiscard]] Archetype* edge(ComponentId id, bool add) const noexcept;
+  void SetEdge(ComponentId id, bool add, Archetype* archetype);
+
+ private:
+  struct ChunkDeleter {
+    void operator()(std::byte* chunk) const noexcept {
+      ::operator delete[](chunk, std::align_val_t(64));
+    }
+  };
+
+  [[nodiscard]] Handle& entity_slot(uint32_t row) noexcept {
+    return reinterpret_cast<Handle*>(
+        chunks_[row / capacity_].get())[row % capacity_];
+  }
+
+  const std::vector<ComponentId> components_;
+  std::vector<ComponentInfo const*> infos_;
+  std::vector<size_t> sizes_;
+  // of each column array from the start of a chunk
+  std::vector<size_t> offsets_;
+  size_t chunk_bytes_ = kChunkBytes;
+  size_t capacity_ = 0;
+  size_t size_ = 0;
+  // chunks are kept when rows are removed and reused
+  std::vector<std::unique_ptr<std::byte[], ChunkDeleter>> chunks_;
+
+  std::vector<std::pair<ComponentId, Archetype*>> add_edges_;
+  std::vector<std::pair<ComponentId, Archetype*>> remove_edges_;
+};
+}  // namespace engine::core
@@ -0,0 +1,168 @@
+#pragma once
+#include <mutex>
+#include <span>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+
+#include "Clock.h"
+#include "HandleTable.h"
+#include "engine/Core.h"
+
+namespace engine::core {
+
+// Ticker updating many homogeneous items at once.
+//
+// The items of a batch are stored contiguously and updated by
+// UpdateBatch over chunks of them instead of one virtual call per item, so
+// the loop can be vectorized. A batch is added to the Core like any other
+// ticker (tickrate, domain, system and phase apply to the whole batch);
+// when it is due its chunks are spread over the update threads with
+// Core::ParallelFor.
+//
+// The chunk size aims at kTargetChunkTime of work per chunk, measured from
+// the previous updates, and is capped so that every thread gets several
+// chunks. It never drops below min_grain.
+//
+//   struct Particle { glm::vec3 position; glm::vec3 velocity; };
+//   class Particles : public Batch<Particle> {
+//    public:
+//     Particles() : Batch(1) {}
+//     void UpdateBatch(std::span<Particle> items, uint64_t tick) override {
+//       for (Particle& p : items) p.position += p.velocity;
+//     }
+//   };
+template <typename T>
+class Batch : public Ticker {
+ public:
+  explicit Batch(uint32_t tickrate, size_t min_grain = 64)
+      : Ticker(tickrate), min_grain_(std::max<size_t>(min_grain, 1)) {}
+
+  // Called in parallel with disjoint chunks of the items, must only touch
+  // the items it was given.
+  virtual void UpdateBatch(std::span<T> items, uint64_t tick) = 0;
+
+  // Adds an item, it is stored and updated from the next update of the
+  // batch on. Can be called from any thread.
+  Handle Add(T item) {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    Handle handle = slots_.Allocate(Handle::kInvalidIndex);
+    to_add_.emplace_back(handle, std::move(item));
+    return handle;
+  }
+
+  // Removes the item before the next update of the batch. Stale handles
+  // are ignored. Can be called from any thread.
+  void Remove(Handle handle) {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    to_remove_.push_back(handle);
+  }
+
+  // Returns nullptr for stale handles and items not stored yet. Must not
+  // be called while the batch updates; the pointer is valid until the next
+  // update.
+  [[nodiscard]] T* Get(Handle handle) {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    uint32_t const* index = slots_.Get(handle);
+    return index == nullptr || *index == Handle::kInvalidIndex
+               ? nullptr
+               : &items_[*index];
+  }
+
+  // Stored items, in no particular order. Must not be used while the
+  // batch updates.
+  [[nodiscard]] std::span<T> items() noexcept { return items_; }
+
+  // Chunk size of the last update.
+  [[nodiscard]] size_t grain() const noexcept { return grain_; }
+
+  void Update(const uint64_t tick, TickContext& context) final {
+    ApplyChanges();
+    const size_t count = items_.size();
+    if (count == 0) {
+      return;
+    }
+    // Core::GetInstance would copy a shared_ptr on every update
+    Core& core = *context.core;
+    grain_ = Grain(count, core.thread_count());
+    busy_time_.store(0, std::memory_order_relaxed);
+    core.ParallelFor(count, grain_, [this, tick](size_t begin, size_t end) {
+      const int64_t start = Clock::Now();
+      UpdateBatch(std::span<T>(items_.data() + begin, end - begin), tick);
+      busy_time_.fetch_add(Clock::Now() - start, std::memory_order_relaxed);
+    });
+    const double time_per_item =
+        double(busy_time_.load(std::memory_order_relaxed)) / double(count);
+    time_per_item_ = time_per_item_ == 0
+                         ? time_per_item
+                         : time_per_item_ + (time_per_item - time_per_item_) *
+                                                kTimeDecay;
+  }
+
+ private:
+  // work per chunk the grain aims at, in nanoseconds
+  static constexpr double kTargetChunkTime = 20'000;
+  // chunks per thread at least, so uneven chunks even out
+  static constexpr size_t kChunksPerThread = 4;
+  static constexpr double kTimeDecay = 0.25;
+
+  [[nodiscard]] size_t Grain(size_t count, size_t threads) const noexcept {
+    size_t grain = time_per_item_ > 0
+                       ? size_t(kTargetChunkTime / time_per_item_)
+                       : min_grain_;
+    grain = std::min(grain, count / (std::max<size_t>(threads, 1) *
+                                     kChunksPerThread));
+    return std::max(grain, min_grain_);
+  }
+
+  // Applies queued adds and removals, removal swaps with the last item.
+  void ApplyChanges() {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    for (auto& [handle, item] : to_add_) {
+      uint32_t* index = slots_.Get(handle);
+      if (index == nullptr) {
+        continue;
+      }
+      *index = uint32_t(items_.size());
+      items_.push_back(std::move(item));
+      handles_.push_back(handle);
+    }
+    to_add_.clear();
+    for (Handle handle : to_remove_) {
+      uint32_t const* slot = slots_.Get(handle);
+      if (slot == nullptr) {
+        continue;
+      }
+      const uint32_t index = *slot;
+      const uint32_t last = uint32_t(items_.size() - 1);
+      if (index != last) {
+        items_[index] = std::move(items_[last]);
+        handles_[index] = handles_[last];
+        *slots_.Get(handles_[index]) = index;
+      }
+      items_.pop_back();
+      handles_.pop_back();
+      slots_.Release(handle);
+    }
+    to_remove_.clear();
+  }
+
+  const size_t min_grain_;
+  size_t grain_ = 0;
+  // nanoseconds of UpdateBatch per item, decayed over the updates
+  double time_per_item_ = 0;
+  std::atomic<int64_t> busy_time_ = 0;
+
+  std::vector<T> items_;
+  // handle of every item, parallel to items_
+  std::vector<Handle> handles_;
+
+  std::mutex mutex_;
+  // index of the item in items_, kInvalidIndex until it is stored
+  HandleTable<uint32_t> slots_;
+  std::vector<std::pair<Handle, T>> to_add_;
+  std::vector<Handle> to_remove_;
+};
+}  // namespace engine::core
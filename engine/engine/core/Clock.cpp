@@ -0,0 +1,67 @@
+#include "Clock.h"
+
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace engine::core {
+
+namespace {
+bool InvariantTsc() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  int regs[4] = {};
+  __cpuid(regs, 0x80000000);
+  if (unsigned(regs[0]) < 0x80000007U) {
+    return false;
+  }
+  __cpuid(regs, 0x80000007);
+  return (regs[3] & (1 << 8)) != 0;
+#elif defined(__x86_64__) || defined(__i386__)
+  unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (__get_cpuid_max(0x80000000U, nullptr) < 0x80000007U) {
+    return false;
+  }
+  __get_cpuid(0x80000007U, &eax, &ebx, &ecx, &edx);
+  return (edx & (1U << 8)) != 0;
+#else
+  return false;
+#endif
+}
+
+[[maybe_unused]] uint64_t ReadTsc() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+}  // namespace
+
+Clock::Clock() : origin_(std::chrono::steady_clock::now()) {
+  if (!InvariantTsc()) {
+    return;
+  }
+  // Calibrate the TSC against steady_clock. 20ms gives an error well below
+  // what matters for profiling, ticks are paced by steady_clock anyway.
+  using namespace std::chrono;
+  auto start = steady_clock::now();
+  uint64_t tsc_start = ReadTsc();
+  std::this_thread::sleep_for(milliseconds(20));
+  auto end = steady_clock::now();
+  uint64_t tsc_end = ReadTsc();
+
+  auto ns = duration_cast<nanoseconds>(end - start).count();
+  if (ns <= 0 || tsc_end <= tsc_start) {
+    return;
+  }
+  cycles_per_second_ = uint64_t(double(tsc_end - tsc_start) * 1e9 / double(ns));
+  tsc_ = cycles_per_second_ != 0;
+  if (!tsc_) {
+    cycles_per_second_ = 1'000'000'000;
+  }
+}
+}  // namespace engine::core
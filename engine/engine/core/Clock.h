@@ -0,0 +1,78 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace engine::core {
+
+// Engine time source.
+//
+// Now() is the tick clock: integer nanoseconds on std::chrono::steady_clock
+// counted from the moment the clock was first used. It never jumps with
+// wall-clock adjustments and doesn't lose precision with uptime.
+//
+// Cycles() is a cheap timestamp for measuring short intervals. It reads the
+// TSC when the CPU reports an invariant one and falls back to Now()
+// otherwise. Use CyclesToNanoseconds to convert a difference of two
+// readings.
+class Clock {
+ public:
+  using time_point = std::chrono::steady_clock::time_point;
+
+  [[nodiscard]] static int64_t Now() noexcept {
+    // steady_clock's period is only 1ns on some platforms
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - instance().origin_)
+        .count();
+  }
+
+  [[nodiscard]] static time_point ToTimePoint(int64_t ns) noexcept {
+    return instance().origin_ +
+           std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+               std::chrono::nanoseconds(ns));
+  }
+
+  [[nodiscard]] static uint64_t Cycles() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    if (instance().tsc_) {
+      return __rdtsc();
+    }
+#elif defined(__x86_64__) || defined(__i386__)
+    if (instance().tsc_) {
+      return __rdtsc();
+    }
+#endif
+    return uint64_t(Now());
+  }
+
+  [[nodiscard]] static int64_t CyclesToNanoseconds(uint64_t cycles) noexcept {
+    const uint64_t hz = instance().cycles_per_second_;
+    // split to keep the multiplication inside 64 bits
+    return int64_t((cycles / hz) * 1'000'000'000 +
+                   ((cycles % hz) * 1'000'000'000) / hz);
+  }
+
+  [[nodiscard]] static uint64_t cycles_per_second() noexcept {
+    return instance().cycles_per_second_;
+  }
+
+  [[nodiscard]] static bool tsc() noexcept { return instance().tsc_; }
+
+ private:
+  Clock();
+
+  static Clock const& instance() noexcept {
+    static const Clock clock;
+    return clock;
+  }
+
+  time_point origin_;
+  bool tsc_ = false;
+  uint64_t cycles_per_second_ = 1'000'000'000;
+};
+}  // namespace engine::core
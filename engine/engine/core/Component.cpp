@@ -0,0 +1,30 @@
+#include "Component.h"
+
+#include <deque>
+#include <mutex>
+
+namespace engine::core {
+
+namespace {
+std::mutex& RegistryMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+// deque, so references handed out stay valid while types are added
+std::deque<ComponentInfo>& Registry() {
+  static std::deque<ComponentInfo> registry;
+  return registry;
+}
+}  // namespace
+
+ComponentId RegisterComponent(ComponentInfo info) {
+  std::scoped_lock<std::mutex> lock(RegistryMutex());
+  Registry().push_back(std::move(info));
+  return ComponentId(Registry().size() - 1);
+}
+
+ComponentInfo const& GetComponentInfo(ComponentId id) {
+  std::scoped_lock<std::mutex> lock(RegistryMutex());
+  return Registry()[id];
+}
+}  // namespace engine::core
@@ -0,0 +1,50 @@
+#pragma once
+#include <new>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <typeinfo>
+#include <type_traits>
+
+namespace engine::core {
+
+using ComponentId = uint32_t;
+
+// What the World needs to know to store a component type in untyped chunk
+// memory.
+struct ComponentInfo {
+  // unique per type, also the resource name of the component in the
+  // system descs of World::AddSystem
+  std::string name;
+  size_t size = 0;
+  size_t alignment = 0;
+  // move constructs the component at destination from source and destroys
+  // source
+  void (*relocate)(void* destination, void* source) noexcept = nullptr;
+  void (*destroy)(void* component) noexcept = nullptr;
+};
+
+// Registers a component type and returns its id. Thread safe.
+ComponentId RegisterComponent(ComponentInfo info);
+// The id has to come from RegisterComponent. Thread safe.
+[[nodiscard]] ComponentInfo const& GetComponentInfo(ComponentId id);
+
+// Id of component type T, registered on first use.
+template <typename T>
+[[nodiscard]] ComponentId ComponentTypeId() {
+  static_assert(std::is_same_v<T, std::remove_cvref_t<T>>,
+                "components are plain object types");
+  static_assert(std::is_nothrow_move_constructible_v<T>,
+                "components are moved between chunks");
+  static_assert(alignof(T) <= 64, "chunks are aligned to 64 bytes");
+  static const ComponentId id = RegisterComponent(
+      {typeid(T).name(), sizeof(T), alignof(T),
+       [](void* destination, void* source) noexcept {
+         T* from = static_cast<T*>(source);
+         new (destination) T(std::move(*from));
+         from->~T();
+       },
+       [](void* component) noexcept { static_cast<T*>(component)->~T(); }});
+  return id;
+}
+}  // namespace engine::core
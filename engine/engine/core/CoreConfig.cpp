@@ -0,0 +1,109 @@
+#include "CoreConfig.h"
+
+#include <string>
+#include <charconv>
+#include <algorithm>
+
+#include "Affinity.h"
+#include "engine/Config.h"
+
+namespace engine::core {
+
+namespace {
+template <typename T>
+void ReadNumber(Config const& config, std::string const& key, T& value) {
+  std::string_view str = config[key];
+  T temp{};
+  auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), temp);
+  if (!str.empty() && ec == std::errc() && ptr == str.data() + str.size()) {
+    value = temp;
+  }
+}
+
+void ReadBool(Config const& config, std::string const& key, bool& value) {
+  std::string_view str = config[key];
+  if (str == "true" || str == "1") {
+    value = true;
+  } else if (str == "false" || str == "0") {
+    value = false;
+  }
+}
+}  // namespace
+
+CoreConfig CoreConfig::Load(Config const& config) {
+  CoreConfig rv;
+  ReadNumber(config, "core_worker_threads", rv.worker_threads);
+  rv.worker_cpus = ParseCpuList(config["core_worker_cpus"]);
+  ReadNumber(config, "core_operational_cpu", rv.operational_cpu);
+  ReadBool(config, "core_isolate_operational", rv.isolate_operational);
+  ReadBool(config, "core_numa", rv.numa);
+  ReadBool(config, "core_deterministic", rv.deterministic);
+  ReadNumber(config, "core_tickrate", rv.tickrate);
+  if (rv.tickrate == 0) {
+    rv.tickrate = 64;
+  }
+  if (config["core_pacing"] == "busy_spin") {
+    rv.pacing = TickPacer::Mode::kBusySpin;
+  }
+  return rv;
+}
+
+std::vector<ThreadPlacement> PlaceThreads(CoreConfig const& config) {
+  const std::vector<uint32_t> nodes = CpuNumaNodes();
+  auto node_of = [&nodes](uint32_t cpu) {
+    return cpu < nodes.size() ? nodes[cpu] : 0;
+  };
+
+  uint32_t workers =
+      config.worker_threads != 0 ? config.worker_threads : CpuCount();
+  if (config.isolate_operational && config.worker_threads == 0 &&
+      workers > 1) {
+    // leave the CPU to the operational thread
+    workers--;
+  }
+
+  std::vector<uint32_t> cpus = config.worker_cpus;
+  if (cpus.empty() && config.numa) {
+    // deal the workers round-robin over the nodes, so every node gets an
+    // equal share even with fewer workers than CPUs
+    const uint32_t node_count = *std::max_element(nodes.begin(), nodes.end()) + 1;
+    std::vector<std::vector<uint32_t>> by_node(node_count);
+    for (uint32_t cpu = 0; cpu < nodes.size(); cpu++) {
+      by_node[nodes[cpu]].push_back(cpu);
+    }
+    for (size_t i = 0; cpus.size() < nodes.size(); i++) {
+      for (auto const& node_cpus : by_node) {
+        if (i < node_cpus.size()) {
+          cpus.push_back(node_cpus[i]);
+        }
+      }
+    }
+  }
+  if (config.isolate_operational && config.operational_cpu >= 0) {
+    cpus.erase(std::remove(cpus.begin(), cpus.end(),
+                           uint32_t(config.operational_cpu)),
+               cpus.end());
+  }
+
+  std::vector<ThreadPlacement> rv;
+  if (config.isolate_operational) {
+    ThreadPlacement operational;
+    operational.accepts_work = false;
+    rv.push_back(operational);
+  }
+  for (uint32_t i = 0; i < workers; i++) {
+    ThreadPlacement placement;
+    if (!cpus.empty()) {
+      uint32_t cpu = cpus[i % cpus.size()];
+      placement.cpus.push_back(cpu);
+      placement.numa_node = node_of(cpu);
+    }
+    rv.push_back(placement);
+  }
+  if (config.operational_cpu >= 0) {
+    rv[0].cpus = {uint32_t(config.operational_cpu)};
+    rv[0].numa_node = node_of(uint32_t(config.operational_cpu));
+  }
+  return rv;
+}
+}  // namespace engine::core
@@ -0,0 +1,53 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include "TickPacer.h"
+
+namespace engine::core {
+
+class Config;
+
+// Threading and pacing settings of the Core, read from config.json:
+//
+//   "core_worker_threads":   threads updating tickers, 0 = one per CPU
+//   "core_worker_cpus":      CPU list ("0-7,16-23") the workers are pinned
+//                            to, one CPU per worker in order
+//   "core_operational_cpu":  CPU of the operational thread
+//   "core_isolate_operational": if true the operational thread only paces
+//                            ticks and never updates unbound tickers
+//   "core_numa":             group workers by NUMA node, keep stealing and
+//                            rebalancing inside a node when possible
+//   "core_pacing":           "hybrid" or "busy_spin"
+//   "core_tickrate":         pacing intervals per second, also the rate of
+//                            the default tick domain
+//   "core_deterministic":    lockstep mode, see Core::deterministic()
+//
+// Absent or malformed keys keep their defaults.
+struct CoreConfig {
+  uint32_t worker_threads = 0;
+  std::vector<uint32_t> worker_cpus;
+  int32_t operational_cpu = -1;
+  bool isolate_operational = false;
+  bool numa = false;
+  TickPacer::Mode pacing = TickPacer::Mode::kHybrid;
+  uint32_t tickrate = 64;
+  bool deterministic = false;
+
+  [[nodiscard]] static CoreConfig Load(Config const& config);
+};
+
+// Where a single update thread runs.
+struct ThreadPlacement {
+  // empty if the thread is not pinned
+  std::vector<uint32_t> cpus;
+  uint32_t numa_node = 0;
+  // false for an isolated operational thread
+  bool accepts_work = true;
+};
+
+// Computes the placement of every update thread. Index 0 is the
+// operational thread.
+[[nodiscard]] std::vector<ThreadPlacement> PlaceThreads(
+    CoreConfig const& config);
+}  // namespace engine::core
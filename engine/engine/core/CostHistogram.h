@@ -0,0 +1,50 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <vector>
+#include <cstdint>
+
+namespace engine::core {
+
+// Distribution of durations in power-of-two buckets: bucket 0 counts
+// everything below 2 us, bucket i durations in [2^i, 2^(i+1)) us and the
+// last bucket everything longer.
+// Record is wait-free and can be called from any thread.
+class CostHistogram {
+ public:
+  static constexpr size_t kBuckets = 24;
+
+  void Record(int64_t nanoseconds) noexcept {
+    uint64_t us = nanoseconds > 0 ? uint64_t(nanoseconds) / 1000 : 0;
+    size_t bucket = 0;
+    while (us > 1 && bucket + 1 < kBuckets) {
+      us >>= 1;
+      bucket++;
+    }
+    counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void Reset() noexcept {
+    for (auto& count : counts_) {
+      count.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] std::vector<uint64_t> counts() const {
+    std::vector<uint64_t> rv;
+    rv.reserve(kBuckets);
+    for (auto const& count : counts_) {
+      rv.push_back(count.load(std::memory_order_relaxed));
+    }
+    return rv;
+  }
+
+  // Exclusive upper bound of the bucket in nanoseconds.
+  [[nodiscard]] static constexpr int64_t upper_bound(size_t bucket) noexcept {
+    return int64_t(1000) << (bucket + 1);
+  }
+
+ private:
+  std::array<std::atomic<uint64_t>, kBuckets> counts_{};
+};
+}  // namespace engine::core
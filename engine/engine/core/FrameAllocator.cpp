@@ -0,0 +1,37 @@
+#include "FrameAllocator.h"
+
+#include <algorithm>
+
+namespace engine::core {
+
+void FrameAllocator::Reset() {
+  high_water_ = std::max(high_water_, used_);
+  if (blocks_.size() > 1) {
+    size_t total = 0;
+    for (auto const& block : blocks_) {
+      total += block.size;
+    }
+    blocks_.clear();
+    blocks_.push_back({std::make_unique<std::byte[]>(total), total});
+  }
+  offset_ = 0;
+  used_ = 0;
+}
+
+size_t FrameAllocator::capacity() const noexcept {
+  size_t rv = 0;
+  for (auto const& block : blocks_) {
+    rv += block.size;
+  }
+  return rv;
+}
+
+void* FrameAllocator::AllocateSlow(size_t size, size_t alignment) {
+  size_t block_size = blocks_.empty() ? initial_capacity_
+                                      : blocks_.back().size * 2;
+  block_size = std::max(block_size, size + alignment);
+  blocks_.push_back({std::make_unique<std::byte[]>(block_size), block_size});
+  offset_ = 0;
+  return Allocate(size, alignment);
+}
+}  // namespace engine::core
@@ -0,0 +1,131 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
+
+namespace engine::core {
+
+// Linear arena for data which lives for a single tick.
+//
+// Allocation bumps a pointer inside the current block; nothing is freed
+// individually, Reset releases everything at once. Each update thread owns
+// one and resets it at the tick barrier, so tickers can allocate scratch
+// memory without taking the global heap lock. When a tick needed more than
+// one block, Reset replaces them with one block of their combined size, so
+// a steady workload settles on a single allocation.
+//
+// Blocks are allocated on first use by the owning thread and therefore on
+// its NUMA node. Not thread safe.
+class FrameAllocator {
+ public:
+  explicit FrameAllocator(size_t initial_capacity = 64 * 1024)
+      : initial_capacity_(initial_capacity) {}
+  ~FrameAllocator() = default;
+
+  /* Disable copy and move semantics. */
+  FrameAllocator(const FrameAllocator&) = delete;
+  FrameAllocator(FrameAllocator&&) = delete;
+  FrameAllocator& operator=(const FrameAllocator&) = delete;
+  FrameAllocator& operator=(FrameAllocator&&) = delete;
+
+  // alignment must be a power of two
+  [[nodiscard]] void* Allocate(size_t size,
+                               size_t alignment = alignof(std::max_align_t)) {
+    if (!blocks_.empty()) {
+      Block& block = blocks_.back();
+      const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+      const uintptr_t aligned =
+          (base + offset_ + alignment - 1) & ~uintptr_t(alignment - 1);
+      if (aligned + size <= base + block.size) {
+        offset_ = aligned + size - base;
+        used_ += size;
+        return reinterpret_cast<void*>(aligned);
+      }
+    }
+    return AllocateSlow(size, alignment);
+  }
+
+  // Objects are never destroyed, so only trivially destructible types are
+  // allowed.
+  template <typename T, typename... Args>
+  [[nodiscard]] T* New(Args&&... args) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "frame allocated objects are never destroyed");
+    return new (Allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  // Value-initialized array of count elements.
+  template <typename T>
+  [[nodiscard]] T* NewArray(size_t count) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "frame allocated objects are never destroyed");
+    T* rv = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    for (size_t i = 0; i < count; i++) {
+      new (rv + i) T();
+    }
+    return rv;
+  }
+
+  // Invalidates every allocation made since the last reset.
+  void Reset();
+
+  // Bytes handed out since the last reset.
+  [[nodiscard]] size_t used() const noexcept { return used_; }
+  // Most bytes handed out between two resets.
+  [[nodiscard]] size_t high_water() const noexcept { return high_water_; }
+  [[nodiscard]] size_t capacity() const noexcept;
+
+ private:
+  struct Block {
+    std::unique_ptr<std::byte[]> data;
+    size_t size;
+  };
+
+  void* AllocateSlow(size_t size, size_t alignment);
+
+  const size_t initial_capacity_;
+  std::vector<Block> blocks_;
+  // offset in blocks_.back()
+  size_t offset_ = 0;
+  size_t used_ = 0;
+  size_t high_water_ = 0;
+};
+
+// Standard allocator on top of a FrameAllocator, e.g. for a std::vector of
+// per-tick results. deallocate does nothing.
+template <typename T>
+class FrameAllocatorAdapter {
+ public:
+  using value_type = T;
+
+  explicit FrameAllocatorAdapter(FrameAllocator& allocator) noexcept
+      : allocator_(&allocator) {}
+  template <typename U>
+  FrameAllocatorAdapter(FrameAllocatorAdapter<U> const& other) noexcept
+      : allocator_(other.allocator_) {}
+
+  [[nodiscard]] T* allocate(size_t n) {
+    return static_cast<T*>(allocator_->Allocate(sizeof(T) * n, alignof(T)));
+  }
+  void deallocate(T*, size_t) noexcept {}
+
+  template <typename U>
+  bool operator==(FrameAllocatorAdapter<U> const& other) const noexcept {
+    return allocator_ == other.allocator_;
+  }
+  template <typename U>
+  bool operator!=(FrameAllocatorAdapter<U> const& other) const noexcept {
+    return allocator_ != other.allocator_;
+  }
+
+ private:
+  template <typename U>
+  friend class FrameAllocatorAdapter;
+
+  FrameAllocator* allocator_;
+};
+}  // namespace engine::core
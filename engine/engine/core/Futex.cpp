@@ -0,0 +1,65 @@
+#include "Futex.h"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <climits>
+#elif defined(_WIN32)
+#include <Windows.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+namespace engine::core {
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "futex word has to be a plain 32-bit integer");
+
+#if defined(__linux__)
+
+void FutexWait(std::atomic<uint32_t>& word, uint32_t expected) noexcept {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE,
+          expected, nullptr, nullptr, 0);
+}
+
+void FutexWakeAll(std::atomic<uint32_t>& word) noexcept {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE,
+          INT_MAX, nullptr, nullptr, 0);
+}
+
+void FutexWakeOne(std::atomic<uint32_t>& word) noexcept {
+  syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, 1,
+          nullptr, nullptr, 0);
+}
+
+#elif defined(_WIN32)
+
+void FutexWait(std::atomic<uint32_t>& word, uint32_t expected) noexcept {
+  WaitOnAddress(&word, &expected, sizeof(uint32_t), INFINITE);
+}
+
+void FutexWakeAll(std::atomic<uint32_t>& word) noexcept {
+  WakeByAddressAll(&word);
+}
+
+void FutexWakeOne(std::atomic<uint32_t>& word) noexcept {
+  WakeByAddressSingle(&word);
+}
+
+#else
+
+// No address-based wait on this platform, fall back to short sleeps.
+void FutexWait(std::atomic<uint32_t>& word, uint32_t expected) noexcept {
+  if (word.load(std::memory_order_acquire) == expected) {
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+}
+
+void FutexWakeAll(std::atomic<uint32_t>&) noexcept {}
+
+void FutexWakeOne(std::atomic<uint32_t>&) noexcept {}
+
+#endif
+}  // namespace engine::core
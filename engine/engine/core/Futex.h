@@ -0,0 +1,34 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace engine::core {
+
+// Hint to the CPU that we are inside a spin-wait loop.
+inline void CpuRelax() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+  _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield");
+#endif
+}
+
+// Blocks the calling thread while word == expected. May return spuriously,
+// so callers have to recheck their condition in a loop.
+// Uses futex on Linux and WaitOnAddress on Windows.
+void FutexWait(std::atomic<uint32_t>& word, uint32_t expected) noexcept;
+
+// Wakes every thread blocked in FutexWait on this word.
+void FutexWakeAll(std::atomic<uint32_t>& word) noexcept;
+
+// Wakes at most one thread blocked in FutexWait on this word.
+void FutexWakeOne(std::atomic<uint32_t>& word) noexcept;
+}  // namespace engine::core
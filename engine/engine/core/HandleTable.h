@@ -0,0 +1,107 @@
+#pragma once
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+namespace engine::core {
+
+// Index into a HandleTable plus the generation of the slot at the time the
+// handle was issued. Releasing a slot bumps its generation, so handles to
+// removed items are detected instead of silently aliasing a new item.
+struct Handle {
+  static constexpr uint32_t kInvalidIndex =
+      std::numeric_limits<uint32_t>::max();
+
+  uint32_t index = kInvalidIndex;
+  uint32_t generation = 0;
+
+  [[nodiscard]] bool valid() const noexcept { return index != kInvalidIndex; }
+
+  bool operator==(Handle const& other) const noexcept {
+    return index == other.index && generation == other.generation;
+  }
+  bool operator!=(Handle const& other) const noexcept {
+    return !(*this == other);
+  }
+};
+
+// Slot map with generation-checked handles. Released slots are reused in
+// LIFO order. Allocation, lookup and release are O(1).
+template <typename T>
+class HandleTable {
+ public:
+  Handle Allocate(T value) {
+    const Handle handle = Reserve();
+    Emplace(handle, std::move(value));
+    return handle;
+  }
+
+  // Takes a slot for an item stored later with Emplace. Doesn't touch the
+  // stored items, so it may run alongside Get and Contains as long as the
+  // caller serializes it with the other modifications. Every reserved
+  // handle has to be emplaced.
+  Handle Reserve() {
+    if (free_.empty()) {
+      return {next_index_++, 0};
+    }
+    const uint32_t index = free_.back();
+    free_.pop_back();
+    return {index, entries_[index].generation};
+  }
+
+  // Stores the item of a handle returned by Reserve.
+  T* Emplace(Handle handle, T value) {
+    if (handle.index >= entries_.size()) {
+      entries_.resize(handle.index + 1);
+    }
+    Entry& entry = entries_[handle.index];
+    entry.value = std::move(value);
+    entry.alive = true;
+    size_++;
+    return &entry.value;
+  }
+
+  // Does nothing for stale handles.
+  void Release(Handle handle) {
+    if (!Contains(handle)) {
+      return;
+    }
+    Entry& entry = entries_[handle.index];
+    entry.alive = false;
+    entry.generation++;
+    entry.value = T();
+    free_.push_back(handle.index);
+    size_--;
+  }
+
+  [[nodiscard]] bool Contains(Handle handle) const noexcept {
+    return handle.index < entries_.size() &&
+           entries_[handle.index].alive &&
+           entries_[handle.index].generation == handle.generation;
+  }
+
+  // Returns nullptr for stale handles.
+  [[nodiscard]] T* Get(Handle handle) noexcept {
+    return Contains(handle) ? &entries_[handle.index].value : nullptr;
+  }
+  [[nodiscard]] T const* Get(Handle handle) const noexcept {
+    return Contains(handle) ? &entries_[handle.index].value : nullptr;
+  }
+
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+
+ private:
+  struct Entry {
+    T value = T();
+    uint32_t generation = 0;
+    bool alive = false;
+  };
+
+  std::vector<Entry> entries_;
+  std::vector<uint32_t> free_;
+  // first index never handed out, entries_ may still end below it
+  uint32_t next_index_ = 0;
+  size_t size_ = 0;
+};
+}  // namespace engine::core
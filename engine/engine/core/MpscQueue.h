@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+namespace engine::core {
+
+// Unbounded multi-producer single-consumer queue (Vyukov).
+// Push is lock-free but not wait-free: it allocates a node (through the
+// global allocator) and publishes it with one atomic exchange. A batch
+// pushed with PushRange is linked locally and published with a single
+// exchange.
+// Pop must only be called from the consumer thread. An item whose producer
+// is preempted between the exchange and the link is invisible to Pop until
+// the link is written, later items wait behind it.
+template <typename T>
+class MpscQueue {
+ public:
+  MpscQueue() : head_(new Node()) {
+    tail_ = head_.load(std::memory_order_relaxed);
+  }
+
+  ~MpscQueue() {
+    T value;
+    while (Pop(value)) {
+    }
+    delete tail_;
+  }
+
+  /* Disable copy and move semantics. */
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue(MpscQueue&&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+  MpscQueue& operator=(MpscQueue&&) = delete;
+
+  void Push(T value) {
+    Node* node = new Node(std::move(value));
+    Link(node, node);
+  }
+
+  // Pushes [first, last) as one batch, order is preserved.
+  template <typename Iterator>
+  void PushRange(Iterator first, Iterator last) {
+    if (first == last) {
+      return;
+    }
+    Node* front = new Node(*first);
+    Node* back = front;
+    for (++first; first != last; ++first) {
+      Node* node = new Node(*first);
+      back->next.store(node, std::memory_order_relaxed);
+      back = node;
+    }
+    Link(front, back);
+  }
+
+  // Consumer only.
+  [[nodiscard]] bool Pop(T& out) {
+    Node* tail = tail_;
+    Node* next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    out = std::move(next->value);
+    // next becomes the new dummy node
+    tail_ = next;
+    delete tail;
+    return true;
+  }
+
+  // Consumer only.
+  [[nodiscard]] bool Empty() const noexcept {
+    return tail_->next.load(std::memory_order_acquire) == nullptr;
+  }
+
+ private:
+  struct Node {
+    Node() = default;
+    explicit Node(T v) : value(std::move(v)) {}
+
+    std::atomic<Node*> next = nullptr;
+    T value{};
+  };
+
+  void Link(Node* front, Node* back) {
+    Node* prev = head_.exchange(back, std::memory_order_acq_rel);
+    prev->next.store(front, std::memory_order_release);
+  }
+
+  // producers push here
+  alignas(64) std::atomic<Node*> head_;
+  // consumer pops from here, always points to a dummy node
+  alignas(64) Node* tail_;
+};
+}  // namespace engine::core
@@ -0,0 +1,126 @@
+#include "ObjectScene.h"
+
+#include <atomic>
+
+#include "World.h"
+#include "engine/Object.h"
+
+namespace engine::core {
+
+namespace {
+// Runs ObjectScene::Propagate every tick, after the object tickers.
+class ObjectSceneSystem final : public Ticker {
+ public:
+  ObjectSceneSystem(ObjectScene& scene, SystemId system)
+      : Ticker(1), scene_(scene) {
+    SetSystem(system);
+  }
+
+  void Update(const uint64_t /*tick*/) override { scene_.Propagate(); }
+
+ private:
+  ObjectScene& scene_;
+};
+}  // namespace
+
+ObjectScene& ObjectScene::GetInstance() {
+  // never destroyed, like World::Objects()
+  static ObjectScene* scene = new ObjectScene();
+  return *scene;
+}
+
+void ObjectScene::SetParent(Handle child, Handle parent) {
+  StartSystem();
+  World::Objects().Defer([this, child, parent](World& /*world*/) {
+    Attach(child, parent);
+  });
+}
+
+void ObjectScene::Remove(ObjectTransform const& transform) {
+  if (!graph_.Contains(transform.node)) {
+    return;
+  }
+  graph_.DetachChildren(transform.node);
+  owners_[transform.node.index] = Handle();
+  graph_.Destroy(transform.node);
+}
+
+glm::mat4 const* ObjectScene::world_matrix(Handle node) const noexcept {
+  return graph_.Contains(node) && !graph_.dirty(node)
+             ? &graph_.world_matrix(node)
+             : nullptr;
+}
+
+void ObjectScene::Propagate() {
+  World& world = World::Objects();
+  Handle entity;
+  while (changed_.Pop(entity)) {
+    ObjectTransform* transform = world.Get<ObjectTransform>(entity);
+    if (transform == nullptr || !graph_.Contains(transform->node)) {
+      continue;
+    }
+    // cleared first, a change made while copying is reported again
+    std::atomic_ref<bool>(transform->snapshot_pending)
+        .store(false, std::memory_order_relaxed);
+    graph_.SetPosition(transform->node, transform->position);
+    graph_.SetRotation(transform->node, transform->rotation);
+    graph_.SetScale(transform->node, transform->scale);
+  }
+  graph_.UpdateWorldMatrices([this](Handle node) {
+    RenderSnapshot::Objects().MarkChanged(owners_[node.index]);
+  });
+}
+
+void ObjectScene::Attach(Handle child, Handle parent) {
+  World& world = World::Objects();
+  ObjectTransform* child_transform = world.Get<ObjectTransform>(child);
+  if (child_transform == nullptr) {
+    return;
+  }
+  Handle parent_node;
+  if (parent.valid()) {
+    ObjectTransform* parent_transform = world.Get<ObjectTransform>(parent);
+    if (parent_transform == nullptr) {
+      return;
+    }
+    parent_node = NodeOf(parent, *parent_transform);
+  } else if (!graph_.Contains(child_transform->node)) {
+    // a root without a node already
+    return;
+  }
+  graph_.SetParent(NodeOf(child, *child_transform), parent_node);
+}
+
+Handle ObjectScene::NodeOf(Handle entity, ObjectTransform& transform) {
+  if (graph_.Contains(transform.node)) {
+    return transform.node;
+  }
+  transform.node = graph_.Create(Handle(), transform.position,
+                                 transform.rotation, transform.scale);
+  if (transform.node.index >= owners_.size()) {
+    owners_.resize(transform.node.index + 1);
+  }
+  owners_[transform.node.index] = entity;
+  return transform.node;
+}
+
+void ObjectScene::StartSystem() {
+  std::scoped_lock<std::mutex> lock(system_mutex_);
+  if (system_ != nullptr) {
+    return;
+  }
+  SystemDesc desc;
+  desc.name = "objects.scene";
+  // copies the transforms into the graph, so later systems writing them
+  // wait for the propagation; snapshot_pending is only touched atomically
+  desc.reads.push_back(ObjectTransformResource());
+  desc.after.push_back("default");
+  auto core = Core::GetInstance();
+  const SystemId id = core->RegisterSystem(desc);
+  if (id == TaskGraph::kInvalidSystem) {
+    return;
+  }
+  system_ = std::make_shared<ObjectSceneSystem>(*this, id);
+  core->AddTickingObject(system_);
+}
+}  // namespace engine::core
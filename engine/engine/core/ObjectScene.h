@@ -0,0 +1,84 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <mutex>
+#include <memory>
+#include <vector>
+
+#include "HandleTable.h"
+#include "MpscQueue.h"
+#include "SceneGraph.h"
+
+namespace engine::core {
+class Ticker;
+struct ObjectTransform;
+
+// Parent-child relations between the entities of World::Objects(). An
+// entity attached to a parent gets a SceneGraph node, and its
+// ObjectTransform becomes relative to the parent.
+//
+// Attaching and detaching are deferred commands of the world, applied at
+// the tick boundary. The "objects.scene" Core system reads the transform
+// resource (see ObjectTransformResource()) and runs after the default
+// system every tick: it copies the transforms changed during the
+// tick into the graph (Object reports them here instead of to the render
+// snapshot) and recomputes the world matrices of the dirty subtrees on the
+// update threads. Every recomputed node is reported to
+// RenderSnapshot::Objects(), which publishes its world matrix.
+//
+// Destroying an entity with a node detaches its children, which become
+// roots keeping their local transforms. Outside the system only touched at
+// the tick boundary.
+class ObjectScene {
+ public:
+  ObjectScene() = default;
+  ~ObjectScene() = default;
+
+  /* Disable copy and move semantics. */
+  ObjectScene(const ObjectScene&) = delete;
+  ObjectScene(ObjectScene&&) = delete;
+  ObjectScene& operator=(const ObjectScene&) = delete;
+  ObjectScene& operator=(ObjectScene&&) = delete;
+
+  [[nodiscard]] static ObjectScene& GetInstance();
+
+  // Attaches child below parent, or detaches it for an invalid parent, at
+  // the next tick boundary. Ignored if either entity has no ObjectTransform
+  // by then or if parent is below child. Thread safe.
+  void SetParent(Handle child, Handle parent);
+
+  // Records that the transform of an entity with a node changed.
+  // Lock-free (allocates a queue node), can be called from any thread.
+  void MarkChanged(Handle entity) { changed_.Push(entity); }
+
+  // Drops the node of an entity about to be destroyed, detaching its
+  // children. Tick boundary only, e.g. from a deferred command.
+  void Remove(ObjectTransform const& transform);
+
+  // World matrix of the node as of the last run of the system; nullptr for
+  // stale nodes and nodes changed since, which are reported again once
+  // recomputed. Tick boundary only.
+  [[nodiscard]] glm::mat4 const* world_matrix(Handle node) const noexcept;
+
+  // Copies the reported transforms into the graph and recomputes the
+  // world matrices. Run by the system.
+  void Propagate();
+
+ private:
+  // Applies a SetParent at the tick boundary.
+  void Attach(Handle child, Handle parent);
+  // Node of the entity, created as a root if it has none.
+  Handle NodeOf(Handle entity, ObjectTransform& transform);
+  // Registers the system and its ticker on first use.
+  void StartSystem();
+
+  SceneGraph graph_;
+  // entity of every node, by node index
+  std::vector<Handle> owners_;
+  MpscQueue<Handle> changed_;
+
+  std::mutex system_mutex_;
+  // the Core drops the ticker once no one else holds it
+  std::shared_ptr<Ticker> system_;
+};
+}  // namespace engine::core
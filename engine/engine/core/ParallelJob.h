@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include "Futex.h"
+
+namespace engine::core {
+
+// Loop split into chunks which other update threads can claim while it
+// runs. Each update thread owns one and runs at most one loop in it at a
+// time; idle threads of the round call Help on the jobs of the others.
+//
+// A helper announces itself in helpers_ before looking at the loop, and the
+// owner waits for the helpers to leave before it returns, so the loop body
+// and its context never outlive Run.
+class ParallelJob {
+ public:
+  using Body = void (*)(void* context, size_t begin, size_t end);
+
+  ParallelJob() = default;
+  ~ParallelJob() = default;
+
+  /* Disable copy and move semantics. */
+  ParallelJob(const ParallelJob&) = delete;
+  ParallelJob(ParallelJob&&) = delete;
+  ParallelJob& operator=(const ParallelJob&) = delete;
+  ParallelJob& operator=(ParallelJob&&) = delete;
+
+  // Owner only. Calls body(context, begin, end) over [0, count) in chunks
+  // of grain elements and returns once every chunk finished. Returns false
+  // without running anything if a loop is already running, e.g. when
+  // called from one of its own chunks.
+  bool Run(size_t count, size_t grain, Body body, void* context) {
+    if (active_.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    count_ = count;
+    grain_ = std::max<size_t>(grain, 1);
+    body_ = body;
+    context_ = context;
+    next_.store(0, std::memory_order_relaxed);
+    done_.store(0, std::memory_order_relaxed);
+    active_.store(true, std::memory_order_seq_cst);
+
+    RunChunks();
+    // chunks claimed by helpers may still be running
+    uint32_t spins = 0;
+    while (done_.load(std::memory_order_acquire) != count_) {
+      if (++spins < 64) {
+        CpuRelax();
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    active_.store(false, std::memory_order_seq_cst);
+    while (helpers_.load(std::memory_order_seq_cst) != 0) {
+      CpuRelax();
+    }
+    return true;
+  }
+
+  // Any thread but the owner. Runs chunks of the current loop until none
+  // is left, returns true if it ran any.
+  bool Help() {
+    if (!active_.load(std::memory_order_relaxed)) {
+      return false;
+    }
+    helpers_.fetch_add(1, std::memory_order_seq_cst);
+    bool ran = false;
+    if (active_.load(std::memory_order_seq_cst)) {
+      ran = RunChunks();
+    }
+    helpers_.fetch_sub(1, std::memory_order_release);
+    return ran;
+  }
+
+ private:
+  bool RunChunks() {
+    bool ran = false;
+    while (true) {
+      const size_t begin = next_.fetch_add(grain_, std::memory_order_relaxed);
+      if (begin >= count_) {
+        return ran;
+      }
+      const size_t end = std::min(begin + grain_, count_);
+      body_(context_, begin, end);
+      done_.fetch_add(end - begin, std::memory_order_release);
+      ran = true;
+    }
+  }
+
+  // written by the owner while no loop is active, published by active_
+  size_t count_ = 0;
+  size_t grain_ = 1;
+  Body body_ = nullptr;
+  void* context_ = nullptr;
+
+  std::atomic<bool> active_ = false;
+  std::atomic<uint32_t> helpers_ = 0;
+  // first element not claimed yet
+  alignas(64) std::atomic<size_t> next_ = 0;
+  // elements whose chunk finished
+  alignas(64) std::atomic<size_t> done_ = 0;
+};
+}  // namespace engine::core
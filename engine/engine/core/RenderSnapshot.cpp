@@ -0,0 +1,224 @@
+#include "RenderSnapshot.h"
+
+#include <mutex>
+#include <atomic>
+#include <utility>
+#include <algorithm>
+#include <shared_mutex>
+
+#include "World.h"
+#include "ObjectScene.h"
+#include "engine/Object.h"
+#include "engine/Ticker.h"
+
+namespace engine::core {
+
+namespace {
+// Runs RenderSnapshot::Prepare every tick, after the object tickers.
+class RenderSnapshotSystem final : public Ticker {
+ public:
+  RenderSnapshotSystem(RenderSnapshot& snapshot, SystemId system)
+      : Ticker(1), snapshot_(snapshot) {
+    SetSystem(system);
+  }
+
+  void Update(const uint64_t /*tick*/, TickContext& context) override {
+    snapshot_.Prepare(*context.core);
+  }
+
+ private:
+  RenderSnapshot& snapshot_;
+};
+}  // namespace
+
+RenderSnapshot& RenderSnapshot::Objects() {
+  // never destroyed, like World::Objects()
+  static RenderSnapshot* snapshot = new RenderSnapshot();
+  return *snapshot;
+}
+
+void RenderSnapshot::Prepare(Core& core) {
+  World& world = World::Objects();
+  // only against structural changes made directly from other threads,
+  // the deferred ones wait for the tick boundary
+  std::shared_lock<std::shared_mutex> lock(world.mutex());
+  transforms_.Clear();
+  // the store is filled in the order of prepared_, starting at first
+  const size_t first = prepared_.size();
+  Handle entity;
+  while (changed_.Pop(entity)) {
+    ObjectTransform* transform = world.Get<ObjectTransform>(entity);
+    if (transform == nullptr || transform->node.valid()) {
+      deferred_.push_back(entity);
+      continue;
+    }
+    // cleared first, a change made later in the tick is reported again
+    std::atomic_ref<bool>(transform->snapshot_pending)
+        .store(false, std::memory_order_relaxed);
+    prepared_.push_back({entity,
+                         transforms_.Create(transform->position,
+                                            transform->rotation,
+                                            transform->scale),
+                         glm::mat4x3(1.0F)});
+  }
+  // ranges start at multiples of the grain, as UpdateMatrices requires
+  core.ParallelFor(transforms_.size(), TransformStore::kRangeAlignment,
+                   [this, first](size_t begin, size_t end) {
+                     transforms_.UpdateMatrices(begin, end);
+                     for (size_t i = first + begin; i < first + end; i++) {
+                       prepared_[i].matrix = glm::mat4x3(
+                           transforms_.model_matrix(prepared_[i].transform));
+                     }
+                   });
+}
+
+void RenderSnapshot::Publish(uint64_t tick) {
+  std::vector<Change> changes;
+  if (history_.size() == kHistory) {
+    // reuse the memory of the oldest publish
+    changes.swap(history_.front());
+    changes.clear();
+    history_.pop_front();
+  }
+  World& world = World::Objects();
+  // exclusive against structural changes made directly from other
+  // threads; Object only changes the structure through deferred commands,
+  // flushed just before
+  std::unique_lock<std::shared_mutex> lock(world.mutex());
+  transforms_.Clear();
+  // changes whose matrix is filled in once the store built it, and their
+  // transforms there
+  std::vector<std::pair<size_t, Handle>> gathered;
+  // prepared matrices still hold unless the flush destroyed or attached
+  // the entity; reports made after Prepare come later and override them
+  for (Prepared const& prepared : prepared_) {
+    ObjectTransform const* transform =
+        world.Get<ObjectTransform>(prepared.entity);
+    if (transform != nullptr && !transform->node.valid()) {
+      changes.push_back({prepared.entity, true, prepared.matrix});
+    } else {
+      Capture(world, prepared.entity, changes, gathered);
+    }
+  }
+  prepared_.clear();
+  for (Handle entity : deferred_) {
+    Capture(world, entity, changes, gathered);
+  }
+  deferred_.clear();
+  Handle entity;
+  while (changed_.Pop(entity)) {
+    Capture(world, entity, changes, gathered);
+  }
+  transforms_.UpdateMatrices();
+  for (auto const& [change, handle] : gathered) {
+    changes[change].matrix = glm::mat4x3(transforms_.model_matrix(handle));
+  }
+  history_.push_back(std::move(changes));
+  sequence_++;
+
+  Frame& frame = frames_.back();
+  const uint64_t oldest = sequence_ + 1 - history_.size();
+  if (frame.sequence_ + 1 < oldest) {
+    Rebuild(world, frame);
+  } else {
+    for (uint64_t sequence = frame.sequence_ + 1; sequence <= sequence_;
+         sequence++) {
+      Apply(frame, history_[sequence - oldest]);
+    }
+  }
+  frame.sequence_ = sequence_;
+  frame.tick_ = tick;
+  frames_.Publish();
+}
+
+void RenderSnapshot::StartSystem() {
+  if (system_started_.load(std::memory_order_acquire)) {
+    return;
+  }
+  std::scoped_lock<std::mutex> lock(system_mutex_);
+  if (system_started_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  SystemDesc desc;
+  desc.name = "objects.snapshot";
+  desc.reads.push_back(ObjectTransformResource());
+  desc.after.push_back("default");
+  auto core = Core::GetInstance();
+  const SystemId id = core->RegisterSystem(desc);
+  // a taken name isn't retried, Publish handles every change by itself
+  system_started_.store(true, std::memory_order_release);
+  if (id == TaskGraph::kInvalidSystem) {
+    return;
+  }
+  system_ = std::make_shared<RenderSnapshotSystem>(*this, id);
+  core->AddTickingObject(system_);
+}
+
+void RenderSnapshot::Capture(World& world, Handle entity,
+                             std::vector<Change>& changes,
+                             std::vector<std::pair<size_t, Handle>>& gathered) {
+  ObjectTransform* transform = world.Get<ObjectTransform>(entity);
+  if (transform == nullptr) {
+    changes.push_back({entity, false, glm::mat4x3(1.0F)});
+    return;
+  }
+  std::atomic_ref<bool>(transform->snapshot_pending)
+      .store(false, std::memory_order_relaxed);
+  if (transform->node.valid()) {
+    // attached: reported by ObjectScene once its world matrix is rebuilt,
+    // which a structural change in the flush may have undone
+    if (glm::mat4 const* matrix =
+            ObjectScene::GetInstance().world_matrix(transform->node)) {
+      changes.push_back({entity, true, glm::mat4x3(*matrix)});
+    }
+    return;
+  }
+  gathered.emplace_back(changes.size(),
+                        transforms_.Create(transform->position,
+                                           transform->rotation,
+                                           transform->scale));
+  changes.push_back({entity, true, glm::mat4x3(1.0F)});
+}
+
+void RenderSnapshot::Store(Frame& frame, Handle entity,
+                           glm::mat4x3 const& matrix) {
+  if (entity.index >= frame.entities_.size()) {
+    frame.entities_.resize(entity.index + 1);
+    frame.matrices_.resize(entity.index + 1);
+  }
+  frame.entities_[entity.index] = entity;
+  frame.matrices_[entity.index] = matrix;
+}
+
+void RenderSnapshot::Apply(Frame& frame, std::vector<Change> const& changes) {
+  for (Change const& change : changes) {
+    if (change.alive) {
+      Store(frame, change.entity, change.matrix);
+    } else if (change.entity.index < frame.entities_.size() &&
+               frame.entities_[change.entity.index] == change.entity) {
+      // a new entity in the same slot has another generation and stays
+      frame.entities_[change.entity.index] = Handle();
+    }
+  }
+}
+
+void RenderSnapshot::Rebuild(World& world, Frame& frame) {
+  std::fill(frame.entities_.begin(), frame.entities_.end(), Handle());
+  ObjectScene const& scene = ObjectScene::GetInstance();
+  // rare, only for a frame the render thread held for a long time, so the
+  // matrices are built one by one instead of going through the store
+  world.ForEachChunkLocked<const ObjectTransform>(
+      [&scene, &frame](size_t count, Handle const* entities,
+                       ObjectTransform const* transforms) {
+        for (size_t i = 0; i < count; i++) {
+          if (!transforms[i].node.valid()) {
+            Store(frame, entities[i],
+                  glm::mat4x3(transforms[i].model_matrix()));
+          } else if (glm::mat4 const* matrix =
+                         scene.world_matrix(transforms[i].node)) {
+            Store(frame, entities[i], glm::mat4x3(*matrix));
+          }
+        }
+      });
+}
+}  // namespace engine::core
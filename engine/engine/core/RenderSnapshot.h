@@ -0,0 +1,161 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+#include "HandleTable.h"
+#include "MpscQueue.h"
+#include "TripleBuffer.h"
+#include "TransformStore.h"
+
+namespace engine::core {
+class Core;
+class World;
+class Ticker;
+
+// Model matrices of every Object as of the end of a tick, for the render
+// thread.
+//
+// Update threads work on the live transforms of tick N+1 while the render
+// thread reads the immutable frame published for tick N. The Core
+// publishes at the tick barrier, while every update thread is parked:
+// the transforms changed during the tick (reported with MarkChanged) are
+// copied into the writer's frame, which is then swapped in with one atomic
+// exchange (see TripleBuffer). Neither side takes a lock on its hot path.
+//
+// A frame handed back to the writer is brought up to date with the changes
+// of the publishes it missed, so a tick costs O(changed objects). A frame
+// older than the kept history is rebuilt from all transforms.
+//
+// Frames only keep what the renderer consumes, the affine part of every
+// model matrix. The changed transforms are gathered into a scratch
+// TransformStore, whose kernels build their matrices in batches; it is
+// cleared by every publish, so nothing is kept per object besides the
+// frames. Entities attached with ObjectScene publish the world matrix of
+// their node.
+//
+// For Objects() most of that work happens during the tick: the
+// "objects.snapshot" Core system reads the transform resource (see
+// ObjectTransformResource()) and runs Prepare after the default system,
+// building the matrices of the transforms reported so far on the update
+// threads. Publish then only checks those against the flushed world and
+// handles what was reported later, created or destroyed at the boundary,
+// or attached.
+class RenderSnapshot {
+ public:
+  class Frame {
+   public:
+    // tick of the Core the frame was published at
+    [[nodiscard]] uint64_t tick() const noexcept { return tick_; }
+    // Model matrix without its last row, which is always (0, 0, 0, 1).
+    // Returns nullptr if the entity had no transform when the frame was
+    // published.
+    [[nodiscard]] glm::mat4x3 const* model_matrix(
+        Handle entity) const noexcept {
+      return entity.index < entities_.size() &&
+                     entities_[entity.index] == entity
+                 ? &matrices_[entity.index]
+                 : nullptr;
+    }
+
+   private:
+    friend class RenderSnapshot;
+
+    uint64_t tick_ = 0;
+    // last publish whose changes the frame contains
+    uint64_t sequence_ = 0;
+    // by entity index; invalid where no entity is stored
+    std::vector<Handle> entities_;
+    std::vector<glm::mat4x3> matrices_;
+  };
+
+  RenderSnapshot() = default;
+  ~RenderSnapshot() = default;
+
+  /* Disable copy and move semantics. */
+  RenderSnapshot(const RenderSnapshot&) = delete;
+  RenderSnapshot(RenderSnapshot&&) = delete;
+  RenderSnapshot& operator=(const RenderSnapshot&) = delete;
+  RenderSnapshot& operator=(RenderSnapshot&&) = delete;
+
+  // Snapshot of the entities of World::Objects().
+  [[nodiscard]] static RenderSnapshot& Objects();
+
+  // Records that the transform of the entity changed or that the entity
+  // was destroyed. Lock-free (allocates a queue node), can be called from
+  // any thread; Object calls it once per tick at most.
+  void MarkChanged(Handle entity) { changed_.Push(entity); }
+
+  // Builds the matrices of the unattached transforms recorded so far,
+  // spread over the update threads with core.ParallelFor. Run by the
+  // system every tick; must not run concurrently with Publish.
+  void Prepare(Core& core);
+
+  // Captures the recorded changes and publishes a frame for tick. Called
+  // by the Core at the tick barrier.
+  void Publish(uint64_t tick);
+
+  // Registers the system and its ticker, once. Called for Objects() by
+  // every Object. Thread safe.
+  void StartSystem();
+
+  // Render thread only. Takes the latest published frame, which stays
+  // unchanged until the next Acquire.
+  Frame const& Acquire() noexcept { return frames_.Acquire(); }
+  // Render thread only. Frame returned by the last Acquire.
+  [[nodiscard]] Frame const& frame() const noexcept { return frames_.front(); }
+
+ private:
+  // publishes whose changes are kept for frames that missed them
+  static constexpr size_t kHistory = 8;
+
+  struct Change {
+    Handle entity;
+    // false if the entity lost its transform
+    bool alive;
+    glm::mat4x3 matrix;
+  };
+
+  // a change taken by Prepare, its transform in transforms_
+  struct Prepared {
+    Handle entity;
+    Handle transform;
+    glm::mat4x3 matrix;
+  };
+
+  // Adds the change of a recorded entity, the matrix of an unattached one
+  // is filled in once transforms_ built it. world.mutex() held.
+  void Capture(World& world, Handle entity, std::vector<Change>& changes,
+               std::vector<std::pair<size_t, Handle>>& gathered);
+  static void Store(Frame& frame, Handle entity, glm::mat4x3 const& matrix);
+  static void Apply(Frame& frame, std::vector<Change> const& changes);
+  // Rebuilds the frame from every transform, world.mutex() held.
+  static void Rebuild(World& world, Frame& frame);
+
+  MpscQueue<Handle> changed_;
+  TripleBuffer<Frame> frames_;
+  // changes of the last publishes, the newest one at the back
+  std::deque<std::vector<Change>> history_;
+  uint64_t sequence_ = 0;
+
+  // transforms changed since the last Prepare or Publish, scratch of both
+  TransformStore transforms_;
+  // changes taken by Prepare since the last publish
+  std::vector<Prepared> prepared_;
+  // entities taken by Prepare which Publish handles itself, those without
+  // a transform or attached
+  std::vector<Handle> deferred_;
+
+  std::atomic<bool> system_started_ = false;
+  std::mutex system_mutex_;
+  // the Core drops the ticker once no one else holds it
+  std::shared_ptr<Ticker> system_;
+};
+}  // namespace engine::core
@@ -0,0 +1,318 @@
+#include "SceneGraph.h"
+
+#include <algorithm>
+
+#include "engine/Core.h"
+
+namespace engine::core {
+
+namespace {
+// translation * rotation * scale
+glm::mat4 LocalMatrix(glm::vec3 const& position, glm::quat const& rotation,
+                      glm::vec3 const& scale) noexcept {
+  glm::mat4 local = glm::mat4_cast(rotation);
+  local[0] *= scale.x;
+  local[1] *= scale.y;
+  local[2] *= scale.z;
+  local[3] = glm::vec4(position, 1.0F);
+  return local;
+}
+}  // namespace
+
+Handle SceneGraph::Create(Handle parent, glm::vec3 const& position,
+                          glm::quat const& rotation, glm::vec3 const& scale) {
+  uint32_t parent_index = kNone;
+  if (parent.valid()) {
+    if (!slots_.Contains(parent)) {
+      return {};
+    }
+    parent_index = IndexOf(parent);
+  }
+  const auto index = uint32_t(handles_.size());
+  Handle handle = slots_.Allocate(index);
+  handles_.push_back(handle);
+  parents_.push_back(parent_index);
+  subtree_sizes_.push_back(1);
+  locals_.push_back({position, rotation, scale});
+  worlds_.emplace_back(1.0F);
+  dirty_.push_back(0);
+  MarkDirty(index);
+  if (parent_index != kNone && ordered_) {
+    // appending keeps the order if the parent's subtree ends the arrays,
+    // and then so do the subtrees of all its ancestors
+    if (parent_index + subtree_sizes_[parent_index] == index) {
+      for (uint32_t ancestor = parent_index; ancestor != kNone;
+           ancestor = parents_[ancestor]) {
+        subtree_sizes_[ancestor]++;
+      }
+    } else {
+      ordered_ = false;
+    }
+  }
+  return handle;
+}
+
+void SceneGraph::Destroy(Handle handle) {
+  if (!slots_.Contains(handle)) {
+    return;
+  }
+  handles_[IndexOf(handle)] = Handle();
+  slots_.Release(handle);
+  ordered_ = false;
+}
+
+void SceneGraph::DetachChildren(Handle handle) {
+  if (!slots_.Contains(handle)) {
+    return;
+  }
+  const uint32_t index = IndexOf(handle);
+  if (!ordered_) {
+    for (uint32_t i = 0; i < uint32_t(parents_.size()); i++) {
+      if (parents_[i] == index) {
+        Detach(i);
+      }
+    }
+    return;
+  }
+  // the children start the subtrees following the node; detaching breaks
+  // the order but leaves the sizes walked here alone
+  const uint32_t end = index + subtree_sizes_[index];
+  for (uint32_t child = index + 1; child < end;
+       child += subtree_sizes_[child]) {
+    Detach(child);
+  }
+}
+
+bool SceneGraph::SetParent(Handle handle, Handle parent) {
+  if (!slots_.Contains(handle) ||
+      (parent.valid() && !slots_.Contains(parent))) {
+    return false;
+  }
+  const uint32_t index = IndexOf(handle);
+  uint32_t parent_index = kNone;
+  if (parent.valid()) {
+    parent_index = IndexOf(parent);
+    for (uint32_t ancestor = parent_index; ancestor != kNone;
+         ancestor = parents_[ancestor]) {
+      if (ancestor == index) {
+        return false;
+      }
+    }
+  }
+  if (parents_[index] != parent_index) {
+    parents_[index] = parent_index;
+    ordered_ = false;
+    MarkDirty(index);
+  }
+  return true;
+}
+
+void SceneGraph::Detach(uint32_t index) {
+  parents_[index] = kNone;
+  ordered_ = false;
+  MarkDirty(index);
+}
+
+Handle SceneGraph::parent(Handle handle) const noexcept {
+  const uint32_t parent_index = parents_[IndexOf(handle)];
+  return parent_index == kNone ? Handle() : handles_[parent_index];
+}
+
+glm::vec3 SceneGraph::position(Handle handle) const noexcept {
+  return locals_[IndexOf(handle)].position;
+}
+
+glm::quat SceneGraph::rotation(Handle handle) const noexcept {
+  return locals_[IndexOf(handle)].rotation;
+}
+
+glm::vec3 SceneGraph::scale(Handle handle) const noexcept {
+  return locals_[IndexOf(handle)].scale;
+}
+
+glm::mat4 const& SceneGraph::world_matrix(Handle handle) const noexcept {
+  return worlds_[IndexOf(handle)];
+}
+
+bool SceneGraph::dirty(Handle handle) const noexcept {
+  return dirty_[IndexOf(handle)] != 0;
+}
+
+void SceneGraph::SetPosition(Handle handle,
+                             glm::vec3 const& position) noexcept {
+  const uint32_t i = IndexOf(handle);
+  locals_[i].position = position;
+  MarkDirty(i);
+}
+
+void SceneGraph::SetRotation(Handle handle,
+                             glm::quat const& rotation) noexcept {
+  const uint32_t i = IndexOf(handle);
+  locals_[i].rotation = rotation;
+  MarkDirty(i);
+}
+
+void SceneGraph::SetScale(Handle handle, glm::vec3 const& scale) noexcept {
+  const uint32_t i = IndexOf(handle);
+  locals_[i].scale = scale;
+  MarkDirty(i);
+}
+
+void SceneGraph::MarkDirty(uint32_t index) {
+  if (dirty_[index] == 0) {
+    dirty_[index] = 1;
+    dirty_nodes_.push_back(index);
+  }
+}
+
+size_t SceneGraph::UpdateWorldMatrices(
+    std::function<void(Handle)> const& updated) {
+  if (!ordered_) {
+    Rebuild();
+  }
+  if (dirty_nodes_.empty()) {
+    return 0;
+  }
+  // in depth-first order a dirty node inside the range of an earlier one
+  // is part of its subtree
+  std::sort(dirty_nodes_.begin(), dirty_nodes_.end());
+  size_t count = 0;
+  uint32_t end = 0;
+  for (uint32_t index : dirty_nodes_) {
+    dirty_[index] = 0;
+    if (index < end) {
+      continue;
+    }
+    end = index + subtree_sizes_[index];
+    count += end - index;
+    pending_ranges_.emplace_back(index, end);
+  }
+  dirty_nodes_.clear();
+
+  // the root of a big subtree is updated here and the subtrees of its
+  // children become ranges of their own
+  while (!pending_ranges_.empty()) {
+    const Range range = pending_ranges_.back();
+    pending_ranges_.pop_back();
+    if (range.second - range.first <= kSplitSize) {
+      ranges_.push_back(range);
+      continue;
+    }
+    UpdateRange({range.first, range.first + 1}, updated);
+    for (uint32_t child = range.first + 1; child < range.second;
+         child += subtree_sizes_[child]) {
+      pending_ranges_.emplace_back(child, child + subtree_sizes_[child]);
+    }
+  }
+
+  if (count <= kSplitSize) {
+    for (Range range : ranges_) {
+      UpdateRange(range, updated);
+    }
+  } else {
+    auto core = Core::GetInstance();
+    const size_t grain = std::max<size_t>(
+        1, ranges_.size() / (std::max<size_t>(core->thread_count(), 1) * 4));
+    core->ParallelFor(ranges_.size(), grain,
+                      [this, &updated](size_t begin, size_t end) {
+                        for (size_t i = begin; i < end; i++) {
+                          UpdateRange(ranges_[i], updated);
+                        }
+                      });
+  }
+  ranges_.clear();
+  return count;
+}
+
+void SceneGraph::UpdateRange(Range range,
+                             std::function<void(Handle)> const& updated) {
+  for (uint32_t i = range.first; i < range.second; i++) {
+    Local const& local = locals_[i];
+    const glm::mat4 matrix =
+        LocalMatrix(local.position, local.rotation, local.scale);
+    // the parent comes earlier, in this range or already up to date
+    worlds_[i] = parents_[i] == kNone ? matrix : worlds_[parents_[i]] * matrix;
+    if (updated) {
+      updated(handles_[i]);
+    }
+  }
+}
+
+void SceneGraph::Rebuild() {
+  const auto count = uint32_t(handles_.size());
+  // children lists, newest child first so the stack below visits them in
+  // creation order
+  std::vector<uint32_t> first_child(count, kNone);
+  std::vector<uint32_t> next_sibling(count, kNone);
+  for (uint32_t i = 0; i < count; i++) {
+    if (parents_[i] != kNone) {
+      next_sibling[i] = first_child[parents_[i]];
+      first_child[parents_[i]] = i;
+    }
+  }
+
+  std::vector<uint32_t> order;
+  order.reserve(count);
+  std::vector<uint32_t> new_index(count, kNone);
+  // node and whether it is in a destroyed subtree
+  std::vector<std::pair<uint32_t, bool>> stack;
+  for (uint32_t i = count; i-- > 0;) {
+    if (parents_[i] == kNone) {
+      stack.emplace_back(i, false);
+    }
+  }
+  while (!stack.empty()) {
+    auto [index, destroyed] = stack.back();
+    stack.pop_back();
+    destroyed = destroyed || !handles_[index].valid();
+    if (destroyed) {
+      slots_.Release(handles_[index]);
+    } else {
+      new_index[index] = uint32_t(order.size());
+      order.push_back(index);
+    }
+    for (uint32_t child = first_child[index]; child != kNone;
+         child = next_sibling[child]) {
+      stack.emplace_back(child, destroyed);
+    }
+  }
+
+  const auto kept = uint32_t(order.size());
+  std::vector<Handle> handles(kept);
+  std::vector<uint32_t> parents(kept);
+  std::vector<uint32_t> subtree_sizes(kept, 1);
+  std::vector<Local> locals(kept);
+  std::vector<glm::mat4> worlds(kept);
+  std::vector<uint8_t> dirty(kept);
+  for (uint32_t i = 0; i < kept; i++) {
+    const uint32_t old = order[i];
+    handles[i] = handles_[old];
+    parents[i] = parents_[old] == kNone ? kNone : new_index[parents_[old]];
+    locals[i] = locals_[old];
+    worlds[i] = worlds_[old];
+    dirty[i] = dirty_[old];
+    *slots_.Get(handles[i]) = i;
+  }
+  // children come after their parent
+  for (uint32_t i = kept; i-- > 1;) {
+    if (parents[i] != kNone) {
+      subtree_sizes[parents[i]] += subtree_sizes[i];
+    }
+  }
+  handles_.swap(handles);
+  parents_.swap(parents);
+  subtree_sizes_.swap(subtree_sizes);
+  locals_.swap(locals);
+  worlds_.swap(worlds);
+  dirty_.swap(dirty);
+
+  size_t remaining = 0;
+  for (uint32_t index : dirty_nodes_) {
+    if (new_index[index] != kNone) {
+      dirty_nodes_[remaining++] = new_index[index];
+    }
+  }
+  dirty_nodes_.resize(remaining);
+  ordered_ = true;
+}
+}  // namespace engine::core
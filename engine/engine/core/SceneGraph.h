@@ -0,0 +1,128 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <functional>
+
+#include "HandleTable.h"
+
+namespace engine::core {
+
+// Parent-child transform hierarchy.
+//
+// Nodes live in flat arrays in depth-first order: a parent always comes
+// before its children and every subtree is one contiguous range. Setting a
+// local transform marks the node dirty; UpdateWorldMatrices recomputes
+// world = parent world * local for the dirty subtrees only, spreading
+// independent subtrees over the update threads with Core::ParallelFor.
+// Moving a vehicle with 500 attached parts touches those 501 nodes and
+// nothing else.
+//
+// Creating a root, or a child of the subtree at the end of the arrays,
+// keeps the order. Other attachments, SetParent and Destroy only record the
+// change and the next UpdateWorldMatrices rebuilds the order in O(n). Not
+// thread safe.
+class SceneGraph {
+ public:
+  SceneGraph() = default;
+  ~SceneGraph() = default;
+
+  /* Disable copy and move semantics. */
+  SceneGraph(const SceneGraph&) = delete;
+  SceneGraph(SceneGraph&&) = delete;
+  SceneGraph& operator=(const SceneGraph&) = delete;
+  SceneGraph& operator=(SceneGraph&&) = delete;
+
+  // Creates a node below parent, or a root for an invalid parent handle.
+  // Returns an invalid handle if parent is stale.
+  Handle Create(Handle parent = Handle(),
+                glm::vec3 const& position = glm::vec3(0.0F),
+                glm::quat const& rotation = glm::quat(1.0F, 0.0F, 0.0F, 0.0F),
+                glm::vec3 const& scale = glm::vec3(1.0F));
+  // Destroys the node now and the nodes still attached below it on the
+  // next UpdateWorldMatrices. Does nothing for stale handles.
+  void Destroy(Handle handle);
+  // Makes the children of the node roots, keeping their local transforms.
+  // Does nothing for stale handles.
+  void DetachChildren(Handle handle);
+  // Attaches the node below parent, or makes it a root for an invalid
+  // parent handle. The local transform is kept. Returns false for stale
+  // handles and if parent is the node itself or one of its descendants.
+  bool SetParent(Handle handle, Handle parent);
+
+  [[nodiscard]] bool Contains(Handle handle) const noexcept {
+    return slots_.Contains(handle);
+  }
+  [[nodiscard]] size_t size() const noexcept { return slots_.size(); }
+
+  // The handle has to be valid for the accessors and setters below.
+  // Invalid handle for roots.
+  [[nodiscard]] Handle parent(Handle handle) const noexcept;
+  // Local transform, relative to the parent.
+  [[nodiscard]] glm::vec3 position(Handle handle) const noexcept;
+  [[nodiscard]] glm::quat rotation(Handle handle) const noexcept;
+  [[nodiscard]] glm::vec3 scale(Handle handle) const noexcept;
+  // World matrix as of the last UpdateWorldMatrices.
+  [[nodiscard]] glm::mat4 const& world_matrix(Handle handle) const noexcept;
+  [[nodiscard]] bool dirty(Handle handle) const noexcept;
+
+  void SetPosition(Handle handle, glm::vec3 const& position) noexcept;
+  // rotation should be normalized
+  void SetRotation(Handle handle, glm::quat const& rotation) noexcept;
+  void SetScale(Handle handle, glm::vec3 const& scale) noexcept;
+
+  // Applies pending structural changes and recomputes the world matrices
+  // of the dirty nodes and everything below them. Returns the number of
+  // nodes recomputed. updated, if set, is called with the handle of every
+  // recomputed node, concurrently from the update threads for big updates.
+  size_t UpdateWorldMatrices(
+      std::function<void(Handle)> const& updated = nullptr);
+
+ private:
+  static constexpr uint32_t kNone = Handle::kInvalidIndex;
+  // subtrees larger than this are split into the subtrees of their
+  // children, so one big hierarchy still spreads over the threads
+  static constexpr uint32_t kSplitSize = 1024;
+
+  struct Local {
+    glm::vec3 position;
+    glm::quat rotation;
+    glm::vec3 scale;
+  };
+  // dense indices [first, last) of a subtree
+  using Range = std::pair<uint32_t, uint32_t>;
+
+  [[nodiscard]] uint32_t IndexOf(Handle handle) const noexcept {
+    return *slots_.Get(handle);
+  }
+  void MarkDirty(uint32_t index);
+  void Detach(uint32_t index);
+  // Restores depth-first order and drops the destroyed subtrees.
+  void Rebuild();
+  // Recomputes the world matrices of the nodes of the range in order.
+  void UpdateRange(Range range, std::function<void(Handle)> const& updated);
+
+  HandleTable<uint32_t> slots_;
+  // per node, by dense index; destroyed nodes keep an invalid handle until
+  // the next Rebuild
+  std::vector<Handle> handles_;
+  std::vector<uint32_t> parents_;
+  // nodes in the subtree, the node included; only valid while ordered_
+  std::vector<uint32_t> subtree_sizes_;
+  std::vector<Local> locals_;
+  std::vector<glm::mat4> worlds_;
+  std::vector<uint8_t> dirty_;
+
+  // dense indices of the nodes marked dirty since the last update
+  std::vector<uint32_t> dirty_nodes_;
+  // dirty subtrees being split, and the ranges handed to the threads
+  std::vector<Range> pending_ranges_;
+  std::vector<Range> ranges_;
+  // false once a change broke depth-first order
+  bool ordered_ = true;
+};
+}  // namespace engine::core
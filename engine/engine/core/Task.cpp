@@ -0,0 +1,60 @@
+#include "Task.h"
+
+#include "TaskScheduler.h"
+
+namespace engine::core {
+
+TaskScheduler* CurrentTaskScheduler() noexcept {
+  return TaskScheduler::Current();
+}
+
+void WakeTask(TaskScheduler* scheduler, std::coroutine_handle<> handle) {
+  if (scheduler == nullptr) {
+    // awaited outside the update threads, there is no tick to wait for
+    handle.resume();
+    return;
+  }
+  scheduler->Wake(handle);
+}
+
+std::coroutine_handle<> Task::FinalAwaiter::await_suspend(
+    Handle handle) noexcept {
+  promise_type& promise = handle.promise();
+  if (promise.pending != nullptr) {
+    if (promise.pending->fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      return promise.continuation;
+    }
+    return std::noop_coroutine();
+  }
+  if (promise.continuation) {
+    return promise.continuation;
+  }
+  if (promise.scheduler != nullptr) {
+    // the frame is suspended, so it can be destroyed from here
+    promise.scheduler->Finish(handle);
+  }
+  return std::noop_coroutine();
+}
+
+void Ticks::await_suspend(std::coroutine_handle<> handle) const {
+  TaskScheduler* scheduler = TaskScheduler::Current();
+  if (scheduler == nullptr) {
+    // nothing would ever resume the task
+    std::terminate();
+  }
+  scheduler->Sleep(handle, count);
+}
+
+bool WhenAll::await_suspend(std::coroutine_handle<> handle) {
+  pending_.store(uint32_t(tasks_.size()) + 1, std::memory_order_relaxed);
+  for (Task& task : tasks_) {
+    Task::promise_type& promise = task.handle_.promise();
+    promise.pending = &pending_;
+    promise.continuation = handle;
+    // runs until the task suspends or finishes
+    task.handle_.resume();
+  }
+  // every task finished already, continue without suspending
+  return pending_.fetch_sub(1, std::memory_order_acq_rel) != 1;
+}
+}  // namespace engine::core
@@ -0,0 +1,230 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <optional>
+#include <coroutine>
+#include <exception>
+#include <type_traits>
+
+namespace engine::core {
+
+class TaskScheduler;
+
+// Coroutine resumed by the Core. A Task starts suspended: hand it to
+// Core::Spawn to run it on the update threads, or co_await it from another
+// task to run it as a subroutine. A suspended task costs nothing, it is
+// only resumed once the ticks, tasks or result it awaits are there:
+//
+//   Task Patrol(std::shared_ptr<Guard> guard) {
+//     while (guard->alive()) {
+//       guard->Walk();
+//       co_await ticks(64);
+//     }
+//   }
+//
+// Tasks run on any update thread, so whatever they touch follows the same
+// rules as Ticker::Update. An exception escaping a task terminates.
+class Task {
+ public:
+  struct promise_type;
+  using Handle = std::coroutine_handle<promise_type>;
+
+  struct FinalAwaiter {
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(Handle handle) noexcept;
+    void await_resume() const noexcept {}
+  };
+
+  struct promise_type {
+    Task get_return_object() noexcept {
+      return Task(Handle::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+
+    // resumed once the task finished, set when the task is awaited
+    std::coroutine_handle<> continuation;
+    // tasks of one when_all, the last one to finish resumes continuation
+    std::atomic<uint32_t>* pending = nullptr;
+    // set for spawned tasks, which the scheduler frees once finished
+    TaskScheduler* scheduler = nullptr;
+  };
+
+  Task() = default;
+  explicit Task(Handle handle) noexcept : handle_(handle) {}
+  ~Task() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  /* Disable copy semantics. */
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      if (handle_) {
+        handle_.destroy();
+      }
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+
+  [[nodiscard]] bool done() const noexcept { return !handle_ || handle_.done(); }
+
+  // Runs the task until it finishes, then resumes the awaiting one.
+  auto operator co_await() && noexcept {
+    struct Awaiter {
+      Handle handle;
+
+      [[nodiscard]] bool await_ready() const noexcept {
+        return !handle || handle.done();
+      }
+      std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<> awaiting) const noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+      void await_resume() const noexcept {}
+    };
+    return Awaiter{handle_};
+  }
+
+ private:
+  friend class TaskScheduler;
+  friend class WhenAll;
+
+  Handle handle_;
+};
+
+// Suspends the task for count ticks of the default tick domain. Awaiting
+// ticks(0) doesn't suspend. Only tasks run by a TaskScheduler can wait for
+// ticks, awaiting a nonzero count anywhere else terminates.
+struct Ticks {
+  uint64_t count;
+
+  [[nodiscard]] bool await_ready() const noexcept { return count == 0; }
+  void await_suspend(std::coroutine_handle<> handle) const;
+  void await_resume() const noexcept {}
+};
+
+[[nodiscard]] constexpr Ticks ticks(uint64_t count) noexcept {
+  return Ticks{count};
+}
+
+// co_await next_tick resumes the task on the next tick.
+inline constexpr Ticks next_tick{1};
+
+// Starts every task at once and resumes the awaiting task when the last
+// one has finished. Created with when_all.
+class WhenAll {
+ public:
+  explicit WhenAll(std::vector<Task> tasks) noexcept
+      : tasks_(std::move(tasks)) {}
+
+  [[nodiscard]] bool await_ready() const noexcept { return tasks_.empty(); }
+  bool await_suspend(std::coroutine_handle<> handle);
+  void await_resume() const noexcept {}
+
+ private:
+  std::vector<Task> tasks_;
+  // unfinished tasks plus one held while they are started
+  std::atomic<uint32_t> pending_ = 0;
+};
+
+template <typename... Tasks,
+          typename = std::enable_if_t<
+              (std::is_same_v<std::remove_cvref_t<Tasks>, Task> && ...)>>
+[[nodiscard]] WhenAll when_all(Tasks&&... tasks) {
+  std::vector<Task> all;
+  all.reserve(sizeof...(tasks));
+  (all.push_back(std::forward<Tasks>(tasks)), ...);
+  return WhenAll(std::move(all));
+}
+
+[[nodiscard]] inline WhenAll when_all(std::vector<Task> tasks) {
+  return WhenAll(std::move(tasks));
+}
+
+// Queues a suspended task to be resumed on the next tick, any thread.
+// Without a scheduler the task is resumed right away on the calling
+// thread.
+void WakeTask(TaskScheduler* scheduler, std::coroutine_handle<> handle);
+
+// Result of an operation finished outside the update threads, e.g. by an
+// I/O thread. The awaiting task is resumed on the tick after Complete; if
+// the result is already there co_await doesn't suspend. Copies share the
+// result, only one task may await it. A coroutine awaiting it outside the
+// update threads (TaskScheduler::Current() is nullptr) is resumed by
+// Complete on the completing thread instead.
+//
+//   AsyncResult<std::vector<char>> data;
+//   loader.Read(path, [data](std::vector<char> bytes) mutable {
+//     data.Complete(std::move(bytes));
+//   });
+//   std::vector<char> bytes = co_await data;
+template <typename T>
+class AsyncResult {
+ public:
+  AsyncResult() : state_(std::make_shared<State>()) {}
+
+  // Can be called from any thread, only the first call has an effect.
+  void Complete(T value) {
+    State& state = *state_;
+    if (state.completing.exchange(true, std::memory_order_acq_rel)) {
+      return;
+    }
+    state.value.emplace(std::move(value));
+    void* waiter = state.waiter.exchange(Done(), std::memory_order_acq_rel);
+    if (waiter != nullptr) {
+      WakeTask(state.scheduler, std::coroutine_handle<>::from_address(waiter));
+    }
+  }
+
+  [[nodiscard]] bool ready() const noexcept {
+    return state_->waiter.load(std::memory_order_acquire) == Done();
+  }
+
+  [[nodiscard]] bool await_ready() const noexcept { return ready(); }
+  bool await_suspend(std::coroutine_handle<> handle) noexcept;
+  T await_resume() { return std::move(*state_->value); }
+
+ private:
+  struct State {
+    // nullptr, the awaiting coroutine or Done()
+    std::atomic<void*> waiter = nullptr;
+    std::atomic<bool> completing = false;
+    std::optional<T> value;
+    TaskScheduler* scheduler = nullptr;
+  };
+
+  static void* Done() noexcept {
+    static char done;
+    return &done;
+  }
+
+  std::shared_ptr<State> state_;
+};
+
+// Scheduler of the task running on this thread.
+[[nodiscard]] TaskScheduler* CurrentTaskScheduler() noexcept;
+
+template <typename T>
+bool AsyncResult<T>::await_suspend(std::coroutine_handle<> handle) noexcept {
+  // published by the exchange below, Complete reads it after its exchange
+  state_->scheduler = CurrentTaskScheduler();
+  void* expected = nullptr;
+  // fails if the result arrived in the meantime, the task continues
+  return state_->waiter.compare_exchange_strong(expected, handle.address(),
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_acquire);
+}
+}  // namespace engine::core
@@ -0,0 +1,148 @@
+#include "TaskGraph.h"
+
+#include <algorithm>
+
+#include "Futex.h"
+
+namespace engine::core {
+
+TaskGraph::TaskGraph(SystemDesc default_system) {
+  default_system.name = "default";
+  default_system.after.clear();
+  Register(default_system);
+}
+
+TaskGraph::TaskGraph(TaskGraph const& other) : nodes_(other.nodes_) {}
+
+TaskGraph& TaskGraph::operator=(TaskGraph const& other) {
+  if (this != &other) {
+    nodes_ = other.nodes_;
+  }
+  return *this;
+}
+
+SystemId TaskGraph::Register(SystemDesc const& desc) {
+  if (Find(desc.name) != kInvalidSystem) {
+    return kInvalidSystem;
+  }
+  const auto id = SystemId(nodes_.size());
+
+  std::vector<SystemId> dependencies;
+  for (auto const& name : desc.after) {
+    SystemId dependency = Find(name);
+    if (dependency == kInvalidSystem) {
+      return kInvalidSystem;
+    }
+    dependencies.push_back(dependency);
+  }
+  for (SystemId i = 0; i < id; i++) {
+    if (Conflicts(nodes_[i].desc, desc)) {
+      dependencies.push_back(i);
+    }
+  }
+  std::sort(dependencies.begin(), dependencies.end());
+  dependencies.erase(std::unique(dependencies.begin(), dependencies.end()),
+                     dependencies.end());
+
+  for (SystemId dependency : dependencies) {
+    nodes_[dependency].dependents.push_back(id);
+  }
+  Node node;
+  node.desc = desc;
+  node.dependency_count = uint32_t(dependencies.size());
+  nodes_.push_back(std::move(node));
+  return id;
+}
+
+SystemId TaskGraph::Find(std::string_view name) const noexcept {
+  for (size_t i = 0; i < nodes_.size(); i++) {
+    if (nodes_[i].desc.name == name) {
+      return SystemId(i);
+    }
+  }
+  return kInvalidSystem;
+}
+
+void TaskGraph::Reset(uint32_t contributors) {
+  if (runtime_size_ != nodes_.size()) {
+    runtime_ = std::make_unique<Runtime[]>(nodes_.size());
+    runtime_size_ = nodes_.size();
+  }
+  for (size_t i = 0; i < nodes_.size(); i++) {
+    // every contributor holds one unit until it pushed its share, a system
+    // that waits for others holds one more until it becomes runnable
+    runtime_[i].pending.store(
+        contributors + (nodes_[i].dependency_count != 0 ? 1 : 0),
+        std::memory_order_relaxed);
+    runtime_[i].dependencies_left.store(nodes_[i].dependency_count,
+                                        std::memory_order_relaxed);
+    runtime_[i].runnable.store(nodes_[i].dependency_count == 0,
+                               std::memory_order_relaxed);
+  }
+  systems_left_.store(nodes_.size(), std::memory_order_relaxed);
+  epoch_.fetch_add(1, std::memory_order_release);
+}
+
+void TaskGraph::Contribute(SystemId id, int64_t count) {
+  if (count != 0) {
+    runtime_[id].pending.fetch_add(count, std::memory_order_relaxed);
+  }
+}
+
+void TaskGraph::CompleteWork(SystemId id, int64_t count) {
+  if (runtime_[id].pending.fetch_sub(count, std::memory_order_acq_rel) ==
+      count) {
+    Finish(id);
+  }
+}
+
+void TaskGraph::Finish(SystemId id) {
+  bool released = false;
+  for (SystemId dependent : nodes_[id].dependents) {
+    if (runtime_[dependent].dependencies_left.fetch_sub(
+            1, std::memory_order_acq_rel) == 1) {
+      runtime_[dependent].runnable.store(true, std::memory_order_release);
+      released = true;
+      CompleteWork(dependent, 1);
+    }
+  }
+  // the last system also wakes the threads waiting for more work
+  const bool last = systems_left_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  if (released || last) {
+    Notify();
+  }
+}
+
+void TaskGraph::Notify() noexcept {
+  epoch_.fetch_add(1, std::memory_order_seq_cst);
+  if (epoch_waiters_.load(std::memory_order_seq_cst) != 0) {
+    FutexWakeAll(epoch_);
+  }
+}
+
+void TaskGraph::WaitForEpoch(uint32_t epoch) noexcept {
+  epoch_waiters_.fetch_add(1, std::memory_order_seq_cst);
+  if (epoch_.load(std::memory_order_seq_cst) == epoch) {
+    FutexWait(epoch_, epoch);
+  }
+  epoch_waiters_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool TaskGraph::Conflicts(SystemDesc const& a, SystemDesc const& b) noexcept {
+  auto contains = [](std::vector<std::string> const& v,
+                     std::string const& value) {
+    return std::find(v.begin(), v.end(), value) != v.end();
+  };
+  for (auto const& resource : a.writes) {
+    if (contains(b.writes, resource) || contains(b.reads, resource)) {
+      return true;
+    }
+  }
+  for (auto const& resource : a.reads) {
+    if (contains(b.writes, resource)) {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace engine::core
@@ -0,0 +1,135 @@
+#pragma once
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+namespace engine::core {
+
+using SystemId = uint32_t;
+
+// Describes a named group of tickers and the shared state they touch.
+// Resources are plain names, e.g. "transforms" or "physics_world".
+struct SystemDesc {
+  std::string name;
+  // resources the system only reads
+  std::vector<std::string> reads;
+  // resources the system modifies
+  std::vector<std::string> writes;
+  // systems that have to finish before this one starts
+  std::vector<std::string> after;
+};
+
+// Dependency graph between systems, executed once per tick.
+//
+// A system depends on every earlier registered system it conflicts with
+// (both write the same resource, or one reads what the other writes) and on
+// every system listed in SystemDesc::after. Dependencies can only point to
+// already registered systems, so the graph is acyclic by construction.
+//
+// Each tick every contributing thread reports its share of work for a
+// system once the system is runnable, and reports completion of the tickers
+// it updated. A contributor without work in a system may report it as done
+// right away, even before the system is runnable. A system is finished when
+// it is runnable, all contributors have reported and all its work is
+// complete; this makes its dependents runnable.
+class TaskGraph {
+ public:
+  static constexpr SystemId kDefaultSystem = 0;
+  static constexpr SystemId kInvalidSystem =
+      std::numeric_limits<SystemId>::max();
+
+  // default_system describes the system of the tickers which don't pick
+  // one; its name is always "default" and it runs after nothing.
+  explicit TaskGraph(SystemDesc default_system = {});
+  TaskGraph(TaskGraph const& other);
+  TaskGraph& operator=(TaskGraph const& other);
+  TaskGraph(TaskGraph&&) = delete;
+  TaskGraph& operator=(TaskGraph&&) = delete;
+  ~TaskGraph() = default;
+
+  // Returns the id of the new system, or kInvalidSystem if the name is
+  // already taken or one of the systems in desc.after doesn't exist.
+  SystemId Register(SystemDesc const& desc);
+
+  [[nodiscard]] SystemId Find(std::string_view name) const noexcept;
+
+  [[nodiscard]] size_t size() const noexcept { return nodes_.size(); }
+
+  [[nodiscard]] std::string_view name(SystemId id) const noexcept {
+    return nodes_[id].desc.name;
+  }
+
+  [[nodiscard]] std::vector<SystemId> const& dependents(
+      SystemId id) const noexcept {
+    return nodes_[id].dependents;
+  }
+
+  // Prepares the next run. Should be called while no thread executes the
+  // graph.
+  void Reset(uint32_t contributors);
+
+  // Incremented each time any system becomes runnable (and by Notify), so
+  // that threads only rescan the systems when something changed.
+  [[nodiscard]] uint32_t epoch() const noexcept {
+    return epoch_.load(std::memory_order_acquire);
+  }
+
+  // Blocks while the epoch is still the given one. May return spuriously.
+  void WaitForEpoch(uint32_t epoch) noexcept;
+  // Bumps the epoch and wakes the threads in WaitForEpoch. Done whenever a
+  // system becomes runnable and once the last one finished; callers use it
+  // for other work they want idle threads to look at.
+  void Notify() noexcept;
+
+  [[nodiscard]] bool runnable(SystemId id) const noexcept {
+    return runtime_[id].runnable.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] bool finished() const noexcept {
+    return systems_left_.load(std::memory_order_acquire) == 0;
+  }
+
+  // Called once per contributor and runnable system, before the work is
+  // made available to other threads. Counts the contributor as finished
+  // with its own share if count is zero.
+  void Contribute(SystemId id, int64_t count);
+
+  // Called once the contributor pushed its whole share, or at any time if
+  // it has nothing to contribute.
+  void ContributionDone(SystemId id) { CompleteWork(id, 1); }
+
+  // Called after count tickers of this system were updated.
+  void CompleteWork(SystemId id, int64_t count = 1);
+
+ private:
+  struct Node {
+    SystemDesc desc;
+    std::vector<SystemId> dependents;
+    uint32_t dependency_count = 0;
+  };
+
+  struct alignas(64) Runtime {
+    std::atomic<int64_t> pending = 0;
+    std::atomic<uint32_t> dependencies_left = 0;
+    std::atomic<bool> runnable = false;
+  };
+
+  [[nodiscard]] static bool Conflicts(SystemDesc const& a,
+                                      SystemDesc const& b) noexcept;
+
+  void Finish(SystemId id);
+
+  std::vector<Node> nodes_;
+
+  std::unique_ptr<Runtime[]> runtime_;
+  size_t runtime_size_ = 0;
+  std::atomic<size_t> systems_left_ = 0;
+  std::atomic<uint32_t> epoch_ = 0;
+  // threads blocked in WaitForEpoch
+  std::atomic<uint32_t> epoch_waiters_ = 0;
+};
+}  // namespace engine::core
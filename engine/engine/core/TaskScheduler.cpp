@@ -0,0 +1,127 @@
+#include "TaskScheduler.h"
+
+#include <algorithm>
+
+namespace engine::core {
+
+namespace {
+// scheduler and thread of the task resumed by this thread
+thread_local TaskScheduler* current_scheduler = nullptr;
+thread_local size_t current_thread = 0;
+}  // namespace
+
+TaskScheduler::TaskScheduler(size_t threads)
+    : threads_(threads), locals_(std::make_unique<Local[]>(threads)) {}
+
+TaskScheduler::~TaskScheduler() {
+  // tasks awaited by a spawned task are owned by its frame and destroyed
+  // with it
+  for (void* address : spawned_) {
+    std::coroutine_handle<>::from_address(address).destroy();
+  }
+}
+
+TaskScheduler* TaskScheduler::Current() noexcept { return current_scheduler; }
+
+void TaskScheduler::Spawn(Task task) {
+  Task::Handle handle = std::exchange(task.handle_, {});
+  if (!handle) {
+    return;
+  }
+  handle.promise().scheduler = this;
+  {
+    std::scoped_lock<std::mutex> lock(spawned_mutex_);
+    spawned_.insert(handle.address());
+  }
+  if (current_scheduler == this) {
+    // spawned by a task, keeps the order stable
+    Sleep(handle, 1);
+  } else {
+    Wake(handle);
+  }
+}
+
+void TaskScheduler::Wake(std::coroutine_handle<> handle) {
+  woken_.Push(handle);
+}
+
+void TaskScheduler::Sleep(std::coroutine_handle<> handle, uint64_t ticks) {
+  locals_[current_thread].sleeping.push_back({tick_ + ticks, 0, handle});
+}
+
+void TaskScheduler::Finish(std::coroutine_handle<> handle) {
+  {
+    std::scoped_lock<std::mutex> lock(spawned_mutex_);
+    spawned_.erase(handle.address());
+  }
+  handle.destroy();
+}
+
+size_t TaskScheduler::size() const {
+  std::scoped_lock<std::mutex> lock(spawned_mutex_);
+  return spawned_.size();
+}
+
+void TaskScheduler::Push(Sleeper sleeper) {
+  sleeper.sequence = sequence_++;
+  heap_.push_back(sleeper);
+  std::push_heap(heap_.begin(), heap_.end(), Later);
+}
+
+bool TaskScheduler::Later(Sleeper const& a, Sleeper const& b) noexcept {
+  return a.due != b.due ? a.due > b.due : a.sequence > b.sequence;
+}
+
+void TaskScheduler::BeginRound(uint64_t tick, bool stepped) {
+  due_.clear();
+  next_due_.store(0, std::memory_order_relaxed);
+  for (size_t i = 0; i < threads_; i++) {
+    for (Sleeper const& sleeper : locals_[i].sleeping) {
+      Push(sleeper);
+    }
+    locals_[i].sleeping.clear();
+  }
+  if (!stepped) {
+    return;
+  }
+  tick_ = tick;
+  std::coroutine_handle<> handle;
+  while (woken_.Pop(handle)) {
+    Push({tick, 0, handle});
+  }
+  while (!heap_.empty() && heap_.front().due <= tick) {
+    due_.push_back(heap_.front().handle);
+    std::pop_heap(heap_.begin(), heap_.end(), Later);
+    heap_.pop_back();
+  }
+}
+
+void TaskScheduler::RunDue(size_t thread_index, bool partitioned) {
+  const size_t count = due_.size();
+  if (count == 0) {
+    return;
+  }
+  current_scheduler = this;
+  current_thread = thread_index;
+  if (partitioned) {
+    const size_t first = count * thread_index / threads_;
+    const size_t last = count * (thread_index + 1) / threads_;
+    for (size_t i = first; i < last; i++) {
+      due_[i].resume();
+    }
+  } else {
+    while (true) {
+      const size_t first =
+          next_due_.fetch_add(kChunk, std::memory_order_relaxed);
+      if (first >= count) {
+        break;
+      }
+      const size_t last = std::min(first + kChunk, count);
+      for (size_t i = first; i < last; i++) {
+        due_[i].resume();
+      }
+    }
+  }
+  current_scheduler = nullptr;
+}
+}  // namespace engine::core
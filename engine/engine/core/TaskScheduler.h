@@ -0,0 +1,105 @@
+#pragma once
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <coroutine>
+#include <unordered_set>
+
+#include "MpscQueue.h"
+#include "Task.h"
+
+namespace engine::core {
+
+// Runs the tasks of the Core on the update threads.
+//
+// Sleeping tasks are kept in a min-heap ordered by the tick they are due
+// on, so a tick only touches the tasks due on it; tasks which sleep most of
+// the time cost nothing per tick. At the start of every tick the
+// operational thread moves the due tasks into one list which the update
+// threads then resume in chunks.
+//
+// A task suspending on an update thread queues itself in a buffer of that
+// thread, the buffers are merged into the heap between ticks in thread
+// order. Tasks spawned or woken from elsewhere go through an MPSC queue.
+class TaskScheduler {
+ public:
+  explicit TaskScheduler(size_t threads);
+  // Destroys spawned tasks which haven't finished.
+  ~TaskScheduler();
+
+  /* Disable copy and move semantics. */
+  TaskScheduler(const TaskScheduler&) = delete;
+  TaskScheduler(TaskScheduler&&) = delete;
+  TaskScheduler& operator=(const TaskScheduler&) = delete;
+  TaskScheduler& operator=(TaskScheduler&&) = delete;
+
+  // Takes ownership of the task, it first runs on the next tick.
+  // Can be called from any thread.
+  void Spawn(Task task);
+
+  // Queues a suspended task to be resumed on the next tick.
+  // Can be called from any thread.
+  void Wake(std::coroutine_handle<> handle);
+
+  // Suspends the running task for the given number of ticks. Must be
+  // called from a task resumed by this scheduler.
+  void Sleep(std::coroutine_handle<> handle, uint64_t ticks);
+
+  // Frees a finished spawned task.
+  void Finish(std::coroutine_handle<> handle);
+
+  // Called by the operational thread while every other update thread is
+  // parked. Merges the tasks suspended since the last round and, if the
+  // tick stepped, collects those due on it.
+  void BeginRound(uint64_t tick, bool stepped);
+
+  // Resumes this thread's share of the due tasks. With partitioned each
+  // thread takes a fixed slice of the list instead of claiming chunks, so
+  // the same task runs on the same thread in every run.
+  void RunDue(size_t thread_index, bool partitioned);
+
+  // Scheduler of the task running on this thread, nullptr outside of
+  // tasks.
+  [[nodiscard]] static TaskScheduler* Current() noexcept;
+
+  // Tasks spawned and not finished yet.
+  [[nodiscard]] size_t size() const;
+
+ private:
+  struct Sleeper {
+    uint64_t due;
+    // merge order, keeps tasks due on the same tick in a stable order
+    uint64_t sequence;
+    std::coroutine_handle<> handle;
+  };
+
+  struct alignas(64) Local {
+    std::vector<Sleeper> sleeping;
+  };
+
+  void Push(Sleeper sleeper);
+  // std heaps are max-heaps, the earliest sleeper has to compare greatest
+  [[nodiscard]] static bool Later(Sleeper const& a, Sleeper const& b) noexcept;
+
+  // due tasks are claimed in chunks of this size
+  static constexpr size_t kChunk = 16;
+
+  const size_t threads_;
+  std::unique_ptr<Local[]> locals_;
+  MpscQueue<std::coroutine_handle<>> woken_;
+
+  // min-heap by (due, sequence)
+  std::vector<Sleeper> heap_;
+  uint64_t sequence_ = 0;
+  // tick the tasks resumed in this round run on
+  uint64_t tick_ = 0;
+
+  std::vector<std::coroutine_handle<>> due_;
+  alignas(64) std::atomic<size_t> next_due_ = 0;
+
+  mutable std::mutex spawned_mutex_;
+  std::unordered_set<void*> spawned_;
+};
+}  // namespace engine::core
@@ -0,0 +1,109 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "Clock.h"
+#include "Futex.h"
+
+namespace engine::core {
+
+// Phased barrier with a single leader.
+// Every participant except the leader calls ArriveAndWait, the leader calls
+// ArriveAndComplete, which waits for the others, runs the completion
+// function and releases the phase. Waiting threads spin for a while and then
+// park on a futex, so an idle tick costs no CPU and a short wait costs no
+// syscall.
+//
+// Both functions return the time the calling thread spent blocked.
+class TickBarrier {
+ public:
+  explicit TickBarrier(uint32_t participants, uint32_t spin_count = 4096)
+      : participants_(participants), spin_count_(spin_count) {}
+
+  /* Disable copy and move semantics. */
+  TickBarrier(const TickBarrier&) = delete;
+  TickBarrier(TickBarrier&&) = delete;
+  TickBarrier& operator=(const TickBarrier&) = delete;
+  TickBarrier& operator=(TickBarrier&&) = delete;
+
+  std::chrono::nanoseconds ArriveAndWait() noexcept {
+    const uint64_t start = Clock::Cycles();
+    const uint32_t phase = phase_.load(std::memory_order_acquire);
+
+    if (arrived_.fetch_add(1, std::memory_order_seq_cst) + 1 ==
+            participants_ - 1 &&
+        leader_parked_.load(std::memory_order_seq_cst) != 0) {
+      FutexWakeOne(arrived_);
+    }
+
+    for (uint32_t i = 0; i < spin_count_; i++) {
+      if (phase_.load(std::memory_order_acquire) != phase) {
+        return Elapsed(start);
+      }
+      CpuRelax();
+    }
+
+    parked_.fetch_add(1, std::memory_order_seq_cst);
+    while (phase_.load(std::memory_order_seq_cst) == phase) {
+      FutexWait(phase_, phase);
+    }
+    parked_.fetch_sub(1, std::memory_order_relaxed);
+    return Elapsed(start);
+  }
+
+  template <typename Completion>
+  std::chrono::nanoseconds ArriveAndComplete(Completion&& completion) {
+    const uint64_t start = Clock::Cycles();
+    const uint32_t target = participants_ - 1;
+
+    uint32_t arrived = arrived_.load(std::memory_order_acquire);
+    for (uint32_t i = 0; i < spin_count_ && arrived != target; i++) {
+      CpuRelax();
+      arrived = arrived_.load(std::memory_order_acquire);
+    }
+    if (arrived != target) {
+      leader_parked_.store(1, std::memory_order_seq_cst);
+      while ((arrived = arrived_.load(std::memory_order_seq_cst)) != target) {
+        FutexWait(arrived_, arrived);
+      }
+      leader_parked_.store(0, std::memory_order_relaxed);
+    }
+    std::chrono::nanoseconds waited = Elapsed(start);
+
+    completion();
+
+    arrived_.store(0, std::memory_order_relaxed);
+    phase_.fetch_add(1, std::memory_order_seq_cst);
+    if (parked_.load(std::memory_order_seq_cst) != 0) {
+      FutexWakeAll(phase_);
+    }
+    return waited;
+  }
+
+  [[nodiscard]] uint32_t participants() const noexcept {
+    return participants_;
+  }
+
+  // Number of completed phases.
+  [[nodiscard]] uint32_t phase() const noexcept {
+    return phase_.load(std::memory_order_acquire);
+  }
+
+ private:
+  static std::chrono::nanoseconds Elapsed(uint64_t start) noexcept {
+    const uint64_t end = Clock::Cycles();
+    // the thread may have migrated to a core with a slightly behind TSC
+    return std::chrono::nanoseconds(
+        end > start ? Clock::CyclesToNanoseconds(end - start) : 0);
+  }
+
+  const uint32_t participants_;
+  const uint32_t spin_count_;
+
+  alignas(64) std::atomic<uint32_t> arrived_ = 0;
+  std::atomic<uint32_t> leader_parked_ = 0;
+  alignas(64) std::atomic<uint32_t> phase_ = 0;
+  std::atomic<uint32_t> parked_ = 0;
+};
+}  // namespace engine::core
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "FrameAllocator.h"
+
+namespace engine::core {
+class Core;
+
+// Passed to Ticker::Update by the update thread running the ticker.
+struct TickContext {
+  // tick of the ticker's domain
+  uint64_t tick;
+  // index of the update thread, 0 is the operational thread
+  size_t thread_index;
+  // scratch memory of the update thread, reset at the end of the tick; a
+  // stolen ticker gets the allocator of the thread that stole it
+  FrameAllocator& allocator;
+  // record the distribution of the update time, see UpdateStats
+  bool record_histogram = false;
+  // Core running the ticker, saves Core::GetInstance in hot paths
+  Core* core = nullptr;
+};
+}  // namespace engine::core
@@ -0,0 +1,84 @@
+#include "TickDomains.h"
+
+#include <algorithm>
+
+namespace engine::core {
+
+namespace {
+constexpr int64_t kSecond = 1'000'000'000;
+}  // namespace
+
+TickDomains::TickDomains(uint32_t default_rate) {
+  TickDomainDesc desc;
+  desc.name = "default";
+  desc.rate = default_rate;
+  Register(desc);
+}
+
+DomainId TickDomains::Register(TickDomainDesc const& desc) {
+  if (desc.rate == 0 || Find(desc.name) != kInvalidDomain) {
+    return kInvalidDomain;
+  }
+  Domain domain;
+  domain.desc = desc;
+  domain.desc.max_steps = std::max<uint32_t>(1, desc.max_steps);
+  domains_.push_back(std::move(domain));
+  return DomainId(domains_.size() - 1);
+}
+
+DomainId TickDomains::Find(std::string_view name) const noexcept {
+  for (size_t i = 0; i < domains_.size(); i++) {
+    if (domains_[i].desc.name == name) {
+      return DomainId(i);
+    }
+  }
+  return kInvalidDomain;
+}
+
+uint32_t TickDomains::Advance(int64_t elapsed) {
+  uint32_t rounds = 1;
+  for (auto& domain : domains_) {
+    const int64_t rate = domain.desc.rate;
+    domain.accumulator += std::max<int64_t>(0, elapsed) * rate;
+    // a step is owed once we are within a nanosecond of it, interval
+    // deadlines are whole nanoseconds and would otherwise land just short
+    // of steps at rates which don't divide a second
+    int64_t owed = (domain.accumulator + rate - 1) / kSecond;
+    domain.steps = uint32_t(std::min<int64_t>(owed, domain.desc.max_steps));
+    domain.accumulator -= int64_t(domain.steps) * kSecond;
+    if (domain.accumulator + rate - 1 >= kSecond) {
+      // spiral of death, forget the backlog but keep the phase
+      int64_t backlog = (domain.accumulator + rate - 1) / kSecond * kSecond;
+      domain.dropped += backlog / rate;
+      domain.accumulator -= backlog;
+    }
+    rounds = std::max(rounds, domain.steps);
+  }
+  return rounds;
+}
+
+void TickDomains::BeginRound(uint32_t round, std::vector<uint64_t>& ticks) {
+  ticks.resize(domains_.size());
+  for (size_t i = 0; i < domains_.size(); i++) {
+    Domain& domain = domains_[i];
+    if (round < domain.steps) {
+      ticks[i] = domain.tick++;
+    } else {
+      ticks[i] = kIdle;
+    }
+  }
+}
+
+double TickDomains::alpha(DomainId id) const noexcept {
+  return std::max(0.0, double(domains_[id].accumulator) / double(kSecond));
+}
+
+std::vector<uint32_t> TickDomains::rates() const {
+  std::vector<uint32_t> rv;
+  rv.reserve(domains_.size());
+  for (auto const& domain : domains_) {
+    rv.push_back(domain.desc.rate);
+  }
+  return rv;
+}
+}  // namespace engine::core
@@ -0,0 +1,93 @@
+#pragma once
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+
+namespace engine::core {
+
+using DomainId = uint32_t;
+
+// A group of tickers stepped at its own fixed rate, e.g. physics at 240 Hz
+// and AI at 10 Hz.
+struct TickDomainDesc {
+  std::string name;
+  // steps per second
+  uint32_t rate = 64;
+  // most steps the domain takes in one pacing interval when it falls
+  // behind, the remaining backlog is dropped
+  uint32_t max_steps = 4;
+};
+
+// Fixed timestep accumulators of the tick domains.
+//
+// Every pacing interval Advance adds the elapsed time to each domain and
+// computes how many fixed steps it owes. The interval is then executed in
+// rounds: in round r every domain with more than r steps due takes one
+// step, so a 240 Hz domain runs about four rounds per 64 Hz interval while
+// a 10 Hz domain only runs in some of them. Domains which fell behind after
+// a long interval catch up in the same way, up to max_steps, so a single
+// overrun doesn't desynchronize the simulation from wall-clock time and a
+// persistent one can't snowball.
+//
+// Time is accumulated as nanoseconds times the rate, so steps never drift
+// regardless of whether the rate divides a second.
+//
+// Not thread safe.
+class TickDomains {
+ public:
+  static constexpr DomainId kDefaultDomain = 0;
+  static constexpr DomainId kInvalidDomain =
+      std::numeric_limits<DomainId>::max();
+  // tick of a domain which doesn't step in the current round
+  static constexpr uint64_t kIdle = std::numeric_limits<uint64_t>::max();
+
+  // Registers the "default" domain running at default_rate.
+  explicit TickDomains(uint32_t default_rate);
+
+  // Returns kInvalidDomain if the name is taken or the rate is zero.
+  DomainId Register(TickDomainDesc const& desc);
+
+  [[nodiscard]] DomainId Find(std::string_view name) const noexcept;
+
+  [[nodiscard]] size_t size() const noexcept { return domains_.size(); }
+
+  // Accumulates elapsed nanoseconds and returns the number of rounds
+  // needed to run the steps owed, at least one.
+  uint32_t Advance(int64_t elapsed);
+
+  // Sets ticks[id] to the tick every domain takes in this round and to
+  // kIdle for the domains which don't step.
+  void BeginRound(uint32_t round, std::vector<uint64_t>& ticks);
+
+  // Steps taken so far.
+  [[nodiscard]] uint64_t tick(DomainId id) const noexcept {
+    return domains_[id].tick;
+  }
+  [[nodiscard]] uint32_t rate(DomainId id) const noexcept {
+    return domains_[id].desc.rate;
+  }
+  // Nanoseconds of simulated time dropped by the catch-up cap.
+  [[nodiscard]] int64_t dropped(DomainId id) const noexcept {
+    return domains_[id].dropped;
+  }
+  // Fraction of a step accumulated but not simulated yet, in [0, 1).
+  // Useful for interpolating between the last two steps.
+  [[nodiscard]] double alpha(DomainId id) const noexcept;
+
+  [[nodiscard]] std::vector<uint32_t> rates() const;
+
+ private:
+  struct Domain {
+    TickDomainDesc desc;
+    // nanoseconds * rate, can dip below zero by less than a nanosecond
+    int64_t accumulator = 0;
+    int64_t dropped = 0;
+    uint64_t tick = 0;
+    uint32_t steps = 0;
+  };
+
+  std::vector<Domain> domains_;
+};
+}  // namespace engine::core
@@ -0,0 +1,105 @@
+#include "TickPacer.h"
+
+#include <cmath>
+#include <thread>
+#include <algorithm>
+
+#if defined(__linux__)
+#include <time.h>
+#include <cerrno>
+#elif defined(_WIN32)
+#include <Windows.h>
+#endif
+
+#include "Futex.h"
+
+namespace engine::core {
+
+TickPacer::TickPacer(Mode mode) : mode_(mode) {
+#if defined(_WIN32)
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+  timer_ = CreateWaitableTimerExW(nullptr, nullptr,
+                                  CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                  TIMER_ALL_ACCESS);
+  if (timer_ == nullptr) {
+    // high resolution timers are not available before Windows 10 1803
+    timer_ = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+  }
+#endif
+}
+
+TickPacer::~TickPacer() {
+#if defined(_WIN32)
+  if (timer_ != nullptr) {
+    CloseHandle(timer_);
+  }
+#endif
+}
+
+void TickPacer::SleepUntil(Clock::time_point deadline) {
+  if (mode() == Mode::kHybrid) {
+    auto target = deadline - spin_window();
+    if (Clock::now() < target) {
+      OsSleepUntil(target);
+      UpdateSpinWindow(std::max(Clock::now() - target, Clock::duration(0)));
+    }
+  }
+  while (Clock::now() < deadline) {
+    CpuRelax();
+  }
+}
+
+void TickPacer::OsSleepUntil(Clock::time_point target) {
+#if defined(__linux__)
+  // steady_clock is CLOCK_MONOTONIC on Linux
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                target.time_since_epoch())
+                .count();
+  timespec ts;
+  ts.tv_sec = time_t(ns / 1'000'000'000);
+  ts.tv_nsec = long(ns % 1'000'000'000);
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) ==
+         EINTR) {
+  }
+#elif defined(_WIN32)
+  auto left = target - Clock::now();
+  if (timer_ == nullptr || left <= Clock::duration(0)) {
+    std::this_thread::sleep_until(target);
+    return;
+  }
+  LARGE_INTEGER due;
+  // negative value means relative time in 100ns intervals
+  due.QuadPart = -std::max<int64_t>(
+      1, std::chrono::duration_cast<std::chrono::nanoseconds>(left).count() /
+             100);
+  if (SetWaitableTimer(timer_, &due, 0, nullptr, nullptr, FALSE)) {
+    WaitForSingleObject(timer_, INFINITE);
+  } else {
+    std::this_thread::sleep_until(target);
+  }
+#else
+  std::this_thread::sleep_until(target);
+#endif
+}
+
+void TickPacer::UpdateSpinWindow(std::chrono::nanoseconds oversleep) noexcept {
+  constexpr double kAlpha = 1.0 / 16;
+  const double x = double(oversleep.count());
+  double mean = jitter_mean_.load(std::memory_order_relaxed);
+  double deviation = jitter_deviation_.load(std::memory_order_relaxed);
+  mean += (x - mean) * kAlpha;
+  deviation += (std::abs(x - mean) - deviation) * kAlpha;
+  jitter_mean_.store(mean, std::memory_order_relaxed);
+  jitter_deviation_.store(deviation, std::memory_order_relaxed);
+
+  auto window = int64_t(mean + 4 * deviation);
+  // a single late wake-up widens the window at once, it shrinks back slowly
+  const int64_t current = spin_window_.load(std::memory_order_relaxed);
+  window = std::max(window, std::min(int64_t(x), current * 2));
+  window = std::clamp(window, int64_t(kMinSpinWindow.count()),
+                      int64_t(kMaxSpinWindow.count()));
+  spin_window_.store(window, std::memory_order_relaxed);
+}
+}  // namespace engine::core
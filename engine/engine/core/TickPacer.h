@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace engine::core {
+
+// Waits for the start of the next tick.
+//
+// In kHybrid mode the thread sleeps on a high resolution timer for most of
+// the interval and spins only for the last spin_window() nanoseconds. The
+// spin window follows the measured wake-up latency of the OS timer: it is
+// the smoothed oversleep plus four mean deviations, so a noisy host spins a
+// little longer and a quiet one barely spins at all.
+//
+// kBusySpin spins for the whole interval. It gives the lowest jitter and
+// burns a full core, so it should only be used on dedicated hosts.
+class TickPacer {
+ public:
+  enum class Mode : uint32_t { kHybrid = 0, kBusySpin = 1 };
+
+  using Clock = std::chrono::steady_clock;
+
+  explicit TickPacer(Mode mode = Mode::kHybrid);
+  ~TickPacer();
+
+  /* Disable copy and move semantics. */
+  TickPacer(const TickPacer&) = delete;
+  TickPacer(TickPacer&&) = delete;
+  TickPacer& operator=(const TickPacer&) = delete;
+  TickPacer& operator=(TickPacer&&) = delete;
+
+  // Blocks the calling thread until deadline.
+  // Should be called from one thread at a time.
+  void SleepUntil(Clock::time_point deadline);
+
+  void SetMode(Mode mode) noexcept {
+    mode_.store(mode, std::memory_order_relaxed);
+  }
+  [[nodiscard]] Mode mode() const noexcept {
+    return mode_.load(std::memory_order_relaxed);
+  }
+
+  // Time left before the deadline at which we stop sleeping and start to
+  // spin.
+  [[nodiscard]] std::chrono::nanoseconds spin_window() const noexcept {
+    return std::chrono::nanoseconds(
+        spin_window_.load(std::memory_order_relaxed));
+  }
+
+  // Smoothed time the OS timer overslept its target.
+  [[nodiscard]] std::chrono::nanoseconds wakeup_jitter() const noexcept {
+    return std::chrono::nanoseconds(
+        int64_t(jitter_mean_.load(std::memory_order_relaxed)));
+  }
+
+ private:
+  static constexpr std::chrono::nanoseconds kMinSpinWindow{20'000};
+  static constexpr std::chrono::nanoseconds kMaxSpinWindow{2'000'000};
+  static constexpr std::chrono::nanoseconds kInitialSpinWindow{500'000};
+
+  // Sleeps on the OS timer, may wake up late.
+  void OsSleepUntil(Clock::time_point target);
+
+  void UpdateSpinWindow(std::chrono::nanoseconds oversleep) noexcept;
+
+  std::atomic<Mode> mode_;
+  std::atomic<int64_t> spin_window_ = kInitialSpinWindow.count();
+
+  // written by the pacing thread only, wakeup_jitter() may read from any
+  std::atomic<double> jitter_mean_ = 0;
+  std::atomic<double> jitter_deviation_ = 0;
+
+  // waitable timer handle on Windows
+  void* timer_ = nullptr;
+};
+}  // namespace engine::core
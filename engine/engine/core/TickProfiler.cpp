@@ -0,0 +1,154 @@
+#include "TickProfiler.h"
+
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+
+#if defined(__GNUC__)
+#include <cxxabi.h>
+#endif
+
+namespace engine::core {
+
+std::string Demangle(const char* name) {
+#if defined(__GNUC__)
+  int status = 0;
+  char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+  if (status == 0 && demangled != nullptr) {
+    std::string rv(demangled);
+    std::free(demangled);
+    return rv;
+  }
+#endif
+  return name;
+}
+
+namespace {
+
+void WriteEscaped(std::ostream& out, std::string const& str) {
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      out << '\\';
+    }
+    out << c;
+  }
+}
+
+// microseconds with nanosecond precision, as the format expects
+void WriteMicroseconds(std::ostream& out, int64_t ns) {
+  if (ns < 0) {
+    out << '-';
+    ns = -ns;
+  }
+  const int64_t fraction = ns % 1000;
+  out << ns / 1000 << '.' << char('0' + fraction / 100)
+      << char('0' + fraction / 10 % 10) << char('0' + fraction % 10);
+}
+}  // namespace
+
+TickProfiler::TickProfiler(size_t threads)
+    : threads_(threads),
+      base_ns_(Clock::Now()),
+      base_cycles_(Clock::Cycles()) {}
+
+void TickProfiler::Start(size_t events_per_thread) {
+  if (!allocated_.load(std::memory_order_acquire)) {
+    size_t capacity = 1;
+    while (capacity < std::max<size_t>(events_per_thread, 2)) {
+      capacity <<= 1;
+    }
+    for (size_t i = 0; i < threads_; i++) {
+      auto ring = std::make_unique<Ring>();
+      ring->events = std::make_unique<Slot[]>(capacity);
+      ring->mask = capacity - 1;
+      rings_.push_back(std::move(ring));
+    }
+    allocated_.store(true, std::memory_order_release);
+  }
+  enabled_.store(true, std::memory_order_release);
+}
+
+std::vector<ProfileEvent> TickProfiler::Snapshot(Ring const& ring) {
+  const uint64_t capacity = ring.mask + 1;
+  const uint64_t head = ring.head.load(std::memory_order_acquire);
+  const uint64_t first = head > capacity ? head - capacity : 0;
+  std::vector<ProfileEvent> rv;
+  rv.reserve(head - first);
+  for (uint64_t i = first; i < head; i++) {
+    rv.push_back(ring.events[i & ring.mask].Load());
+  }
+  // drop what the writer overwrote while we were copying; it may already be
+  // storing event new_head, which overwrites event new_head - capacity
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const uint64_t new_head = ring.head.load(std::memory_order_relaxed);
+  const uint64_t valid =
+      new_head + 1 > capacity ? new_head + 1 - capacity : 0;
+  if (valid > first) {
+    rv.erase(rv.begin(),
+             rv.begin() + std::min<uint64_t>(valid - first, rv.size()));
+  }
+  return rv;
+}
+
+int64_t TickProfiler::ToNanoseconds(uint64_t cycles) const noexcept {
+  if (cycles >= base_cycles_) {
+    return base_ns_ + Clock::CyclesToNanoseconds(cycles - base_cycles_);
+  }
+  return base_ns_ - Clock::CyclesToNanoseconds(base_cycles_ - cycles);
+}
+
+void TickProfiler::WriteChromeTrace(std::ostream& out, uint64_t first_tick,
+                                    uint64_t last_tick) const {
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  bool first = true;
+  auto separator = [&out, &first]() {
+    if (!first) {
+      out << ",\n";
+    }
+    first = false;
+  };
+  if (!allocated_.load(std::memory_order_acquire)) {
+    out << "]}\n";
+    return;
+  }
+  for (size_t thread = 0; thread < threads_; thread++) {
+    separator();
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+        << thread << ",\"args\":{\"name\":\"";
+    if (thread == 0) {
+      out << "operational";
+    } else {
+      out << "update " << thread;
+    }
+    out << "\"}}";
+
+    for (auto const& event : Snapshot(*rings_[thread])) {
+      if (event.tick < first_tick || event.tick > last_tick) {
+        continue;
+      }
+      const int64_t begin = ToNanoseconds(event.begin);
+      const int64_t end = std::max(begin, ToNanoseconds(event.end));
+      separator();
+      out << "{\"name\":\"";
+      if (event.type == ProfileEvent::Type::kBarrierWait) {
+        out << "barrier wait\",\"cat\":\"barrier\"";
+      } else {
+        WriteEscaped(out, event.name != nullptr ? Demangle(event.name)
+                                                : std::string("Ticker"));
+        out << "\",\"cat\":\"update\"";
+      }
+      out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread << ",\"ts\":";
+      WriteMicroseconds(out, begin);
+      out << ",\"dur\":";
+      WriteMicroseconds(out, end - begin);
+      out << ",\"args\":{\"tick\":" << event.tick;
+      if (event.type == ProfileEvent::Type::kUpdate) {
+        out << ",\"object\":\"0x" << std::hex << event.object << std::dec
+            << "\",\"system\":" << event.system;
+      }
+      out << "}}";
+    }
+  }
+  out << "]}\n";
+}
+}  // namespace engine::core
@@ -0,0 +1,138 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ostream>
+
+#include "Clock.h"
+
+namespace engine::core {
+
+// Readable name of a type_info::name(), unchanged where the compiler
+// doesn't mangle.
+[[nodiscard]] std::string Demangle(const char* name);
+
+// One recorded interval, timestamps are Clock::Cycles() readings.
+struct ProfileEvent {
+  enum class Type : uint32_t { kUpdate = 0, kBarrierWait = 1 };
+
+  uint64_t begin = 0;
+  uint64_t end = 0;
+  // Core::global_tick() when the event was recorded
+  uint64_t tick = 0;
+  // type name of the ticker, nullptr for barrier waits
+  const char* name = nullptr;
+  uintptr_t object = 0;
+  Type type = Type::kUpdate;
+  uint32_t system = 0;
+};
+
+// Records ticker updates and barrier waits of every update thread.
+//
+// Each thread writes into its own ring buffer with relaxed stores, ordered
+// only by a release fence and a release store of the write position; when a
+// ring is full the oldest events are overwritten. Recording costs two cycle
+// counter reads and a 48 byte store per event, and a single load while
+// disabled. Start and Stop should be called from one thread at a time.
+//
+// WriteChromeTrace can run concurrently with recording. Events overwritten
+// while it copies a ring are dropped from the output, and so is the oldest
+// event of a full ring, which the writer may be overwriting at that moment.
+class TickProfiler {
+ public:
+  explicit TickProfiler(size_t threads);
+
+  /* Disable copy and move semantics. */
+  TickProfiler(const TickProfiler&) = delete;
+  TickProfiler(TickProfiler&&) = delete;
+  TickProfiler& operator=(const TickProfiler&) = delete;
+  TickProfiler& operator=(TickProfiler&&) = delete;
+  ~TickProfiler() = default;
+
+  // Allocates the rings on the first call, events_per_thread is rounded up
+  // to a power of two and ignored afterwards.
+  void Start(size_t events_per_thread);
+  void Stop() noexcept { enabled_.store(false, std::memory_order_release); }
+
+  [[nodiscard]] bool enabled() const noexcept {
+    return enabled_.load(std::memory_order_acquire);
+  }
+
+  // Should only be called by the update thread with this index, and only
+  // while enabled() is true.
+  void Record(size_t thread, ProfileEvent const& event) noexcept {
+    Ring& ring = *rings_[thread];
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    // pairs with the acquire fence in Snapshot: a reader that sees any field
+    // of this event also sees head advanced to at least this index
+    std::atomic_thread_fence(std::memory_order_release);
+    ring.events[head & ring.mask].Store(event);
+    ring.head.store(head + 1, std::memory_order_release);
+  }
+
+  // Writes the events of ticks [first_tick, last_tick] in the Chrome Trace
+  // Event format, which chrome://tracing and ui.perfetto.dev open directly.
+  // Every update thread is one track, 0 is the operational thread.
+  void WriteChromeTrace(std::ostream& out, uint64_t first_tick,
+                        uint64_t last_tick) const;
+
+ private:
+  // A ProfileEvent stored field by field in relaxed atomics, so that a
+  // reader copying a slot while it is overwritten gets a torn event, which
+  // Snapshot then drops, rather than a data race.
+  struct Slot {
+    void Store(ProfileEvent const& event) noexcept {
+      begin.store(event.begin, std::memory_order_relaxed);
+      end.store(event.end, std::memory_order_relaxed);
+      tick.store(event.tick, std::memory_order_relaxed);
+      name.store(event.name, std::memory_order_relaxed);
+      object.store(event.object, std::memory_order_relaxed);
+      type.store(event.type, std::memory_order_relaxed);
+      system.store(event.system, std::memory_order_relaxed);
+    }
+    [[nodiscard]] ProfileEvent Load() const noexcept {
+      ProfileEvent rv;
+      rv.begin = begin.load(std::memory_order_relaxed);
+      rv.end = end.load(std::memory_order_relaxed);
+      rv.tick = tick.load(std::memory_order_relaxed);
+      rv.name = name.load(std::memory_order_relaxed);
+      rv.object = object.load(std::memory_order_relaxed);
+      rv.type = type.load(std::memory_order_relaxed);
+      rv.system = system.load(std::memory_order_relaxed);
+      return rv;
+    }
+
+    std::atomic<uint64_t> begin = 0;
+    std::atomic<uint64_t> end = 0;
+    std::atomic<uint64_t> tick = 0;
+    std::atomic<const char*> name = nullptr;
+    std::atomic<uintptr_t> object = 0;
+    std::atomic<ProfileEvent::Type> type = ProfileEvent::Type::kUpdate;
+    std::atomic<uint32_t> system = 0;
+  };
+
+  struct Ring {
+    std::unique_ptr<Slot[]> events;
+    uint64_t mask = 0;
+    alignas(64) std::atomic<uint64_t> head = 0;
+  };
+
+  // Events of the ring still present in it, oldest first.
+  [[nodiscard]] static std::vector<ProfileEvent> Snapshot(Ring const& ring);
+
+  // Nanoseconds since Clock start of a cycle counter reading.
+  [[nodiscard]] int64_t ToNanoseconds(uint64_t cycles) const noexcept;
+
+  const size_t threads_;
+  std::vector<std::unique_ptr<Ring>> rings_;
+  // set once the rings are allocated, published by enabled_
+  std::atomic<bool> allocated_ = false;
+  std::atomic<bool> enabled_ = false;
+
+  // a Clock::Now() and Clock::Cycles() pair read at the same time
+  int64_t base_ns_;
+  uint64_t base_cycles_;
+};
+}  // namespace engine::core
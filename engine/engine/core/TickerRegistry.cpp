@@ -0,0 +1,313 @@
+#include "TickerRegistry.h"
+
+#include <algorithm>
+
+#include "Futex.h"
+
+namespace engine::core {
+
+TickerRegistry::~TickerRegistry() {
+  for (auto const& object : parked_) {
+    Unlink(*object);
+  }
+}
+
+Handle TickerRegistry::Add(std::weak_ptr<Ticker> object) {
+  auto ptr = object.lock();
+  if (ptr == nullptr) {
+    return {};
+  }
+  Handle handle = slots_.Allocate({});
+  Insert(handle, ptr);
+  return handle;
+}
+
+void TickerRegistry::Remove(Handle handle) {
+  Slot* slot = slots_.Get(handle);
+  if (slot == nullptr || slot->removing) {
+    return;
+  }
+  slot->removing = true;
+  to_remove_.push_back(handle);
+}
+
+void TickerRegistry::Park(Handle handle) {
+  Slot* slot = slots_.Get(handle);
+  if (slot == nullptr || slot->removing || slot->bucket == kParked) {
+    return;
+  }
+  to_park_.push_back(handle);
+}
+
+void TickerRegistry::Unpark(Handle handle) {
+  Slot* slot = slots_.Get(handle);
+  if (slot == nullptr || slot->removing || slot->bucket != kParked) {
+    return;
+  }
+  auto object = std::move(parked_[slot->position]);
+  SwapAndPop(*slot);
+  if (Expired(object)) {
+    slots_.Release(handle);
+    return;
+  }
+  Insert(handle, object);
+}
+
+void TickerRegistry::Unlink(Ticker& object) noexcept {
+  auto expected = Ticker::ParkState::kParked;
+  while (!object.parked_.compare_exchange_weak(expected,
+                                               Ticker::ParkState::kNone,
+                                               std::memory_order_seq_cst)) {
+    if (expected == Ticker::ParkState::kNone) {
+      // woken already, the wake-up was pushed
+      return;
+    }
+    // kWaking: EnableUpdating is pushing into wakeups_ right now
+    expected = Ticker::ParkState::kParked;
+    CpuRelax();
+  }
+  object.parked_in_ = nullptr;
+}
+
+void TickerRegistry::Flush() {
+  for (Handle handle : to_rebucket_) {
+    Slot* slot = slots_.Get(handle);
+    if (slot == nullptr || slot->removing) {
+      continue;
+    }
+    auto object = std::move(buckets_[slot->bucket].objects[slot->position]);
+    SwapAndPop(*slot);
+    if (Expired(object)) {
+      slots_.Release(handle);
+      continue;
+    }
+    Insert(handle, object);
+  }
+  to_rebucket_.clear();
+
+  for (Handle handle : to_park_) {
+    Slot* slot = slots_.Get(handle);
+    if (slot == nullptr || slot->removing || slot->bucket == kParked) {
+      continue;
+    }
+    auto object = std::move(buckets_[slot->bucket].objects[slot->position]);
+    SwapAndPop(*slot);
+    if (Expired(object)) {
+      slots_.Release(handle);
+      continue;
+    }
+    *slot = {kParked, uint32_t(parked_.size()), false};
+    parked_.push_back(object);
+    parked_handles_.push_back(handle);
+    // the wake-up which unparked the ticker last time may still be reading
+    // parked_in_, possibly of another registry
+    while (object->parked_.load(std::memory_order_acquire) ==
+           Ticker::ParkState::kWaking) {
+      CpuRelax();
+    }
+    object->parked_in_ = &wakeups_;
+    object->parked_handle_ = handle;
+    object->parked_.store(Ticker::ParkState::kParked,
+                          std::memory_order_seq_cst);
+    // EnableUpdating may have run before parked_ was set and found nothing
+    // to wake
+    auto expected = Ticker::ParkState::kParked;
+    if (object->needs_update_.load(std::memory_order_seq_cst) &&
+        object->parked_.compare_exchange_strong(expected,
+                                                Ticker::ParkState::kNone,
+                                                std::memory_order_seq_cst)) {
+      Unpark(handle);
+    }
+  }
+  to_park_.clear();
+
+  for (Handle handle : to_remove_) {
+    Slot* slot = slots_.Get(handle);
+    if (slot == nullptr) {
+      continue;
+    }
+    if (slot->bucket == kParked) {
+      Unlink(*parked_[slot->position]);
+    }
+    SwapAndPop(*slot);
+    slots_.Release(handle);
+  }
+  to_remove_.clear();
+}
+
+void TickerRegistry::CollectDue(std::vector<uint64_t> const& ticks) {
+  due_.clear();
+  Handle handle;
+  while (wakeups_.Pop(handle)) {
+    Unpark(handle);
+  }
+  for (size_t i = 0; i < kSweepPerRound && !parked_.empty(); i++) {
+    sweep_ = (sweep_ + 1) % parked_.size();
+    if (Expired(parked_[sweep_])) {
+      Remove(parked_handles_[sweep_]);
+    }
+  }
+
+  if (wheels_.size() < ticks.size()) {
+    wheels_.resize(ticks.size());
+  }
+  for (DomainId domain = 0; domain < ticks.size(); domain++) {
+    const uint64_t tick = ticks[domain];
+    if (tick == TickDomains::kIdle) {
+      continue;
+    }
+    wheels_[domain].Advance(tick, [&](uint32_t index) {
+      if (WheelOf(buckets_[index], ticks.size()) != domain) {
+        // the domain of the bucket was registered since it was scheduled
+        to_schedule_.push_back(index);
+        return;
+      }
+      due_.push_back({index, domain, tick});
+    });
+  }
+
+  size_t kept = 0;
+  for (uint32_t index : to_schedule_) {
+    Bucket const& bucket = buckets_[index];
+    const DomainId wheel = WheelOf(bucket, ticks.size());
+    const uint64_t tick = ticks[wheel];
+    if (tick == TickDomains::kIdle) {
+      to_schedule_[kept++] = index;
+      continue;
+    }
+    // first tick from now on where tick % tickrate == phase
+    const uint64_t due =
+        tick + (bucket.phase + bucket.tickrate - tick % bucket.tickrate) %
+                   bucket.tickrate;
+    if (due == tick) {
+      due_.push_back({index, wheel, tick});
+    } else {
+      wheels_[wheel].Schedule(due, index);
+    }
+  }
+  to_schedule_.resize(kept);
+}
+
+void TickerRegistry::FinishRound() {
+  Flush();
+  for (DueBucket const& due : due_) {
+    Bucket& bucket = buckets_[due.bucket];
+    if (bucket.objects.empty()) {
+      // scheduled again by the next Insert
+      bucket.scheduled = false;
+      continue;
+    }
+    wheels_[due.wheel].Schedule(due.tick + bucket.tickrate, due.bucket);
+  }
+}
+
+double TickerRegistry::Extract(double budget,
+                               std::vector<uint32_t> const& domain_rates,
+                               std::vector<std::weak_ptr<Ticker>>& out) {
+  Flush();
+  double extracted = 0;
+  for (auto& bucket : buckets_) {
+    const double frequency = Frequency(bucket, domain_rates);
+    if (bucket.pinned || frequency == 0) {
+      continue;
+    }
+    // walk backwards, so swap-and-pop only moves already visited tickers
+    for (size_t i = bucket.objects.size(); i-- > 0;) {
+      auto const& object = bucket.objects[i];
+      if (Expired(object)) {
+        continue;
+      }
+      double cost = object->average_update_time() * frequency;
+      if (cost <= 0 || extracted + cost > budget) {
+        continue;
+      }
+      extracted += cost;
+      bucket.cost = std::max(0.0, bucket.cost - object->average_update_time());
+      Handle handle = bucket.handles[i];
+      out.push_back(object);
+      SwapAndPop(*slots_.Get(handle));
+      slots_.Release(handle);
+    }
+  }
+  return extracted;
+}
+
+double TickerRegistry::exec_time(
+    std::vector<uint32_t> const& domain_rates) const noexcept {
+  double rv = 0;
+  for (auto const& bucket : buckets_) {
+    rv += bucket.cost * Frequency(bucket, domain_rates);
+  }
+  return rv;
+}
+
+double TickerRegistry::Frequency(
+    Bucket const& bucket, std::vector<uint32_t> const& domain_rates) noexcept {
+  if (bucket.tickrate == 0 || domain_rates.empty()) {
+    return 0;
+  }
+  const uint32_t domain_rate = bucket.domain < domain_rates.size()
+                                   ? domain_rates[bucket.domain]
+                                   : domain_rates[TickDomains::kDefaultDomain];
+  return double(domain_rate) / bucket.tickrate;
+}
+
+uint32_t TickerRegistry::FindBucket(DomainId domain, uint32_t tickrate,
+                                    uint32_t phase, std::type_index type,
+                                    bool pinned) {
+  auto rate = std::find_if(rates_.begin(), rates_.end(),
+                           [domain, tickrate](Rate const& r) {
+                             return r.domain == domain &&
+                                    r.tickrate == tickrate;
+                           });
+  if (rate == rates_.end()) {
+    rates_.push_back({domain, tickrate, {}});
+    rate = rates_.end() - 1;
+  }
+  if (phase >= rate->phases.size()) {
+    rate->phases.resize(size_t(phase) + 1);
+  }
+  auto& buckets = rate->phases[phase];
+  for (uint32_t index : buckets) {
+    if (buckets_[index].type == type && buckets_[index].pinned == pinned) {
+      return index;
+    }
+  }
+  auto index = uint32_t(buckets_.size());
+  buckets_.push_back({domain, tickrate, phase, type, pinned, {}, {}, 0});
+  buckets.push_back(index);
+  return index;
+}
+
+void TickerRegistry::Insert(Handle handle,
+                            std::shared_ptr<Ticker> const& object) {
+  bool pinned = !object->thread_id().expired();
+  uint32_t bucket = FindBucket(object->domain(), object->tickrate(),
+                               object->phase(), typeid(*object), pinned);
+  Bucket& b = buckets_[bucket];
+  *slots_.Get(handle) = {bucket, uint32_t(b.objects.size()), false};
+  b.objects.push_back(object);
+  b.handles.push_back(handle);
+  // keep the estimate right for migrated tickers until the bucket is due
+  b.cost += object->average_update_time();
+  if (!b.scheduled && b.tickrate != 0) {
+    b.scheduled = true;
+    to_schedule_.push_back(bucket);
+  }
+}
+
+void TickerRegistry::SwapAndPop(Slot const& slot) {
+  auto& objects =
+      slot.bucket == kParked ? parked_ : buckets_[slot.bucket].objects;
+  auto& handles =
+      slot.bucket == kParked ? parked_handles_ : buckets_[slot.bucket].handles;
+  const uint32_t last = uint32_t(objects.size() - 1);
+  if (slot.position != last) {
+    objects[slot.position] = std::move(objects[last]);
+    handles[slot.position] = handles[last];
+    slots_.Get(handles[slot.position])->position = slot.position;
+  }
+  objects.pop_back();
+  handles.pop_back();
+}
+}  // namespace engine::core
@@ -0,0 +1,243 @@
+#pragma once
+#include <limits>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <typeindex>
+
+#include "HandleTable.h"
+#include "MpscQueue.h"
+#include "TickDomains.h"
+#include "TimerWheel.h"
+#include "engine/Ticker.h"
+
+namespace engine::core {
+
+// Storage for the tickers of one update thread.
+//
+// Tickers are grouped into buckets by tick domain, tickrate, phase,
+// concrete type and whether they are bound to the thread. Each bucket keeps
+// its tickers in one contiguous array and sits in the timer wheel of its
+// domain at the next tick it is due on, so a round only touches the buckets
+// due in it; tickers which are not due are never loaded, however many
+// tickrates are in use. Grouping by type keeps consecutive virtual Update
+// calls on the same code.
+//
+// A ticker found disabled (Ticker::DisableUpdating) when its bucket is due
+// is parked outside of every bucket and costs nothing until
+// Ticker::EnableUpdating queues it back through a lock-free wake-up queue.
+//
+// The registry shares ownership of its tickers, so running them needs no
+// weak_ptr::lock or reference count traffic. A ticker whose other owners
+// are gone (the registry holds the last reference) counts as expired; it is
+// found when its bucket is due and dropped by the owning thread.
+//
+// Every added ticker gets a generation-checked handle which stays valid
+// while the ticker is stored here, regardless of how the buckets are
+// reordered. Removal is deferred until the end of ForEachDue (or Flush) and
+// done by swapping with the last element of the bucket, so despawning any
+// number of tickers costs linear time.
+//
+// Not thread safe, should only be used by the owning thread.
+class TickerRegistry {
+ public:
+  TickerRegistry() = default;
+  // Detaches parked tickers from the wake-up queue, so EnableUpdating on a
+  // ticker which outlives the registry does nothing.
+  ~TickerRegistry();
+
+  /* Disable copy and move semantics. */
+  TickerRegistry(const TickerRegistry&) = delete;
+  TickerRegistry(TickerRegistry&&) = delete;
+  TickerRegistry& operator=(const TickerRegistry&) = delete;
+  TickerRegistry& operator=(TickerRegistry&&) = delete;
+
+  Handle Add(std::weak_ptr<Ticker> object);
+
+  // Queues removal of the ticker. Stale handles are ignored.
+  void Remove(Handle handle);
+
+  // Applies queued removals.
+  void Flush();
+
+  // Removes unpinned tickers with a total estimated cost of at most budget
+  // seconds per second and appends them to out. Used to migrate work to
+  // another thread; tickers with no measured cost yet are left in place.
+  // domain_rates holds the steps per second of every tick domain.
+  double Extract(double budget, std::vector<uint32_t> const& domain_rates,
+                 std::vector<std::weak_ptr<Ticker>>& out);
+
+  // Calls fn(Ticker&, bool pinned) for every ticker due in this round.
+  // ticks holds the current tick of every domain, or TickDomains::kIdle if
+  // the domain doesn't step; tickers of unknown domains follow the default
+  // one. Expired tickers are queued for removal and disabled ones for
+  // parking on the way, both are applied before the function returns. The
+  // tickers passed to fn stay alive until the next call of ForEachDue,
+  // Extract or Flush.
+  template <typename Function>
+  void ForEachDue(std::vector<uint64_t> const& ticks, Function&& fn);
+
+  // Calls fn(Ticker&) for every stored ticker, parked ones included.
+  template <typename Function>
+  void ForEach(Function&& fn) const;
+
+  [[nodiscard]] bool Contains(Handle handle) const noexcept {
+    return slots_.Contains(handle);
+  }
+
+  [[nodiscard]] size_t size() const noexcept { return slots_.size(); }
+
+  // Estimated execution time of the stored tickers in seconds per second.
+  // Every bucket refreshes its estimate when it is due.
+  [[nodiscard]] double exec_time(
+      std::vector<uint32_t> const& domain_rates) const noexcept;
+
+ private:
+  struct Bucket {
+    DomainId domain;
+    uint32_t tickrate;
+    uint32_t phase;
+    std::type_index type;
+    bool pinned;
+    std::vector<std::shared_ptr<Ticker>> objects;
+    std::vector<Handle> handles;
+    // sum of average_update_time() at the last visit
+    double cost = 0;
+    // in a timer wheel or waiting in to_schedule_
+    bool scheduled = false;
+  };
+
+  // Slot::bucket of parked tickers, Slot::position indexes parked_
+  static constexpr uint32_t kParked = std::numeric_limits<uint32_t>::max();
+
+  struct Slot {
+    uint32_t bucket = 0;
+    uint32_t position = 0;
+    // removal is already queued
+    bool removing = false;
+  };
+
+  struct Rate {
+    DomainId domain;
+    uint32_t tickrate;
+    // buckets indexed by phase, only grown up to the highest used phase
+    std::vector<std::vector<uint32_t>> phases;
+  };
+
+  struct DueBucket {
+    uint32_t bucket;
+    // wheel the bucket fired from and the tick it is due on
+    DomainId wheel;
+    uint64_t tick;
+  };
+
+  // True if only the registry still holds the ticker.
+  [[nodiscard]] static bool Expired(
+      std::shared_ptr<Ticker> const& object) noexcept {
+    return object.use_count() == 1;
+  }
+
+  uint32_t FindBucket(DomainId domain, uint32_t tickrate, uint32_t phase,
+                      std::type_index type, bool pinned);
+
+  // Seconds per second one Update of the bucket costs per unit of
+  // average_update_time().
+  [[nodiscard]] static double Frequency(
+      Bucket const& bucket, std::vector<uint32_t> const& domain_rates) noexcept;
+
+  // Wheel of the bucket's domain, unknown domains use the default one.
+  [[nodiscard]] static DomainId WheelOf(Bucket const& bucket,
+                                        size_t domains) noexcept {
+    return bucket.domain < domains ? bucket.domain
+                                   : TickDomains::kDefaultDomain;
+  }
+
+  // Wakes tickers enabled since the last round, advances the wheels of the
+  // stepping domains and fills due_ with the buckets due in this round.
+  void CollectDue(std::vector<uint64_t> const& ticks);
+  // Applies queued changes and puts the due buckets back into their wheel.
+  void FinishRound();
+
+  void Insert(Handle handle, std::shared_ptr<Ticker> const& object);
+  // Queues removal of the ticker from its bucket, applied on Flush.
+  void Park(Handle handle);
+  // Moves a parked ticker back into its bucket.
+  void Unpark(Handle handle);
+  // Stops EnableUpdating of a parked ticker from pushing to wakeups_, waits
+  // for a push already in progress.
+  static void Unlink(Ticker& object) noexcept;
+  // Swaps the ticker with the last one of its bucket (or of the parked
+  // tickers) and pops it.
+  void SwapAndPop(Slot const& slot);
+
+  std::vector<Bucket> buckets_;
+  // distinct tickrates per domain and buckets which use them, used to find
+  // the bucket of a ticker
+  std::vector<Rate> rates_;
+
+  // per domain, buckets keyed by the next tick they are due on
+  std::vector<TimerWheel<uint32_t>> wheels_;
+  // buckets which have to enter a wheel once their domain steps
+  std::vector<uint32_t> to_schedule_;
+  std::vector<DueBucket> due_;
+
+  std::vector<std::shared_ptr<Ticker>> parked_;
+  std::vector<Handle> parked_handles_;
+  std::vector<Handle> to_park_;
+  // pushed by Ticker::EnableUpdating from any thread
+  MpscQueue<Handle> wakeups_;
+  // parked tickers are checked for expiry a few per round
+  size_t sweep_ = 0;
+  static constexpr size_t kSweepPerRound = 8;
+
+  HandleTable<Slot> slots_;
+
+  std::vector<Handle> to_remove_;
+  // tickers whose tickrate changed since they were added, they keep their
+  // handle and are moved to the matching bucket on Flush
+  std::vector<Handle> to_rebucket_;
+};
+
+template <typename Function>
+void TickerRegistry::ForEach(Function&& fn) const {
+  for (auto const& bucket : buckets_) {
+    for (auto const& object : bucket.objects) {
+      fn(*object);
+    }
+  }
+  for (auto const& object : parked_) {
+    fn(*object);
+  }
+}
+
+template <typename Function>
+void TickerRegistry::ForEachDue(std::vector<uint64_t> const& ticks,
+                                Function&& fn) {
+  CollectDue(ticks);
+  for (DueBucket const& due : due_) {
+    Bucket& bucket = buckets_[due.bucket];
+    bucket.cost = 0;
+    const size_t count = bucket.objects.size();
+    for (size_t i = 0; i < count; i++) {
+      if (Expired(bucket.objects[i])) {
+        Remove(bucket.handles[i]);
+        continue;
+      }
+      Ticker& object = *bucket.objects[i];
+      if (object.tickrate() != bucket.tickrate ||
+          object.phase() != bucket.phase) {
+        to_rebucket_.push_back(bucket.handles[i]);
+        continue;
+      }
+      if (!object.needs_update()) {
+        Park(bucket.handles[i]);
+        continue;
+      }
+      bucket.cost += object.average_update_time();
+      // the bucket is due, so is every ticker with its tickrate and phase
+      fn(object, bucket.pinned);
+    }
+  }
+  FinishRound();
+}
+}  // namespace engine::core
@@ -0,0 +1,125 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace engine::core {
+
+// Hierarchical timing wheel over integer ticks.
+//
+// Level L has 64 slots of 64^L ticks each. An entry is placed on the
+// lowest level whose span still separates its due tick from now() and is
+// moved down a level each time the wheel reaches the start of its slot, so
+// it is touched at most once per level. Entries further away than the top
+// level wait in an overflow list which is revisited every 64^kLevels
+// ticks. Advancing by one tick costs O(1) plus the entries which fire or
+// cascade; entries which aren't due are never looked at.
+//
+// Not thread safe.
+template <typename T>
+class TimerWheel {
+ public:
+  // An entry due at or before now() fires on the next Advance.
+  void Schedule(uint64_t due, T value) {
+    size_++;
+    if (due <= now_) {
+      expired_.push_back({due, std::move(value)});
+      return;
+    }
+    Place({due, std::move(value)});
+  }
+
+  // Moves the wheel forward to tick and calls fn(T) for every entry due
+  // up to it, earlier ticks first. An empty wheel jumps there directly.
+  template <typename Function>
+  void Advance(uint64_t tick, Function&& fn);
+
+  [[nodiscard]] uint64_t now() const noexcept { return now_; }
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+
+ private:
+  static constexpr uint32_t kSlotBits = 6;
+  static constexpr uint32_t kSlots = 1u << kSlotBits;
+  static constexpr uint32_t kLevels = 4;
+
+  struct Entry {
+    uint64_t due;
+    T value;
+  };
+
+  // Entries cascaded onto their due tick land in the level 0 slot of
+  // now_, which fires right after the cascade.
+  void Place(Entry entry) {
+    // highest group of slot bits in which due and now differ
+    const uint64_t difference = entry.due ^ now_;
+    uint32_t level = 0;
+    while (level < kLevels && (difference >> (kSlotBits * (level + 1))) != 0) {
+      level++;
+    }
+    if (level == kLevels) {
+      overflow_.push_back(std::move(entry));
+      return;
+    }
+    const size_t slot = (entry.due >> (kSlotBits * level)) & (kSlots - 1);
+    slots_[level * kSlots + slot].push_back(std::move(entry));
+  }
+
+  // Re-places the entries of the list relative to the current now_.
+  void Cascade(std::vector<Entry>& list) {
+    scratch_.swap(list);
+    for (auto& entry : scratch_) {
+      Place(std::move(entry));
+    }
+    scratch_.clear();
+  }
+
+  template <typename Function>
+  void Fire(std::vector<Entry>& list, Function& fn) {
+    scratch_.swap(list);
+    size_ -= scratch_.size();
+    for (auto& entry : scratch_) {
+      fn(std::move(entry.value));
+    }
+    scratch_.clear();
+  }
+
+  std::array<std::vector<Entry>, kSlots * kLevels> slots_;
+  std::vector<Entry> overflow_;
+  std::vector<Entry> expired_;
+  std::vector<Entry> scratch_;
+  uint64_t now_ = 0;
+  size_t size_ = 0;
+};
+
+template <typename T>
+template <typename Function>
+void TimerWheel<T>::Advance(uint64_t tick, Function&& fn) {
+  if (!expired_.empty()) {
+    Fire(expired_, fn);
+  }
+  while (now_ < tick) {
+    if (size_ == 0) {
+      now_ = tick;
+      return;
+    }
+    now_++;
+    if ((now_ & ((uint64_t(1) << (kSlotBits * kLevels)) - 1)) == 0) {
+      Cascade(overflow_);
+    }
+    // higher levels first, their entries may land in a lower level slot
+    // which cascades in this same step
+    for (uint32_t level = kLevels - 1; level > 0; level--) {
+      if ((now_ & ((uint64_t(1) << (kSlotBits * level)) - 1)) == 0) {
+        const size_t slot = (now_ >> (kSlotBits * level)) & (kSlots - 1);
+        Cascade(slots_[level * kSlots + slot]);
+      }
+    }
+    auto& due = slots_[now_ & (kSlots - 1)];
+    if (!due.empty()) {
+      Fire(due, fn);
+    }
+  }
+}
+}  // namespace engine::core
@@ -0,0 +1,337 @@
+#include "TransformStore.h"
+
+#include <bit>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define ENGINE_TRANSFORM_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC compiles AVX2 intrinsics without target flags
+#define ENGINE_TARGET_AVX2
+#else
+#define ENGINE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace engine::core {
+
+namespace {
+struct Arrays {
+  float const* px;
+  float const* py;
+  float const* pz;
+  float const* qx;
+  float const* qy;
+  float const* qz;
+  float const* qw;
+  float const* sx;
+  float const* sy;
+  float const* sz;
+  // 16 floats per transform, column major like glm::mat4
+  float* matrices;
+};
+
+// translation * rotation * scale of transform i
+void BuildScalar(Arrays const& a, size_t i) noexcept {
+  const float x = a.qx[i];
+  const float y = a.qy[i];
+  const float z = a.qz[i];
+  const float w = a.qw[i];
+  const float xx = x * x;
+  const float yy = y * y;
+  const float zz = z * z;
+  const float xy = x * y;
+  const float xz = x * z;
+  const float yz = y * z;
+  const float wx = w * x;
+  const float wy = w * y;
+  const float wz = w * z;
+  float* m = a.matrices + i * 16;
+  m[0] = (1 - 2 * (yy + zz)) * a.sx[i];
+  m[1] = 2 * (xy + wz) * a.sx[i];
+  m[2] = 2 * (xz - wy) * a.sx[i];
+  m[3] = 0;
+  m[4] = 2 * (xy - wz) * a.sy[i];
+  m[5] = (1 - 2 * (xx + zz)) * a.sy[i];
+  m[6] = 2 * (yz + wx) * a.sy[i];
+  m[7] = 0;
+  m[8] = 2 * (xz + wy) * a.sz[i];
+  m[9] = 2 * (yz - wx) * a.sz[i];
+  m[10] = (1 - 2 * (xx + yy)) * a.sz[i];
+  m[11] = 0;
+  m[12] = a.px[i];
+  m[13] = a.py[i];
+  m[14] = a.pz[i];
+  m[15] = 1;
+}
+
+#if defined(ENGINE_TRANSFORM_AVX2)
+bool HasAvx2() noexcept {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuidex(info, 0, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+  __cpuidex(info, 1, 0);
+  // OSXSAVE and the OS saving the YMM registers
+  if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// Writes the 8 vectors, each holding one matrix element of 8 transforms,
+// as 8 consecutive floats of each transform's matrix.
+ENGINE_TARGET_AVX2 void Transpose8(__m256 const (&rows)[8], float* out,
+                                   size_t stride) noexcept {
+  const __m256 t0 = _mm256_unpacklo_ps(rows[0], rows[1]);
+  const __m256 t1 = _mm256_unpackhi_ps(rows[0], rows[1]);
+  const __m256 t2 = _mm256_unpacklo_ps(rows[2], rows[3]);
+  const __m256 t3 = _mm256_unpackhi_ps(rows[2], rows[3]);
+  const __m256 t4 = _mm256_unpacklo_ps(rows[4], rows[5]);
+  const __m256 t5 = _mm256_unpackhi_ps(rows[4], rows[5]);
+  const __m256 t6 = _mm256_unpacklo_ps(rows[6], rows[7]);
+  const __m256 t7 = _mm256_unpackhi_ps(rows[6], rows[7]);
+  const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+  _mm256_storeu_ps(out + 0 * stride, _mm256_permute2f128_ps(s0, s4, 0x20));
+  _mm256_storeu_ps(out + 1 * stride, _mm256_permute2f128_ps(s1, s5, 0x20));
+  _mm256_storeu_ps(out + 2 * stride, _mm256_permute2f128_ps(s2, s6, 0x20));
+  _mm256_storeu_ps(out + 3 * stride, _mm256_permute2f128_ps(s3, s7, 0x20));
+  _mm256_storeu_ps(out + 4 * stride, _mm256_permute2f128_ps(s0, s4, 0x31));
+  _mm256_storeu_ps(out + 5 * stride, _mm256_permute2f128_ps(s1, s5, 0x31));
+  _mm256_storeu_ps(out + 6 * stride, _mm256_permute2f128_ps(s2, s6, 0x31));
+  _mm256_storeu_ps(out + 7 * stride, _mm256_permute2f128_ps(s3, s7, 0x31));
+}
+
+// Rotation matrix entries scaled by s: (1 - 2(a + b)) s, 2(a + b) s and
+// 2(a - b) s.
+ENGINE_TARGET_AVX2 __m256 Diagonal(__m256 a, __m256 b, __m256 s) noexcept {
+  const __m256 twice = _mm256_add_ps(_mm256_add_ps(a, b), _mm256_add_ps(a, b));
+  return _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(1.0F), twice), s);
+}
+ENGINE_TARGET_AVX2 __m256 Sum(__m256 a, __m256 b, __m256 s) noexcept {
+  const __m256 sum = _mm256_add_ps(a, b);
+  return _mm256_mul_ps(_mm256_add_ps(sum, sum), s);
+}
+ENGINE_TARGET_AVX2 __m256 Difference(__m256 a, __m256 b, __m256 s) noexcept {
+  const __m256 difference = _mm256_sub_ps(a, b);
+  return _mm256_mul_ps(_mm256_add_ps(difference, difference), s);
+}
+
+// Transforms [i, i + 8), the arrays are padded to whole groups.
+ENGINE_TARGET_AVX2 void BuildAvx2(Arrays const& a, size_t i) noexcept {
+  const __m256 x = _mm256_loadu_ps(a.qx + i);
+  const __m256 y = _mm256_loadu_ps(a.qy + i);
+  const __m256 z = _mm256_loadu_ps(a.qz + i);
+  const __m256 w = _mm256_loadu_ps(a.qw + i);
+  const __m256 sx = _mm256_loadu_ps(a.sx + i);
+  const __m256 sy = _mm256_loadu_ps(a.sy + i);
+  const __m256 sz = _mm256_loadu_ps(a.sz + i);
+  const __m256 one = _mm256_set1_ps(1.0F);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 xx = _mm256_mul_ps(x, x);
+  const __m256 yy = _mm256_mul_ps(y, y);
+  const __m256 zz = _mm256_mul_ps(z, z);
+  const __m256 xy = _mm256_mul_ps(x, y);
+  const __m256 xz = _mm256_mul_ps(x, z);
+  const __m256 yz = _mm256_mul_ps(y, z);
+  const __m256 wx = _mm256_mul_ps(w, x);
+  const __m256 wy = _mm256_mul_ps(w, y);
+  const __m256 wz = _mm256_mul_ps(w, z);
+  // columns 0 and 1
+  const __m256 low[8] = {Diagonal(yy, zz, sx), Sum(xy, wz, sx),
+                         Difference(xz, wy, sx), zero,
+                         Difference(xy, wz, sy), Diagonal(xx, zz, sy),
+                         Sum(yz, wx, sy), zero};
+  // columns 2 and 3
+  const __m256 high[8] = {Sum(xz, wy, sz),
+                          Difference(yz, wx, sz),
+                          Diagonal(xx, yy, sz),
+                          zero,
+                          _mm256_loadu_ps(a.px + i),
+                          _mm256_loadu_ps(a.py + i),
+                          _mm256_loadu_ps(a.pz + i),
+                          one};
+  float* out = a.matrices + i * 16;
+  Transpose8(low, out, 16);
+  Transpose8(high, out + 8, 16);
+}
+#endif
+}  // namespace
+
+Handle TransformStore::Create(glm::vec3 const& position,
+                              glm::quat const& rotation,
+                              glm::vec3 const& scale) {
+  const auto index = uint32_t(handles_.size());
+  Handle handle = slots_.Allocate(index);
+  handles_.push_back(handle);
+  Reserve(handles_.size());
+  SetPosition(handle, position);
+  SetRotation(handle, rotation);
+  SetScale(handle, scale);
+  return handle;
+}
+
+void TransformStore::Destroy(Handle handle) {
+  if (!slots_.Contains(handle)) {
+    return;
+  }
+  const uint32_t index = IndexOf(handle);
+  const auto last = uint32_t(handles_.size() - 1);
+  const bool last_dirty = (dirty_[last / 64] >> (last % 64)) & 1;
+  dirty_[last / 64] &= ~(uint64_t(1) << (last % 64));
+  if (index != last) {
+    for (auto* array :
+         {&position_x_, &position_y_, &position_z_, &rotation_x_, &rotation_y_,
+          &rotation_z_, &rotation_w_, &scale_x_, &scale_y_, &scale_z_}) {
+      (*array)[index] = (*array)[last];
+    }
+    matrices_[index] = matrices_[last];
+    dirty_[index / 64] &= ~(uint64_t(1) << (index % 64));
+    if (last_dirty) {
+      MarkDirty(index);
+    }
+    handles_[index] = handles_[last];
+    *slots_.Get(handles_[index]) = index;
+  }
+  handles_.pop_back();
+  slots_.Release(handle);
+}
+
+void TransformStore::Clear() {
+  while (!handles_.empty()) {
+    Destroy(handles_.back());
+  }
+}
+
+void TransformStore::Reserve(size_t count) {
+  const size_t padded = (count + kGroup - 1) / kGroup * kGroup;
+  if (padded <= position_x_.size()) {
+    return;
+  }
+  for (auto* array : {&position_x_, &position_y_, &position_z_, &rotation_x_,
+                      &rotation_y_, &rotation_z_}) {
+    array->resize(padded, 0.0F);
+  }
+  for (auto* array : {&rotation_w_, &scale_x_, &scale_y_, &scale_z_}) {
+    array->resize(padded, 1.0F);
+  }
+  matrices_.resize(padded, glm::mat4(1.0F));
+  dirty_.resize((padded + 63) / 64, 0);
+}
+
+glm::vec3 TransformStore::position(Handle handle) const noexcept {
+  const uint32_t i = IndexOf(handle);
+  return glm::vec3(position_x_[i], position_y_[i], position_z_[i]);
+}
+
+glm::quat TransformStore::rotation(Handle handle) const noexcept {
+  const uint32_t i = IndexOf(handle);
+  return glm::quat(rotation_w_[i], rotation_x_[i], rotation_y_[i],
+                   rotation_z_[i]);
+}
+
+glm::vec3 TransformStore::scale(Handle handle) const noexcept {
+  const uint32_t i = IndexOf(handle);
+  return glm::vec3(scale_x_[i], scale_y_[i], scale_z_[i]);
+}
+
+glm::mat4 const& TransformStore::model_matrix(Handle handle) const noexcept {
+  return matrices_[IndexOf(handle)];
+}
+
+bool TransformStore::dirty(Handle handle) const noexcept {
+  const uint32_t i = IndexOf(handle);
+  return ((dirty_[i / 64] >> (i % 64)) & 1) != 0;
+}
+
+void TransformStore::SetPosition(Handle handle,
+                                 glm::vec3 const& position) noexcept {
+  const uint32_t i = IndexOf(handle);
+  position_x_[i] = position.x;
+  position_y_[i] = position.y;
+  position_z_[i] = position.z;
+  MarkDirty(i);
+}
+
+void TransformStore::SetRotation(Handle handle,
+                                 glm::quat const& rotation) noexcept {
+  const uint32_t i = IndexOf(handle);
+  rotation_x_[i] = rotation.x;
+  rotation_y_[i] = rotation.y;
+  rotation_z_[i] = rotation.z;
+  rotation_w_[i] = rotation.w;
+  MarkDirty(i);
+}
+
+void TransformStore::SetScale(Handle handle, glm::vec3 const& scale) noexcept {
+  const uint32_t i = IndexOf(handle);
+  scale_x_[i] = scale.x;
+  scale_y_[i] = scale.y;
+  scale_z_[i] = scale.z;
+  MarkDirty(i);
+}
+
+size_t TransformStore::UpdateMatrices(size_t first, size_t last) {
+  last = std::min(last, size());
+  if (first >= last) {
+    return 0;
+  }
+  static_assert(sizeof(glm::mat4) == 16 * sizeof(float));
+  const Arrays arrays{position_x_.data(), position_y_.data(),
+                      position_z_.data(), rotation_x_.data(),
+                      rotation_y_.data(), rotation_z_.data(),
+                      rotation_w_.data(), scale_x_.data(),
+                      scale_y_.data(),    scale_z_.data(),
+                      &matrices_[0][0][0]};
+#if defined(ENGINE_TRANSFORM_AVX2)
+  static const bool avx2 = HasAvx2();
+#endif
+
+  size_t rebuilt = 0;
+  for (size_t word = first / 64; word * 64 < last; word++) {
+    uint64_t bits = dirty_[word];
+    const size_t base = word * 64;
+    if (last - base < 64) {
+      bits &= (uint64_t(1) << (last - base)) - 1;
+    }
+    if (bits == 0) {
+      continue;
+    }
+    dirty_[word] &= ~bits;
+    while (bits != 0) {
+      // lowest dirty transform and the rest of its group of 8
+      const size_t group = size_t(std::countr_zero(bits)) / kGroup * kGroup;
+      const uint64_t group_bits = (bits >> group) & 0xFF;
+      bits &= ~(uint64_t(0xFF) << group);
+      rebuilt += size_t(std::popcount(group_bits));
+      const size_t i = base + group;
+#if defined(ENGINE_TRANSFORM_AVX2)
+      if (avx2) {
+        // rebuilding the clean ones of the group doesn't change them
+        BuildAvx2(arrays, i);
+        continue;
+      }
+#endif
+      for (uint64_t b = group_bits; b != 0; b &= b - 1) {
+        BuildScalar(arrays, i + size_t(std::countr_zero(b)));
+      }
+    }
+  }
+  return rebuilt;
+}
+}  // namespace engine::core
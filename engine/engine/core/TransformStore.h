@@ -0,0 +1,107 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "HandleTable.h"
+
+namespace engine::core {
+
+// Transforms (position, rotation quaternion and scale) of many objects in
+// structure-of-arrays layout, with one dirty bit per transform.
+//
+// Setters only write the component and set the dirty bit. UpdateMatrices
+// walks the dirty bits a 64-bit word at a time and rebuilds the model
+// matrices (translation * rotation * scale) of the dirty transforms in
+// groups of 8 with an AVX2 kernel, selected at runtime on x86-64. Every
+// other CPU, ARM included, uses the scalar kernel; there is no NEON one.
+// Clean transforms are never touched, so a frame costs one bit test per 64
+// transforms plus the work for the ones which moved. RenderSnapshot builds
+// the published matrices of Objects this way.
+//
+// Transforms are stored densely, destroying one moves the last into its
+// place; handles stay valid. Not thread safe, except that UpdateMatrices
+// may run concurrently over disjoint ranges (e.g. with Core::ParallelFor
+// and a grain of kRangeAlignment).
+class TransformStore {
+ public:
+  // UpdateMatrices ranges have to start at a multiple of this
+  static constexpr size_t kRangeAlignment = 64;
+
+  TransformStore() = default;
+  ~TransformStore() = default;
+
+  /* Disable copy and move semantics. */
+  TransformStore(const TransformStore&) = delete;
+  TransformStore(TransformStore&&) = delete;
+  TransformStore& operator=(const TransformStore&) = delete;
+  TransformStore& operator=(TransformStore&&) = delete;
+
+  Handle Create(glm::vec3 const& position = glm::vec3(0.0F),
+                glm::quat const& rotation = glm::quat(1.0F, 0.0F, 0.0F, 0.0F),
+                glm::vec3 const& scale = glm::vec3(1.0F));
+  // Does nothing for stale handles.
+  void Destroy(Handle handle);
+  // Destroys every transform, the arrays keep their memory.
+  void Clear();
+
+  [[nodiscard]] bool Contains(Handle handle) const noexcept {
+    return slots_.Contains(handle);
+  }
+  [[nodiscard]] size_t size() const noexcept { return handles_.size(); }
+
+  // The handle has to be valid for the accessors and setters below.
+  [[nodiscard]] glm::vec3 position(Handle handle) const noexcept;
+  [[nodiscard]] glm::quat rotation(Handle handle) const noexcept;
+  [[nodiscard]] glm::vec3 scale(Handle handle) const noexcept;
+  // Model matrix as of the last UpdateMatrices.
+  [[nodiscard]] glm::mat4 const& model_matrix(Handle handle) const noexcept;
+  [[nodiscard]] bool dirty(Handle handle) const noexcept;
+
+  void SetPosition(Handle handle, glm::vec3 const& position) noexcept;
+  // rotation should be normalized
+  void SetRotation(Handle handle, glm::quat const& rotation) noexcept;
+  void SetScale(Handle handle, glm::vec3 const& scale) noexcept;
+
+  // Rebuilds the model matrices of every dirty transform and clears their
+  // dirty bits. Returns the number of transforms rebuilt.
+  size_t UpdateMatrices() { return UpdateMatrices(0, size()); }
+  // Same for the dense indices [first, last), first has to be a multiple of
+  // kRangeAlignment.
+  size_t UpdateMatrices(size_t first, size_t last);
+
+ private:
+  // arrays are padded to whole kernel groups
+  static constexpr size_t kGroup = 8;
+
+  [[nodiscard]] uint32_t IndexOf(Handle handle) const noexcept {
+    return *slots_.Get(handle);
+  }
+  void MarkDirty(uint32_t index) noexcept {
+    dirty_[index / 64] |= uint64_t(1) << (index % 64);
+  }
+  // Grows the arrays to hold count transforms, padding with identities.
+  void Reserve(size_t count);
+
+  HandleTable<uint32_t> slots_;
+  // handle of every transform, by dense index
+  std::vector<Handle> handles_;
+
+  std::vector<float> position_x_;
+  std::vector<float> position_y_;
+  std::vector<float> position_z_;
+  std::vector<float> rotation_x_;
+  std::vector<float> rotation_y_;
+  std::vector<float> rotation_z_;
+  std::vector<float> rotation_w_;
+  std::vector<float> scale_x_;
+  std::vector<float> scale_y_;
+  std::vector<float> scale_z_;
+
+  std::vector<uint64_t> dirty_;
+  std::vector<glm::mat4> matrices_;
+};
+}  // namespace engine::core
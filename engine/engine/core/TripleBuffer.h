@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace engine::core {
+
+// Lock-free hand-over of state from one writer thread to one reader
+// thread.
+//
+// Of the three buffers the writer owns one (back), the reader owns one
+// (front) and the third holds the latest published state. Publish and
+// Acquire each swap their buffer with the middle one in a single atomic
+// exchange, so neither side ever waits or sees a buffer the other is
+// using. The buffer the writer gets back is not cleared: it holds an older
+// state, up to the writer to bring up to date.
+template <typename T>
+class TripleBuffer {
+ public:
+  TripleBuffer() = default;
+  ~TripleBuffer() = default;
+
+  /* Disable copy and move semantics. */
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer(TripleBuffer&&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(TripleBuffer&&) = delete;
+
+  // Writer only. Buffer filled for the next Publish.
+  [[nodiscard]] T& back() noexcept { return buffers_[back_]; }
+
+  // Writer only. Makes back() the latest state and hands the writer
+  // another buffer.
+  void Publish() noexcept {
+    back_ = ready_.exchange(back_ | kFresh, std::memory_order_acq_rel) &
+            kIndexMask;
+  }
+
+  // Reader only. Takes the latest published state if there is a new one
+  // and returns it. It stays unchanged until the next Acquire.
+  T const& Acquire() noexcept {
+    if ((ready_.load(std::memory_order_relaxed) & kFresh) != 0) {
+      front_ = ready_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+    }
+    return buffers_[front_];
+  }
+
+  // Reader only. State returned by the last Acquire.
+  [[nodiscard]] T const& front() const noexcept { return buffers_[front_]; }
+
+ private:
+  // set in ready_ until the reader took the published buffer
+  static constexpr uint32_t kFresh = 4;
+  static constexpr uint32_t kIndexMask = 3;
+
+  std::array<T, 3> buffers_{};
+  uint32_t back_ = 0;
+  alignas(64) std::atomic<uint32_t> ready_ = 1;
+  alignas(64) uint32_t front_ = 2;
+};
+}  // namespace engine::core
@@ -0,0 +1,179 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace engine::core {
+
+// Streaming distribution of durations in log-linear buckets: every power
+// of two from 128 ns to 32 s is split into 8 sub-buckets, so a reported
+// percentile is within 12.5% of the exact one. Everything below 128 ns
+// shares bucket 0, everything above 32 s the last bucket.
+//
+// Counts are halved every kDecayPeriod samples, so the distribution
+// follows recent behaviour instead of the whole lifetime.
+//
+// Record must only be called by one thread at a time, readers can run
+// concurrently.
+class LatencyHistogram {
+ public:
+  static constexpr size_t kSubBuckets = 8;
+  static constexpr int kMinExponent = 7;
+  static constexpr int kMaxExponent = 35;
+  static constexpr size_t kBuckets =
+      size_t(kMaxExponent - kMinExponent) * kSubBuckets + 1;
+  static constexpr uint32_t kDecayPeriod = 4096;
+
+  [[nodiscard]] static size_t BucketOf(int64_t ns) noexcept {
+    if (ns < (int64_t(1) << kMinExponent)) {
+      return 0;
+    }
+    int exponent = 63 - CountLeadingZeros(uint64_t(ns));
+    if (exponent >= kMaxExponent) {
+      return kBuckets - 1;
+    }
+    const size_t sub = size_t(ns >> (exponent - 3)) & (kSubBuckets - 1);
+    return 1 + size_t(exponent - kMinExponent) * kSubBuckets + sub;
+  }
+
+  // Middle of the bucket in nanoseconds.
+  [[nodiscard]] static int64_t BucketValue(size_t bucket) noexcept {
+    if (bucket == 0) {
+      return int64_t(1) << (kMinExponent - 1);
+    }
+    const int exponent = kMinExponent + int((bucket - 1) / kSubBuckets);
+    const int64_t sub = int64_t((bucket - 1) % kSubBuckets);
+    const int64_t width = int64_t(1) << (exponent - 3);
+    return (int64_t(kSubBuckets) + sub) * width + width / 2;
+  }
+
+  void Record(int64_t ns) noexcept {
+    auto& count = counts_[BucketOf(ns)];
+    count.store(uint16_t(count.load(std::memory_order_relaxed) + 1),
+                std::memory_order_relaxed);
+    if (++samples_ == kDecayPeriod) {
+      samples_ = 0;
+      for (auto& c : counts_) {
+        c.store(uint16_t(c.load(std::memory_order_relaxed) / 2),
+                std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Adds the counts to counts, which should have kBuckets elements.
+  void AddTo(std::vector<uint64_t>& counts) const {
+    for (size_t i = 0; i < kBuckets; i++) {
+      counts[i] += counts_[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  // q in [0, 1], returns 0 if there are no samples.
+  [[nodiscard]] int64_t Percentile(double q) const {
+    std::vector<uint64_t> counts(kBuckets);
+    AddTo(counts);
+    return Percentile(counts, q);
+  }
+
+  [[nodiscard]] static int64_t Percentile(std::vector<uint64_t> const& counts,
+                                          double q) noexcept {
+    uint64_t total = 0;
+    for (uint64_t count : counts) {
+      total += count;
+    }
+    if (total == 0) {
+      return 0;
+    }
+    const auto rank = uint64_t(q * double(total - 1));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+      seen += counts[i];
+      if (seen > rank) {
+        return BucketValue(i);
+      }
+    }
+    return BucketValue(counts.size() - 1);
+  }
+
+ private:
+  static int CountLeadingZeros(uint64_t value) noexcept {
+    int rv = 0;
+    for (uint64_t bit = uint64_t(1) << 63; (value & bit) == 0; bit >>= 1) {
+      rv++;
+    }
+    return rv;
+  }
+
+  std::array<std::atomic<uint16_t>, kBuckets> counts_{};
+  uint32_t samples_ = 0;
+};
+
+// Execution time statistics of one ticker: an exponentially decayed mean
+// which weights the last ~kMeanWindow updates, the maximum and, once
+// requested, the distribution. The histogram is about 450 bytes, so it is
+// only allocated for tickers that record with distribution set; until then
+// percentiles are 0. Single writer, any number of readers.
+class UpdateStats {
+ public:
+  static constexpr double kMeanWindow = 32;
+
+  UpdateStats() = default;
+  ~UpdateStats() { delete histogram_.load(std::memory_order_relaxed); }
+
+  /* Disable copy and move semantics. */
+  UpdateStats(const UpdateStats&) = delete;
+  UpdateStats(UpdateStats&&) = delete;
+  UpdateStats& operator=(const UpdateStats&) = delete;
+  UpdateStats& operator=(UpdateStats&&) = delete;
+
+  void Record(int64_t ns, bool distribution) noexcept {
+    LatencyHistogram* histogram = histogram_.load(std::memory_order_relaxed);
+    if (histogram == nullptr && distribution) {
+      histogram = new LatencyHistogram();
+      histogram_.store(histogram, std::memory_order_release);
+    }
+    if (histogram != nullptr) {
+      histogram->Record(ns);
+    }
+    const double seconds = double(ns) / 1e9;
+    const double mean = mean_.load(std::memory_order_relaxed);
+    mean_.store(count_ == 0 ? seconds : mean + (seconds - mean) / kMeanWindow,
+                std::memory_order_relaxed);
+    if (ns > max_.load(std::memory_order_relaxed)) {
+      max_.store(ns, std::memory_order_relaxed);
+    }
+    count_++;
+  }
+
+  // Decayed mean in seconds.
+  [[nodiscard]] double mean() const noexcept {
+    return mean_.load(std::memory_order_relaxed);
+  }
+  // Percentile q in [0, 1] of the recent updates in seconds.
+  [[nodiscard]] double percentile(double q) const {
+    LatencyHistogram const* histogram = this->histogram();
+    return histogram != nullptr ? double(histogram->Percentile(q)) / 1e9 : 0;
+  }
+  [[nodiscard]] double p50() const { return percentile(0.5); }
+  [[nodiscard]] double p99() const { return percentile(0.99); }
+  // Longest update so far in seconds.
+  [[nodiscard]] double max() const noexcept {
+    return double(max_.load(std::memory_order_relaxed)) / 1e9;
+  }
+  [[nodiscard]] int64_t max_ns() const noexcept {
+    return max_.load(std::memory_order_relaxed);
+  }
+
+  // nullptr until an update was recorded with distribution set
+  [[nodiscard]] LatencyHistogram const* histogram() const noexcept {
+    return histogram_.load(std::memory_order_acquire);
+  }
+
+ private:
+  std::atomic<LatencyHistogram*> histogram_ = nullptr;
+  std::atomic<double> mean_ = 0;
+  std::atomic<int64_t> max_ = 0;
+  uint64_t count_ = 0;
+};
+}  // namespace engine::core
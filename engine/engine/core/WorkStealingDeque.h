@@ -0,0 +1,139 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+
+namespace engine::core {
+
+// Chase-Lev work-stealing deque.
+// The owning thread pushes and pops items at the bottom end, any other thread
+// may steal items from the top end. Buffers are never freed while the deque is
+// alive, so a thief which loaded an old buffer pointer can still read from it.
+//
+// Only trivially copyable items (pointers, indices) are supported.
+template <typename T>
+class WorkStealingDeque {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "WorkStealingDeque stores items in atomics");
+
+ public:
+  explicit WorkStealingDeque(int64_t capacity = 256) {
+    int64_t c = 1;
+    while (c < capacity) {
+      c <<= 1;
+    }
+    buffers_.push_back(std::make_unique<Buffer>(c));
+    buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+  }
+
+  /* Disable copy and move semantics. */
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque(WorkStealingDeque&&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+
+  // Owner only.
+  void Push(T item) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Buffer* a = buffer_.load(std::memory_order_relaxed);
+    if (b - t > a->capacity - 1) {
+      a = Grow(a, b, t);
+    }
+    a->Put(b, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  // Owner only. Returns false if the deque is empty or the last item was
+  // taken by a thief.
+  [[nodiscard]] bool Pop(T& out) {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Buffer* a = buffer_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    out = a->Get(b);
+    if (t != b) {
+      return true;
+    }
+    // single item left, race against thieves for it
+    bool won = top_.compare_exchange_strong(
+        t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return won;
+  }
+
+  // Any thread. Returns false if the deque is empty or another thread won the
+  // race for the top item; use Empty() to tell these apart.
+  [[nodiscard]] bool Steal(T& out) {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+      return false;
+    }
+    Buffer* a = buffer_.load(std::memory_order_acquire);
+    T item = a->Get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return false;
+    }
+    out = item;
+    return true;
+  }
+
+  [[nodiscard]] bool Empty() const noexcept {
+    int64_t t = top_.load(std::memory_order_relaxed);
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    return b <= t;
+  }
+
+  [[nodiscard]] size_t size() const noexcept {
+    int64_t t = top_.load(std::memory_order_relaxed);
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    return b > t ? size_t(b - t) : 0;
+  }
+
+ private:
+  struct Buffer {
+    explicit Buffer(int64_t c)
+        : capacity(c), mask(c - 1), data(new std::atomic<T>[size_t(c)]) {}
+
+    [[nodiscard]] T Get(int64_t i) const noexcept {
+      return data[size_t(i & mask)].load(std::memory_order_relaxed);
+    }
+    void Put(int64_t i, T item) noexcept {
+      data[size_t(i & mask)].store(item, std::memory_order_relaxed);
+    }
+
+    const int64_t capacity;
+    const int64_t mask;
+    std::unique_ptr<std::atomic<T>[]> data;
+  };
+
+  Buffer* Grow(Buffer* old, int64_t b, int64_t t) {
+    auto grown = std::make_unique<Buffer>(old->capacity * 2);
+    for (int64_t i = t; i < b; i++) {
+      grown->Put(i, old->Get(i));
+    }
+    Buffer* ptr = grown.get();
+    buffers_.push_back(std::move(grown));
+    buffer_.store(ptr, std::memory_order_release);
+    return ptr;
+  }
+
+  alignas(64) std::atomic<int64_t> top_ = 0;
+  alignas(64) std::atomic<int64_t> bottom_ = 0;
+  std::atomic<Buffer*> buffer_ = nullptr;
+
+  // owner only, keeps retired buffers alive for late thieves
+  std::vector<std::unique_ptr<Buffer>> buffers_;
+};
+}  // namespace engine::core
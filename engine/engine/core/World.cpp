@@ -0,0 +1,130 @@
+#include "World.h"
+
+namespace engine::core {
+
+namespace {
+// every live world, for FlushAll; never destroyed, like World::Objects()
+struct Worlds {
+  std::mutex mutex;
+  std::vector<World*> worlds;
+};
+
+Worlds& AllWorlds() {
+  static Worlds* worlds = new Worlds();
+  return *worlds;
+}
+}  // namespace
+
+World::World(std::string name) : name_(std::move(name)) {
+  Worlds& all = AllWorlds();
+  std::scoped_lock<std::mutex> lock(all.mutex);
+  all.worlds.push_back(this);
+}
+
+World::~World() {
+  Worlds& all = AllWorlds();
+  std::scoped_lock<std::mutex> lock(all.mutex);
+  all.worlds.erase(std::find(all.worlds.begin(), all.worlds.end(), this));
+}
+
+World& World::Objects() {
+  // never destroyed, Objects held by other statics may outlive it
+  static World* world = new World("objects");
+  return *world;
+}
+
+void World::Destroy(Entity entity) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  Location const* location = entities_.Get(entity);
+  if (location == nullptr) {
+    return;
+  }
+  RemoveRow(*location, true);
+  {
+    std::scoped_lock<std::mutex> handles_lock(handles_mutex_);
+    entities_.Release(entity);
+  }
+  BumpStructureVersion();
+}
+
+Entity World::Reserve() {
+  std::scoped_lock<std::mutex> lock(handles_mutex_);
+  return entities_.Reserve();
+}
+
+void World::Defer(std::function<void(World&)> command) {
+  std::scoped_lock<std::mutex> lock(commands_mutex_);
+  commands_.push_back(std::move(command));
+}
+
+void World::Flush() {
+  std::vector<std::function<void(World&)>> commands;
+  {
+    std::scoped_lock<std::mutex> lock(commands_mutex_);
+    commands.swap(commands_);
+  }
+  // commands deferred by these run on the next flush
+  for (auto& command : commands) {
+    command(*this);
+  }
+}
+
+void World::FlushAll() {
+  Worlds& all = AllWorlds();
+  std::scoped_lock<std::mutex> lock(all.mutex);
+  for (World* world : all.worlds) {
+    world->Flush();
+  }
+}
+
+Archetype* World::FindArchetype(std::vector<ComponentId> const& ids) {
+  auto it = archetype_index_.find(ids);
+  if (it != archetype_index_.end()) {
+    return it->second;
+  }
+  archetypes_.push_back(std::make_unique<Archetype>(ids));
+  Archetype* archetype = archetypes_.back().get();
+  archetype_index_.emplace(ids, archetype);
+  return archetype;
+}
+
+Archetype* World::Neighbour(Archetype* from, ComponentId id, bool add) {
+  if (Archetype* cached = from->edge(id, add)) {
+    return cached;
+  }
+  std::vector<ComponentId> ids = from->components();
+  auto it = std::lower_bound(ids.begin(), ids.end(), id);
+  if (add) {
+    ids.insert(it, id);
+  } else {
+    ids.erase(it);
+  }
+  Archetype* to = FindArchetype(ids);
+  from->SetEdge(id, add, to);
+  to->SetEdge(id, !add, from);
+  return to;
+}
+
+void World::MoveEntity(Entity entity, Location& location, Archetype* to) {
+  Archetype* from = location.archetype;
+  const uint32_t row = to->Append(entity);
+  for (size_t column = 0; column < from->components().size(); column++) {
+    void* component = from->component(location.row, column);
+    const size_t to_column = to->column(from->components()[column]);
+    if (to_column == Archetype::kNoColumn) {
+      from->info(column).destroy(component);
+    } else {
+      from->info(column).relocate(to->component(row, to_column), component);
+    }
+  }
+  RemoveRow(location, false);
+  location = {to, row};
+}
+
+void World::RemoveRow(Location const& location, bool destroy) {
+  const Entity moved = location.archetype->Remove(location.row, destroy);
+  if (moved.valid()) {
+    entities_.Get(moved)->row = location.row;
+  }
+}
+}  // namespace engine::core
@@ -0,0 +1,442 @@
+#pragma once
+#include <map>
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <tuple>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <shared_mutex>
+#include <type_traits>
+
+#include "Archetype.h"
+#include "Component.h"
+#include "HandleTable.h"
+#include "engine/Core.h"
+
+namespace engine::core {
+
+// Entity of a World, generation checked like every other Handle.
+using Entity = Handle;
+
+// Hook called with every component a query or system took as non-const,
+// after fn returned for its entity. Specialize it with kEnabled = true for
+// components whose writes have to be reported, e.g. to a render snapshot;
+// Report runs concurrently for different entities.
+template <typename T>
+struct ComponentWritten {
+  static constexpr bool kEnabled = false;
+  static void Report(Entity /*entity*/, T& /*component*/) {}
+};
+
+// Archetype based entity-component store.
+//
+// An entity is a row of the archetype matching its exact set of component
+// types. Queries visit the archetypes containing all requested components
+// chunk by chunk, so iterating a million entities walks a few arrays per
+// chunk instead of making a virtual call and chasing a pointer per object.
+// Adding or removing a component moves the entity to the neighbouring
+// archetype, found through edges cached on the archetypes.
+//
+// Systems are tickers running a query over the update threads. Each one
+// is registered as a Core system reading the components it takes as const
+// and writing the others, so the task graph orders conflicting systems and
+// runs independent ones in parallel.
+//
+// Structural changes (Create, Destroy, Add, Remove) lock the world
+// exclusively and queries lock it shared for their whole run. Code running
+// inside a query, systems included, must not change the structure and
+// calls Defer instead. The Core flushes the deferred commands of every
+// world at the tick boundary, while the update threads are parked, so a
+// world changed only through Defer (like Objects()) keeps its structure
+// for the whole tick and update threads may use Get pointers without
+// locking. Get and Has don't lock and must not race with structural
+// changes; structure_version() tells when pointers may have moved.
+class World {
+ public:
+  explicit World(std::string name);
+  ~World();
+
+  /* Disable copy and move semantics. */
+  World(const World&) = delete;
+  World(World&&) = delete;
+  World& operator=(const World&) = delete;
+  World& operator=(World&&) = delete;
+
+  // World holding the state of every Object.
+  [[nodiscard]] static World& Objects();
+
+  [[nodiscard]] std::string const& name() const noexcept { return name_; }
+
+  // Creates an entity with the given components, of distinct types.
+  template <typename... Ts>
+  Entity Create(Ts... components);
+  // Reserves the handle of an entity created later with CreateReserved,
+  // usually from a deferred command. Thread safe; doesn't lock the world,
+  // so queries may call it. Get returns nullptr for the handle until then.
+  [[nodiscard]] Entity Reserve();
+  // Creates a reserved entity. Every reserved handle has to be created
+  // exactly once.
+  template <typename... Ts>
+  void CreateReserved(Entity entity, Ts... components);
+  // Destroys the entity and its components. Does nothing for stale
+  // handles.
+  void Destroy(Entity entity);
+
+  [[nodiscard]] bool Contains(Entity entity) const noexcept {
+    return entities_.Contains(entity);
+  }
+  [[nodiscard]] size_t size() const noexcept { return entities_.size(); }
+
+  // Adds the component, or replaces it if the entity already has one.
+  // Returns nullptr for stale handles.
+  template <typename T>
+  T* Add(Entity entity, T component);
+  // Returns false for stale handles and entities without the component.
+  template <typename T>
+  bool Remove(Entity entity);
+
+  // Returns nullptr for stale handles and entities without the component.
+  // The pointer is valid until the next structural change, i.e. while
+  // structure_version() stays the same.
+  template <typename T>
+  [[nodiscard]] T* Get(Entity entity) noexcept;
+  template <typename T>
+  [[nodiscard]] bool Has(Entity entity) const noexcept;
+
+  // Calls fn(count, entities, Ts*...) for every chunk of entities having
+  // all of Ts; each pointer points to count elements. Components taken as
+  // const are only read.
+  template <typename... Ts, typename Function>
+  void ForEachChunk(Function&& fn);
+  // ForEachChunk for callers already holding mutex().
+  template <typename... Ts, typename Function>
+  void ForEachChunkLocked(Function&& fn);
+  // Calls fn(Ts&...) for every entity having all of Ts, then reports the
+  // components taken as non-const to their ComponentWritten hooks.
+  // ForEachChunk and Get leave that to the caller.
+  template <typename... Ts, typename Function>
+  void ForEach(Function&& fn);
+  // ForEach with the chunks spread over the update threads by
+  // Core::ParallelFor, fn is called concurrently for different entities.
+  template <typename... Ts, typename Function>
+  void ParallelForEach(Function&& fn);
+
+  // Queues a structural change made from a query or from another thread.
+  // Thread safe.
+  void Defer(std::function<void(World&)> command);
+  // Runs the deferred commands. Must not be called from a query; the Core
+  // calls it at every tick boundary, a world used without a running Core
+  // has to be flushed by its owner.
+  void Flush();
+  // Flushes every world. Called by the Core at the tick boundary; commands
+  // must not create or destroy worlds.
+  static void FlushAll();
+
+  // Bumped by every structural change.
+  [[nodiscard]] uint64_t structure_version() const noexcept {
+    return structure_version_.load(std::memory_order_acquire);
+  }
+
+  /// <summary>
+  /// Adds a system calling fn(Ts&...) for every entity having all of Ts,
+  /// spread over the update threads, every tickrate ticks. The system
+  /// reads the components taken as const and writes the others; it starts
+  /// after the earlier systems it conflicts with. The world owns the
+  /// system ticker.
+  /// </summary>
+  /// <param name="name">Core system name, has to be unique</param>
+  /// <param name="tickrate">ticks between runs</param>
+  /// <param name="fn">called concurrently for different entities</param>
+  /// <returns>the system ticker or nullptr if the name is taken</returns>
+  template <typename... Ts, typename Function>
+  std::shared_ptr<Ticker> AddSystem(std::string const& name,
+                                    uint32_t tickrate, Function fn);
+
+  // Shared lock for code outside queries which reads or writes components
+  // through Get while other threads may change the structure.
+  [[nodiscard]] std::shared_mutex& mutex() noexcept { return mutex_; }
+
+  // Resource name of component T in the system descs of this world, for
+  // systems touching T without going through AddSystem.
+  template <typename T>
+  [[nodiscard]] std::string ResourceName() const;
+
+ private:
+  struct Location {
+    Archetype* archetype = nullptr;
+    uint32_t row = 0;
+  };
+  // sorted ids of Ts, built once per set of types
+  template <typename... Ts>
+  [[nodiscard]] static std::vector<ComponentId> const& SortedIds();
+  // Returns the archetype with exactly these sorted components, creating
+  // it if needed.
+  [[nodiscard]] Archetype* FindArchetype(std::vector<ComponentId> const& ids);
+  // Archetype of from with the component added or removed.
+  [[nodiscard]] Archetype* Neighbour(Archetype* from, ComponentId id,
+                                     bool add);
+  // Moves the row of the entity to the archetype to, relocating the
+  // components both have and destroying the others. location is updated.
+  void MoveEntity(Entity entity, Location& location, Archetype* to);
+  // Removes the row and fixes the location of the entity moved into it.
+  void RemoveRow(Location const& location, bool destroy);
+  // Called with mutex() held exclusively.
+  void BumpStructureVersion() noexcept {
+    structure_version_.fetch_add(1, std::memory_order_release);
+  }
+
+  // Reports the components of the entity its fn call may have written.
+  template <typename... Ts>
+  static void ReportWritten(Entity entity, Ts&... components) {
+    (ReportWrite(entity, components), ...);
+  }
+  template <typename T>
+  static void ReportWrite(Entity entity, T& component) {
+    if constexpr (!std::is_const_v<T> && ComponentWritten<T>::kEnabled) {
+      ComponentWritten<T>::Report(entity, component);
+    }
+  }
+
+  template <typename... Ts, typename Function, size_t... I>
+  static void VisitChunk(Archetype& archetype, size_t chunk,
+                         std::array<size_t, sizeof...(Ts)> const& columns,
+                         Function& fn, std::index_sequence<I...>) {
+    fn(archetype.chunk_size(chunk), archetype.entities(chunk),
+       static_cast<Ts*>(archetype.column_data(chunk, columns[I]))...);
+  }
+  // Columns of Ts in the archetype, false if it lacks any of them.
+  template <typename... Ts>
+  [[nodiscard]] static bool Columns(Archetype const& archetype,
+                                    std::array<size_t, sizeof...(Ts)>& out) {
+    out = {archetype.column(ComponentTypeId<std::remove_const_t<Ts>>())...};
+    return std::find(out.begin(), out.end(), Archetype::kNoColumn) ==
+           out.end();
+  }
+
+  const std::string name_;
+  std::shared_mutex mutex_;
+  std::atomic<uint64_t> structure_version_ = 0;
+  // taken by Reserve and by every change of the slots of entities_, on top
+  // of mutex_ for the latter
+  std::mutex handles_mutex_;
+  HandleTable<Location> entities_;
+  std::vector<std::unique_ptr<Archetype>> archetypes_;
+  std::map<std::vector<ComponentId>, Archetype*> archetype_index_;
+
+  std::mutex commands_mutex_;
+  std::vector<std::function<void(World&)>> commands_;
+
+  std::mutex systems_mutex_;
+  // system tickers, the Core drops a ticker once no one else holds it
+  std::vector<std::shared_ptr<Ticker>> systems_;
+};
+
+// Ticker running the query of a system added with World::AddSystem.
+template <typename Function, typename... Ts>
+class WorldSystem final : public Ticker {
+ public:
+  WorldSystem(World& world, uint32_t tickrate, SystemId system, Function fn)
+      : Ticker(tickrate), world_(world), fn_(std::move(fn)) {
+    SetSystem(system);
+  }
+
+  void Update(const uint64_t /*tick*/) override {
+    world_.ParallelForEach<Ts...>(fn_);
+  }
+
+ private:
+  World& world_;
+  Function fn_;
+};
+
+template <typename... Ts>
+std::vector<ComponentId> const& World::SortedIds() {
+  static const std::vector<ComponentId> ids = [] {
+    std::vector<ComponentId> sorted{ComponentTypeId<Ts>()...};
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+  }();
+  return ids;
+}
+
+template <typename T>
+std::string World::ResourceName() const {
+  return name_ + "/" + GetComponentInfo(ComponentTypeId<T>()).name;
+}
+
+template <typename... Ts>
+Entity World::Create(Ts... components) {
+  const Entity entity = Reserve();
+  CreateReserved(entity, std::move(components)...);
+  return entity;
+}
+
+template <typename... Ts>
+void World::CreateReserved(Entity entity, Ts... components) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  Archetype* archetype = FindArchetype(SortedIds<Ts...>());
+  const uint32_t row = archetype->Append(entity);
+  {
+    std::scoped_lock<std::mutex> handles_lock(handles_mutex_);
+    entities_.Emplace(entity, {archetype, row});
+  }
+  (new (archetype->component(row, archetype->column(ComponentTypeId<Ts>())))
+       Ts(std::move(components)),
+   ...);
+  BumpStructureVersion();
+}
+
+template <typename T>
+T* World::Add(Entity entity, T component) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  Location* location = entities_.Get(entity);
+  if (location == nullptr) {
+    return nullptr;
+  }
+  const ComponentId id = ComponentTypeId<T>();
+  const size_t column = location->archetype->column(id);
+  if (column != Archetype::kNoColumn) {
+    T* existing =
+        static_cast<T*>(location->archetype->component(location->row, column));
+    *existing = std::move(component);
+    return existing;
+  }
+  Archetype* to = Neighbour(location->archetype, id, true);
+  MoveEntity(entity, *location, to);
+  BumpStructureVersion();
+  return new (to->component(location->row, to->column(id)))
+      T(std::move(component));
+}
+
+template <typename T>
+bool World::Remove(Entity entity) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  Location* location = entities_.Get(entity);
+  const ComponentId id = ComponentTypeId<T>();
+  if (location == nullptr ||
+      location->archetype->column(id) == Archetype::kNoColumn) {
+    return false;
+  }
+  MoveEntity(entity, *location, Neighbour(location->archetype, id, false));
+  BumpStructureVersion();
+  return true;
+}
+
+template <typename T>
+T* World::Get(Entity entity) noexcept {
+  Location const* location = entities_.Get(entity);
+  if (location == nullptr) {
+    return nullptr;
+  }
+  const size_t column = location->archetype->column(ComponentTypeId<T>());
+  return column == Archetype::kNoColumn
+             ? nullptr
+             : static_cast<T*>(
+                   location->archetype->component(location->row, column));
+}
+
+template <typename T>
+bool World::Has(Entity entity) const noexcept {
+  Location const* location = entities_.Get(entity);
+  return location != nullptr && location->archetype->column(
+                                    ComponentTypeId<T>()) !=
+                                    Archetype::kNoColumn;
+}
+
+template <typename... Ts, typename Function>
+void World::ForEachChunk(Function&& fn) {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  ForEachChunkLocked<Ts...>(fn);
+}
+
+template <typename... Ts, typename Function>
+void World::ForEachChunkLocked(Function&& fn) {
+  std::array<size_t, sizeof...(Ts)> columns;
+  for (auto& archetype : archetypes_) {
+    if (archetype->size() == 0 || !Columns<Ts...>(*archetype, columns)) {
+      continue;
+    }
+    for (size_t chunk = 0; chunk < archetype->chunk_count(); chunk++) {
+      VisitChunk<Ts...>(*archetype, chunk, columns, fn,
+                        std::index_sequence_for<Ts...>());
+    }
+  }
+}
+
+template <typename... Ts, typename Function>
+void World::ForEach(Function&& fn) {
+  ForEachChunk<Ts...>(
+      [&fn](size_t count, Entity const* entities, Ts*... arrays) {
+        for (size_t i = 0; i < count; i++) {
+          fn(arrays[i]...);
+          ReportWritten<Ts...>(entities[i], arrays[i]...);
+        }
+      });
+}
+
+template <typename... Ts, typename Function>
+void World::ParallelForEach(Function&& fn) {
+  struct Item {
+    Archetype* archetype;
+    size_t chunk;
+    std::array<size_t, sizeof...(Ts)> columns;
+  };
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  std::vector<Item> items;
+  std::array<size_t, sizeof...(Ts)> columns;
+  for (auto& archetype : archetypes_) {
+    if (archetype->size() == 0 || !Columns<Ts...>(*archetype, columns)) {
+      continue;
+    }
+    for (size_t chunk = 0; chunk < archetype->chunk_count(); chunk++) {
+      items.push_back({archetype.get(), chunk, columns});
+    }
+  }
+  auto per_chunk = [&fn](size_t count, Entity const* entities,
+                         Ts*... arrays) {
+    for (size_t i = 0; i < count; i++) {
+      fn(arrays[i]...);
+      ReportWritten<Ts...>(entities[i], arrays[i]...);
+    }
+  };
+  // a chunk is kChunkBytes of components, enough work to be worth a claim
+  Core::GetInstance()->ParallelFor(
+      items.size(), 1, [&items, &per_chunk](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+          VisitChunk<Ts...>(*items[i].archetype, items[i].chunk,
+                            items[i].columns, per_chunk,
+                            std::index_sequence_for<Ts...>());
+        }
+      });
+}
+
+template <typename... Ts, typename Function>
+std::shared_ptr<Ticker> World::AddSystem(std::string const& name,
+                                         uint32_t tickrate, Function fn) {
+  SystemDesc desc;
+  desc.name = name;
+  ((std::is_const_v<Ts> ? desc.reads : desc.writes)
+       .push_back(ResourceName<std::remove_const_t<Ts>>()),
+   ...);
+  auto core = Core::GetInstance();
+  const SystemId id = core->RegisterSystem(desc);
+  if (id == TaskGraph::kInvalidSystem) {
+    return nullptr;
+  }
+  auto system = std::make_shared<WorldSystem<Function, Ts...>>(
+      *this, tickrate, id, std::move(fn));
+  {
+    std::scoped_lock<std::mutex> lock(systems_mutex_);
+    systems_.push_back(system);
+  }
+  core->AddTickingObject(system);
+  return system;
+}
+}  // namespace engine::core
@@ -0,0 +1,37 @@
+#include "pch.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine/core/Affinity.h"
+
+using engine::core::kMaxCpus;
+using engine::core::ParseCpuList;
+
+TEST(AffinityTest, ParsesSinglesAndRanges) {
+  EXPECT_EQ(ParseCpuList("0-3,8,10-11"),
+            (std::vector<uint32_t>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(ParseCpuList(" 2 , 5-5\n"), (std::vector<uint32_t>{2, 5}));
+  EXPECT_TRUE(ParseCpuList("").empty());
+}
+
+TEST(AffinityTest, SkipsMalformedEntries) {
+  EXPECT_EQ(ParseCpuList("a,1,2-,-3,4-b,5x,6"),
+            (std::vector<uint32_t>{1, 6}));
+}
+
+TEST(AffinityTest, SkipsReversedRanges) {
+  EXPECT_EQ(ParseCpuList("7-3,1"), (std::vector<uint32_t>{1}));
+}
+
+TEST(AffinityTest, SkipsCpusPastTheLimit) {
+  // a range ending at UINT32_MAX used to wrap around and never finish
+  EXPECT_EQ(ParseCpuList("0-4294967295,1"), (std::vector<uint32_t>{1}));
+  EXPECT_EQ(ParseCpuList("4294967295,99999999999,2"),
+            (std::vector<uint32_t>{2}));
+  const auto all = ParseCpuList("0-" + std::to_string(kMaxCpus - 1));
+  ASSERT_EQ(all.size(), kMaxCpus);
+  EXPECT_EQ(all.back(), kMaxCpus - 1);
+  EXPECT_TRUE(ParseCpuList(std::to_string(kMaxCpus)).empty());
+}
\ No newline at end of file
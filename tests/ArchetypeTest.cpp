@@ -0,0 +1,221 @@
+#include "pch.h"
+
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "engine/core/Archetype.h"
+#include "engine/core/World.h"
+
+using engine::core::Archetype;
+using engine::core::ComponentTypeId;
+using engine::core::Entity;
+using engine::core::Handle;
+using engine::core::World;
+
+namespace {
+struct Position {
+  float x = 0.0F;
+};
+struct Velocity {
+  float x = 0.0F;
+};
+// not trivially relocatable, and counts its live copies through the
+// shared_ptr
+struct Name {
+  std::string value;
+  std::shared_ptr<int> lifetime;
+};
+
+Position& PositionAt(Archetype& archetype, uint32_t row) {
+  return *static_cast<Position*>(
+      archetype.component(row, archetype.column(ComponentTypeId<Position>())));
+}
+}  // namespace
+
+TEST(ArchetypeTest, RemoveMovesLastRowIntoPlace) {
+  Archetype archetype({ComponentTypeId<Position>()});
+  EXPECT_EQ(archetype.column(ComponentTypeId<Velocity>()),
+            Archetype::kNoColumn);
+  for (uint32_t i = 0; i < 3; i++) {
+    const uint32_t row = archetype.Append(Handle{i, 0});
+    new (&PositionAt(archetype, row)) Position{float(i)};
+  }
+  EXPECT_EQ(archetype.Remove(0, true), (Handle{2, 0}));
+  EXPECT_EQ(archetype.size(), 2U);
+  EXPECT_EQ(archetype.entity(0), (Handle{2, 0}));
+  EXPECT_EQ(PositionAt(archetype, 0).x, 2.0F);
+  // the last row moves nothing
+  EXPECT_FALSE(archetype.Remove(1, true).valid());
+  EXPECT_EQ(archetype.size(), 1U);
+}
+
+TEST(ArchetypeTest, RowsSpillIntoChunks) {
+  Archetype archetype({ComponentTypeId<Position>()});
+  const size_t capacity = archetype.chunk_capacity();
+  ASSERT_GT(capacity, 0U);
+  for (uint32_t i = 0; i <= capacity; i++) {
+    const uint32_t row = archetype.Append(Handle{i, 0});
+    new (&PositionAt(archetype, row)) Position{float(i)};
+  }
+  EXPECT_EQ(archetype.chunk_count(), 2U);
+  EXPECT_EQ(archetype.chunk_size(0), capacity);
+  EXPECT_EQ(archetype.chunk_size(1), 1U);
+  EXPECT_EQ(PositionAt(archetype, uint32_t(capacity)).x, float(capacity));
+}
+
+TEST(ArchetypeTest, AddAndRemoveRelocateComponents) {
+  World world("archetype_test");
+  auto lifetime = std::make_shared<int>(0);
+  const Entity first = world.Create(Position{1.0F}, Name{"first", lifetime});
+  const Entity second = world.Create(Position{2.0F}, Name{"second", lifetime});
+  EXPECT_EQ(lifetime.use_count(), 3);
+
+  // moves first to another archetype, second takes its row
+  ASSERT_NE(world.Add(first, Velocity{5.0F}), nullptr);
+  EXPECT_EQ(world.Get<Position>(first)->x, 1.0F);
+  EXPECT_EQ(world.Get<Name>(first)->value, "first");
+  EXPECT_EQ(world.Get<Velocity>(first)->x, 5.0F);
+  EXPECT_EQ(world.Get<Name>(second)->value, "second");
+  EXPECT_FALSE(world.Has<Velocity>(second));
+  EXPECT_EQ(lifetime.use_count(), 3);
+
+  // replacing keeps the archetype
+  const uint64_t version = world.structure_version();
+  world.Add(first, Velocity{6.0F});
+  EXPECT_EQ(world.Get<Velocity>(first)->x, 6.0F);
+  EXPECT_EQ(world.structure_version(), version);
+
+  EXPECT_TRUE(world.Remove<Name>(first));
+  EXPECT_FALSE(world.Remove<Name>(first));
+  EXPECT_EQ(world.Get<Name>(first), nullptr);
+  EXPECT_EQ(world.Get<Position>(first)->x, 1.0F);
+  EXPECT_EQ(lifetime.use_count(), 2);
+  EXPECT_GT(world.structure_version(), version);
+
+  world.Destroy(second);
+  EXPECT_FALSE(world.Contains(second));
+  EXPECT_EQ(world.Get<Position>(second), nullptr);
+  EXPECT_EQ(world.Add(second, Velocity{}), nullptr);
+  EXPECT_EQ(lifetime.use_count(), 1);
+  EXPECT_EQ(world.size(), 1U);
+}
+
+TEST(ArchetypeTest, QueriesVisitMatchingEntities) {
+  World world("archetype_test");
+  for (int i = 0; i < 1000; i++) {
+    if (i % 4 == 0) {
+      world.Create(Position{float(i)}, Velocity{1.0F});
+    } else {
+      world.Create(Position{float(i)});
+    }
+  }
+  size_t moved = 0;
+  world.ForEach<Position, const Velocity>(
+      [&](Position& position, Velocity const& velocity) {
+        position.x += velocity.x;
+        moved++;
+      });
+  EXPECT_EQ(moved, 250U);
+  size_t visited = 0;
+  float sum = 0.0F;
+  world.ForEachChunk<const Position>(
+      [&](size_t count, Handle const* entities, Position const* positions) {
+        for (size_t i = 0; i < count; i++) {
+          EXPECT_EQ(world.Get<Position>(entities[i]), &positions[i]);
+          sum += positions[i].x;
+        }
+        visited += count;
+      });
+  EXPECT_EQ(visited, 1000U);
+  EXPECT_EQ(sum, 999.0F * 1000.0F / 2.0F + 250.0F);
+}
+
+TEST(ArchetypeTest, DeferredCommandsRunOnFlush) {
+  World world("archetype_test");
+  const Entity reserved = world.Reserve();
+  world.Defer([reserved](World& target) {
+    target.CreateReserved(reserved, Position{3.0F});
+  });
+  EXPECT_EQ(world.Get<Position>(reserved), nullptr);
+  world.Flush();
+  ASSERT_NE(world.Get<Position>(reserved), nullptr);
+  EXPECT_EQ(world.Get<Position>(reserved)->x, 3.0F);
+
+  // structural changes from a query are deferred
+  world.ForEach<Position>([&](Position& /*position*/) {
+    world.Defer([reserved](World& target) { target.Destroy(reserved); });
+  });
+  EXPECT_TRUE(world.Contains(reserved));
+  World::FlushAll();
+  EXPECT_FALSE(world.Contains(reserved));
+}
+
+TEST(ArchetypeTest, RandomChangesMatchReference) {
+  World world("archetype_test");
+  struct Expected {
+    bool position;
+    bool velocity;
+    float x;
+    std::string name;
+  };
+  std::unordered_map<uint32_t, Expected> expected;
+  std::vector<Entity> entities;
+  std::mt19937 random(3);
+  for (int i = 0; i < 20000; i++) {
+    const uint32_t roll = random() % 10;
+    if (roll < 5 || entities.empty()) {
+      const std::string name = "entity " + std::to_string(i);
+      Entity entity;
+      if (random() % 2 == 0) {
+        entity = world.Create(Position{float(i)}, Name{name, nullptr});
+        expected[entity.index] = {true, false, float(i), name};
+      } else {
+        entity = world.Create(Name{name, nullptr});
+        expected[entity.index] = {false, false, 0.0F, name};
+      }
+      entities.push_back(entity);
+      continue;
+    }
+    const size_t picked = random() % entities.size();
+    const Entity entity = entities[picked];
+    Expected& state = expected[entity.index];
+    switch (roll) {
+      case 5:
+        world.Destroy(entity);
+        expected.erase(entity.index);
+        entities[picked] = entities.back();
+        entities.pop_back();
+        break;
+      case 6:
+      case 7:
+        world.Add(entity, Velocity{1.0F});
+        state.velocity = true;
+        break;
+      case 8:
+        EXPECT_EQ(world.Remove<Velocity>(entity), state.velocity);
+        state.velocity = false;
+        break;
+      default:
+        world.Add(entity, Position{float(-i)});
+        state.position = true;
+        state.x = float(-i);
+        break;
+    }
+  }
+  EXPECT_EQ(world.size(), entities.size());
+  for (Entity entity : entities) {
+    Expected const& state = expected.at(entity.index);
+    Position const* position = world.Get<Position>(entity);
+    ASSERT_EQ(position != nullptr, state.position);
+    if (position != nullptr) {
+      EXPECT_EQ(position->x, state.x);
+    }
+    EXPECT_EQ(world.Has<Velocity>(entity), state.velocity);
+    ASSERT_NE(world.Get<Name>(entity), nullptr);
+    EXPECT_EQ(world.Get<Name>(entity)->value, state.name);
+  }
+}
@@ -0,0 +1,85 @@
+#include "pch.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "engine/core/FrameAllocator.h"
+
+using engine::core::FrameAllocator;
+using engine::core::FrameAllocatorAdapter;
+
+TEST(FrameAllocatorTest, HonorsAlignment) {
+  FrameAllocator allocator(1024);
+  for (size_t alignment = 1; alignment <= 256; alignment *= 2) {
+    // an odd sized allocation in between misaligns the bump pointer
+    (void)allocator.Allocate(3, 1);
+    void* pointer = allocator.Allocate(8, alignment);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(pointer) % alignment, 0U)
+        << "alignment " << alignment;
+  }
+  auto* value = allocator.New<double>(2.5);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(value) % alignof(double), 0U);
+  EXPECT_EQ(*value, 2.5);
+}
+
+TEST(FrameAllocatorTest, OverflowsIntoNewBlocks) {
+  FrameAllocator allocator(64);
+  EXPECT_EQ(allocator.capacity(), 0U);
+  std::vector<uint32_t*> arrays;
+  for (uint32_t i = 0; i < 20; i++) {
+    arrays.push_back(allocator.NewArray<uint32_t>(8));
+    EXPECT_EQ(arrays.back()[0], 0U);
+    for (uint32_t j = 0; j < 8; j++) {
+      arrays.back()[j] = i;
+    }
+  }
+  EXPECT_EQ(allocator.used(), 20 * 8 * sizeof(uint32_t));
+  EXPECT_GE(allocator.capacity(), allocator.used());
+  // earlier blocks stay valid after the arena grew
+  for (uint32_t i = 0; i < 20; i++) {
+    for (uint32_t j = 0; j < 8; j++) {
+      ASSERT_EQ(arrays[i][j], i);
+    }
+  }
+  // larger than any block so far
+  auto* big = static_cast<std::byte*>(allocator.Allocate(100000, 64));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(big) % 64, 0U);
+  std::memset(big, 1, 100000);
+}
+
+TEST(FrameAllocatorTest, ResetReusesOneMergedBlock) {
+  FrameAllocator allocator(64);
+  for (int i = 0; i < 10; i++) {
+    (void)allocator.Allocate(48);
+  }
+  const size_t used = allocator.used();
+  const size_t capacity = allocator.capacity();
+  allocator.Reset();
+  EXPECT_EQ(allocator.used(), 0U);
+  EXPECT_EQ(allocator.high_water(), used);
+  // the blocks are merged into one of their combined size
+  EXPECT_EQ(allocator.capacity(), capacity);
+  void* first = allocator.Allocate(48);
+  for (int i = 1; i < 10; i++) {
+    (void)allocator.Allocate(48);
+  }
+  EXPECT_EQ(allocator.capacity(), capacity);
+  // the next tick starts again at the front of the same block
+  allocator.Reset();
+  EXPECT_EQ(allocator.Allocate(48), first);
+  EXPECT_EQ(allocator.capacity(), capacity);
+}
+
+TEST(FrameAllocatorTest, AdapterBacksStandardContainers) {
+  FrameAllocator allocator(256);
+  std::vector<int, FrameAllocatorAdapter<int>> values{
+      FrameAllocatorAdapter<int>(allocator)};
+  for (int i = 0; i < 1000; i++) {
+    values.push_back(i);
+  }
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(values[i], i);
+  }
+  EXPECT_GE(allocator.used(), 1000 * sizeof(int));
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "pch.h"
+
+#include "engine/core/HandleTable.h"
+
+using engine::core::Handle;
+using engine::core::HandleTable;
+
+TEST(HandleTableTest, AllocateGetRelease) {
+  HandleTable<int> table;
+  const Handle first = table.Allocate(1);
+  const Handle second = table.Allocate(2);
+  ASSERT_TRUE(first.valid());
+  EXPECT_NE(first, second);
+  EXPECT_EQ(table.size(), 2U);
+  ASSERT_NE(table.Get(first), nullptr);
+  EXPECT_EQ(*table.Get(first), 1);
+  EXPECT_EQ(*table.Get(second), 2);
+
+  table.Release(first);
+  EXPECT_FALSE(table.Contains(first));
+  EXPECT_EQ(table.Get(first), nullptr);
+  EXPECT_EQ(table.size(), 1U);
+  // stale handles are ignored
+  table.Release(first);
+  EXPECT_EQ(table.size(), 1U);
+}
+
+TEST(HandleTableTest, ReusedSlotDoesNotAliasStaleHandle) {
+  HandleTable<int> table;
+  const Handle stale = table.Allocate(1);
+  table.Release(stale);
+  const Handle reused = table.Allocate(2);
+  EXPECT_EQ(reused.index, stale.index);
+  EXPECT_NE(reused.generation, stale.generation);
+  EXPECT_EQ(table.Get(stale), nullptr);
+  ASSERT_NE(table.Get(reused), nullptr);
+  EXPECT_EQ(*table.Get(reused), 2);
+}
+
+TEST(HandleTableTest, ReservedHandleIsEmptyUntilEmplaced) {
+  HandleTable<int> table;
+  const Handle reserved = table.Reserve();
+  const Handle allocated = table.Allocate(1);
+  EXPECT_NE(reserved.index, allocated.index);
+  EXPECT_FALSE(table.Contains(reserved));
+  EXPECT_EQ(table.size(), 1U);
+
+  table.Emplace(reserved, 7);
+  ASSERT_TRUE(table.Contains(reserved));
+  EXPECT_EQ(*table.Get(reserved), 7);
+  EXPECT_EQ(*table.Get(allocated), 1);
+  EXPECT_EQ(table.size(), 2U);
+}
+
+TEST(HandleTableTest, DefaultHandleIsInvalid) {
+  HandleTable<int> table;
+  table.Allocate(1);
+  EXPECT_FALSE(Handle().valid());
+  EXPECT_FALSE(table.Contains(Handle()));
+}
@@ -0,0 +1,90 @@
+#include "pch.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "engine/core/MpscQueue.h"
+
+using engine::core::MpscQueue;
+
+TEST(MpscQueueTest, PopsInPushOrder) {
+  MpscQueue<int> queue;
+  EXPECT_TRUE(queue.Empty());
+  int item = -1;
+  EXPECT_FALSE(queue.Pop(item));
+  queue.Push(1);
+  const std::vector<int> batch{2, 3, 4};
+  queue.PushRange(batch.begin(), batch.end());
+  queue.PushRange(batch.end(), batch.end());
+  queue.Push(5);
+  EXPECT_FALSE(queue.Empty());
+  for (int i = 1; i <= 5; i++) {
+    ASSERT_TRUE(queue.Pop(item));
+    EXPECT_EQ(item, i);
+  }
+  EXPECT_FALSE(queue.Pop(item));
+  EXPECT_TRUE(queue.Empty());
+}
+
+TEST(MpscQueueTest, DestructorFreesUnpoppedItems) {
+  auto value = std::make_shared<int>(1);
+  {
+    MpscQueue<std::shared_ptr<int>> queue;
+    queue.Push(value);
+    queue.Push(value);
+    EXPECT_EQ(value.use_count(), 3);
+  }
+  EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(MpscQueueTest, ConcurrentProducersLoseNothingAndKeepTheirOrder) {
+  constexpr uint32_t kProducers = 4;
+  constexpr uint32_t kItems = 100000;
+  // producer index in the high bits, sequence number in the low bits
+  MpscQueue<uint64_t> queue;
+  std::vector<std::thread> producers;
+  for (uint32_t p = 0; p < kProducers; p++) {
+    producers.emplace_back([&queue, p] {
+      for (uint32_t i = 0; i < kItems;) {
+        if (i % 5 == 0 && i + 3 <= kItems) {
+          const uint64_t batch[] = {uint64_t(p) << 32 | i,
+                                    uint64_t(p) << 32 | (i + 1),
+                                    uint64_t(p) << 32 | (i + 2)};
+          queue.PushRange(std::begin(batch), std::end(batch));
+          i += 3;
+        } else {
+          queue.Push(uint64_t(p) << 32 | i);
+          i++;
+        }
+      }
+    });
+  }
+  std::vector<uint32_t> next(kProducers, 0);
+  uint64_t received = 0;
+  uint64_t errors = 0;
+  uint64_t item;
+  while (received < uint64_t(kProducers) * kItems) {
+    if (!queue.Pop(item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    const auto producer = uint32_t(item >> 32);
+    const auto sequence = uint32_t(item);
+    // a lost, duplicated or reordered item breaks the sequence
+    if (producer >= kProducers || sequence != next[producer]) {
+      errors++;
+    } else {
+      next[producer]++;
+    }
+    received++;
+  }
+  for (auto& thread : producers) {
+    thread.join();
+  }
+  EXPECT_EQ(errors, 0U);
+  EXPECT_FALSE(queue.Pop(item));
+  for (uint32_t p = 0; p < kProducers; p++) {
+    EXPECT_EQ(next[p], kItems) << "producer " << p;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "pch.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "engine/core/ParallelJob.h"
+
+using engine::core::ParallelJob;
+
+namespace {
+struct Counts {
+  std::vector<std::atomic<uint32_t>> hits;
+  std::atomic<uint32_t> chunks = 0;
+
+  explicit Counts(size_t count) : hits(count) {}
+
+  static void Body(void* context, size_t begin, size_t end) {
+    auto& counts = *static_cast<Counts*>(context);
+    counts.chunks++;
+    for (size_t i = begin; i < end; i++) {
+      counts.hits[i]++;
+    }
+  }
+};
+
+// Runs [0, count) in job, with helpers threads calling Help the whole time
+// as the idle update threads of a round do for Core::ParallelFor.
+void RunWithHelpers(ParallelJob& job, size_t helpers, size_t count,
+                    size_t grain, Counts& counts) {
+  std::atomic<bool> done = false;
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < helpers; i++) {
+    threads.emplace_back([&] {
+      while (!done.load(std::memory_order_relaxed)) {
+        job.Help();
+      }
+    });
+  }
+  EXPECT_TRUE(job.Run(count, grain, &Counts::Body, &counts));
+  done = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+}  // namespace
+
+TEST(ParallelJobTest, EveryIndexRunsExactlyOnce) {
+  ParallelJob job;
+  for (size_t count : {size_t(1), size_t(2), size_t(3), size_t(7),
+                       size_t(100), size_t(100000)}) {
+    for (size_t grain : {size_t(0), size_t(1), size_t(16), size_t(1000)}) {
+      Counts counts(count);
+      // more helpers than elements for the small ranges
+      RunWithHelpers(job, 4, count, grain, counts);
+      for (size_t i = 0; i < count; i++) {
+        ASSERT_EQ(counts.hits[i].load(), 1U)
+            << "index " << i << " of " << count << ", grain " << grain;
+      }
+      const size_t step = grain == 0 ? 1 : grain;
+      EXPECT_EQ(counts.chunks.load(), (count + step - 1) / step);
+    }
+  }
+}
+
+TEST(ParallelJobTest, RunsInlineWithoutHelpers) {
+  ParallelJob job;
+  Counts counts(10);
+  EXPECT_TRUE(job.Run(10, 3, &Counts::Body, &counts));
+  for (auto const& hit : counts.hits) {
+    EXPECT_EQ(hit.load(), 1U);
+  }
+  EXPECT_EQ(counts.chunks.load(), 4U);
+  // nothing to help with once the loop returned
+  EXPECT_FALSE(job.Help());
+  Counts empty(0);
+  EXPECT_TRUE(job.Run(0, 1, &Counts::Body, &empty));
+  EXPECT_EQ(empty.chunks.load(), 0U);
+}
+
+TEST(ParallelJobTest, NestedRunIsRefused) {
+  struct Context {
+    ParallelJob* job;
+    bool nested = true;
+  };
+  ParallelJob job;
+  Context context{&job};
+  EXPECT_TRUE(job.Run(
+      1, 1,
+      [](void* c, size_t, size_t) {
+        auto& context = *static_cast<Context*>(c);
+        context.nested = context.job->Run(
+            1, 1, [](void*, size_t, size_t) {}, nullptr);
+      },
+      &context));
+  EXPECT_FALSE(context.nested);
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "engine/Object.h"
+#include "engine/core/RenderSnapshot.h"
+#include "engine/core/World.h"
+
+using engine::core::Handle;
+using engine::core::ObjectTransform;
+using engine::core::RenderSnapshot;
+using engine::core::World;
+
+namespace {
+// Entities of World::Objects() with a transform, destroyed at the end of
+// the test.
+class RenderSnapshotTest : public ::testing::Test {
+ protected:
+  void TearDown() override {
+    for (Handle entity : entities_) {
+      World::Objects().Destroy(entity);
+    }
+  }
+
+  Handle Create(float x) {
+    ObjectTransform transform;
+    transform.position = glm::vec3(x, 0.0F, 0.0F);
+    entities_.push_back(World::Objects().Create(transform));
+    snapshot_.MarkChanged(entities_.back());
+    return entities_.back();
+  }
+
+  void Move(Handle entity, float x) {
+    World::Objects().Get<ObjectTransform>(entity)->position.x = x;
+    snapshot_.MarkChanged(entity);
+  }
+
+  // Whether the frame holds the live matrix of every entity.
+  [[nodiscard]] bool Matches(RenderSnapshot::Frame const& frame) {
+    for (Handle entity : entities_) {
+      ObjectTransform* transform =
+          World::Objects().Get<ObjectTransform>(entity);
+      glm::mat4x3 const* matrix = frame.model_matrix(entity);
+      if (transform == nullptr
+              ? matrix != nullptr
+              : matrix == nullptr ||
+                    *matrix != glm::mat4x3(transform->model_matrix())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  RenderSnapshot snapshot_;
+  std::vector<Handle> entities_;
+};
+}  // namespace
+
+TEST_F(RenderSnapshotTest, PublishesChangedTransforms) {
+  const Handle first = Create(1.0F);
+  const Handle second = Create(2.0F);
+  snapshot_.Publish(1);
+  RenderSnapshot::Frame const& frame = snapshot_.Acquire();
+  EXPECT_EQ(frame.tick(), 1U);
+  ASSERT_NE(frame.model_matrix(first), nullptr);
+  EXPECT_EQ((*frame.model_matrix(first))[3][0], 1.0F);
+  EXPECT_TRUE(Matches(frame));
+
+  Move(second, 5.0F);
+  World::Objects().Destroy(first);
+  snapshot_.MarkChanged(first);
+  snapshot_.Publish(2);
+  EXPECT_EQ(snapshot_.Acquire().tick(), 2U);
+  EXPECT_EQ(snapshot_.frame().model_matrix(first), nullptr);
+  EXPECT_EQ((*snapshot_.frame().model_matrix(second))[3][0], 5.0F);
+  EXPECT_TRUE(Matches(snapshot_.frame()));
+}
+
+TEST_F(RenderSnapshotTest, FrameHandedBackCatchesUpFromHistory) {
+  std::vector<Handle> entities;
+  for (int i = 0; i < 10; i++) {
+    entities.push_back(Create(float(i)));
+  }
+  snapshot_.Publish(1);
+  // every publish changes another entity, every frame misses some of them
+  for (uint64_t tick = 2; tick < 40; tick++) {
+    const Handle entity = entities[tick % entities.size()];
+    if (!World::Objects().Contains(entity)) {
+      // destroyed earlier, publish without changes
+    } else if (tick % 7 == 0) {
+      World::Objects().Destroy(entity);
+      snapshot_.MarkChanged(entity);
+    } else {
+      Move(entity, float(tick));
+    }
+    snapshot_.Publish(tick);
+    if (tick % 3 == 0) {
+      ASSERT_EQ(snapshot_.Acquire().tick(), tick);
+      ASSERT_TRUE(Matches(snapshot_.frame())) << "tick " << tick;
+    }
+  }
+}
+
+TEST_F(RenderSnapshotTest, FrameOlderThanHistoryIsRebuilt) {
+  std::vector<Handle> entities;
+  for (int i = 0; i < 10; i++) {
+    entities.push_back(Create(float(i)));
+  }
+  snapshot_.Publish(1);
+  snapshot_.Acquire();
+  // the reader holds its frame over many more publishes than are kept
+  for (uint64_t tick = 2; tick < 30; tick++) {
+    Move(entities[tick % entities.size()], float(tick));
+    snapshot_.Publish(tick);
+  }
+  World::Objects().Destroy(entities[3]);
+  snapshot_.MarkChanged(entities[3]);
+  snapshot_.Publish(30);
+  ASSERT_EQ(snapshot_.Acquire().tick(), 30U);
+  EXPECT_TRUE(Matches(snapshot_.frame()));
+  // the writer now gets the held frame back and has to rebuild it
+  Move(entities[0], 100.0F);
+  snapshot_.Publish(31);
+  ASSERT_EQ(snapshot_.Acquire().tick(), 31U);
+  EXPECT_TRUE(Matches(snapshot_.frame()));
+  EXPECT_EQ(snapshot_.frame().model_matrix(entities[3]), nullptr);
+}
\ No newline at end of file
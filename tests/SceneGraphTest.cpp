@@ -0,0 +1,217 @@
+#include "pch.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cmath>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "engine/core/SceneGraph.h"
+
+using engine::core::Handle;
+using engine::core::SceneGraph;
+
+namespace {
+// Updates stay below SceneGraph's split size so they run inline instead of
+// starting the Core for ParallelFor.
+constexpr size_t kMaxNodes = 900;
+
+glm::mat4 LocalMatrix(SceneGraph const& graph, Handle handle) {
+  glm::mat4 model = glm::mat4_cast(graph.rotation(handle));
+  const glm::vec3 scale = graph.scale(handle);
+  model[0] *= scale.x;
+  model[1] *= scale.y;
+  model[2] *= scale.z;
+  model[3] = glm::vec4(graph.position(handle), 1.0F);
+  return model;
+}
+
+// parent world * local, walking up the hierarchy
+glm::mat4 Reference(SceneGraph const& graph, Handle handle) {
+  const Handle parent = graph.parent(handle);
+  return parent.valid() ? Reference(graph, parent) * LocalMatrix(graph, handle)
+                        : LocalMatrix(graph, handle);
+}
+
+bool Near(glm::mat4 const& a, glm::mat4 const& b) {
+  for (int column = 0; column < 4; column++) {
+    for (int row = 0; row < 4; row++) {
+      const float expected = b[column][row];
+      if (std::fabs(a[column][row] - expected) >
+          1e-4F * (1.0F + std::fabs(expected))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Whether every node holds its reference world matrix.
+bool Consistent(SceneGraph const& graph, std::vector<Handle> const& nodes) {
+  for (Handle node : nodes) {
+    if (graph.Contains(node) &&
+        (graph.dirty(node) ||
+         !Near(graph.world_matrix(node), Reference(graph, node)))) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+TEST(SceneGraphTest, ComposesParentAndLocalTransforms) {
+  SceneGraph graph;
+  const Handle root = graph.Create(Handle(), glm::vec3(10.0F, 0.0F, 0.0F));
+  // a quarter turn around z
+  const glm::quat rotation(std::sqrt(0.5F), 0.0F, 0.0F, std::sqrt(0.5F));
+  const Handle child = graph.Create(root, glm::vec3(1.0F, 0.0F, 0.0F),
+                                    rotation, glm::vec3(2.0F));
+  const Handle grandchild = graph.Create(child, glm::vec3(1.0F, 0.0F, 0.0F));
+  EXPECT_EQ(graph.parent(grandchild), child);
+  EXPECT_FALSE(graph.parent(root).valid());
+  EXPECT_EQ(graph.UpdateWorldMatrices(), 3U);
+  // rotated and scaled by the child: one unit along x becomes two along y
+  glm::mat4 const& world = graph.world_matrix(grandchild);
+  EXPECT_NEAR(world[3][0], 11.0F, 1e-5F);
+  EXPECT_NEAR(world[3][1], 2.0F, 1e-5F);
+  EXPECT_TRUE(Consistent(graph, {root, child, grandchild}));
+}
+
+TEST(SceneGraphTest, UpdatesOnlyDirtySubtrees) {
+  SceneGraph graph;
+  const Handle first = graph.Create();
+  const Handle second = graph.Create();
+  std::vector<Handle> nodes = {first, second};
+  for (int i = 0; i < 50; i++) {
+    nodes.push_back(graph.Create(i % 2 == 0 ? first : nodes.back()));
+  }
+  graph.UpdateWorldMatrices();
+  EXPECT_EQ(graph.UpdateWorldMatrices(), 0U);
+
+  // second has no children
+  graph.SetPosition(second, glm::vec3(1.0F));
+  std::vector<Handle> updated;
+  EXPECT_EQ(graph.UpdateWorldMatrices(
+                [&](Handle node) { updated.push_back(node); }),
+            1U);
+  EXPECT_EQ(updated, (std::vector<Handle>{second}));
+
+  graph.SetScale(first, glm::vec3(3.0F));
+  EXPECT_TRUE(graph.dirty(first));
+  EXPECT_EQ(graph.UpdateWorldMatrices(), 51U);
+  EXPECT_TRUE(Consistent(graph, nodes));
+}
+
+TEST(SceneGraphTest, ReordersAfterReparenting) {
+  SceneGraph graph;
+  const Handle a = graph.Create(Handle(), glm::vec3(1.0F, 0.0F, 0.0F));
+  const Handle b = graph.Create(Handle(), glm::vec3(0.0F, 1.0F, 0.0F));
+  const Handle a_child = graph.Create(a, glm::vec3(0.0F, 0.0F, 1.0F));
+  const Handle b_child = graph.Create(b, glm::vec3(0.0F, 0.0F, 2.0F));
+  // a child of an earlier subtree, breaks depth-first order
+  const Handle late = graph.Create(a_child, glm::vec3(3.0F));
+  graph.UpdateWorldMatrices();
+  EXPECT_TRUE(Consistent(graph, {a, b, a_child, b_child, late}));
+
+  // a below its own subtree is rejected
+  EXPECT_FALSE(graph.SetParent(a, late));
+  EXPECT_FALSE(graph.SetParent(a, a));
+  EXPECT_TRUE(graph.SetParent(a, b_child));
+  EXPECT_EQ(graph.parent(a), b_child);
+  graph.UpdateWorldMatrices();
+  EXPECT_TRUE(Consistent(graph, {a, b, a_child, b_child, late}));
+  EXPECT_NEAR(graph.world_matrix(late)[3][1], 4.0F, 1e-5F);
+
+  EXPECT_TRUE(graph.SetParent(a, Handle()));
+  EXPECT_FALSE(graph.parent(a).valid());
+  graph.UpdateWorldMatrices();
+  EXPECT_TRUE(Consistent(graph, {a, b, a_child, b_child, late}));
+}
+
+TEST(SceneGraphTest, DestroyRemovesSubtree) {
+  SceneGraph graph;
+  const Handle root = graph.Create();
+  const Handle child = graph.Create(root);
+  const Handle grandchild = graph.Create(child);
+  const Handle other = graph.Create(root, glm::vec3(1.0F));
+  graph.UpdateWorldMatrices();
+
+  graph.Destroy(child);
+  EXPECT_FALSE(graph.Contains(child));
+  graph.UpdateWorldMatrices();
+  EXPECT_FALSE(graph.Contains(grandchild));
+  EXPECT_EQ(graph.size(), 2U);
+  // stale handles are ignored
+  graph.Destroy(child);
+  EXPECT_FALSE(graph.SetParent(child, root));
+  EXPECT_FALSE(graph.Create(child).valid());
+
+  graph.SetPosition(root, glm::vec3(5.0F));
+  graph.UpdateWorldMatrices();
+  EXPECT_TRUE(Consistent(graph, {root, other}));
+}
+
+TEST(SceneGraphTest, DetachedChildrenBecomeRoots) {
+  SceneGraph graph;
+  const Handle root = graph.Create(Handle(), glm::vec3(10.0F));
+  const Handle child = graph.Create(root, glm::vec3(1.0F));
+  const Handle grandchild = graph.Create(child, glm::vec3(1.0F));
+  graph.UpdateWorldMatrices();
+
+  graph.DetachChildren(root);
+  graph.Destroy(root);
+  graph.UpdateWorldMatrices();
+  EXPECT_EQ(graph.size(), 2U);
+  EXPECT_FALSE(graph.parent(child).valid());
+  EXPECT_EQ(graph.parent(grandchild), child);
+  EXPECT_NEAR(graph.world_matrix(grandchild)[3][0], 2.0F, 1e-5F);
+}
+
+TEST(SceneGraphTest, RandomEditsMatchReference) {
+  SceneGraph graph;
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> uniform(-1.0F, 1.0F);
+  auto vector = [&] {
+    return glm::vec3(uniform(random), uniform(random), uniform(random));
+  };
+  std::vector<Handle> nodes;
+  auto pick = [&] { return nodes[random() % nodes.size()]; };
+  for (int step = 0; step < 200; step++) {
+    for (int edit = 0; edit < 20; edit++) {
+      const uint32_t roll = random() % 100;
+      if (nodes.empty() || (roll < 40 && graph.size() < kMaxNodes)) {
+        const Handle parent =
+            nodes.empty() || random() % 4 == 0 ? Handle() : pick();
+        if (graph.Contains(parent) || !parent.valid()) {
+          nodes.push_back(graph.Create(parent, vector()));
+        }
+      } else if (roll < 80) {
+        const Handle node = pick();
+        if (graph.Contains(node)) {
+          graph.SetPosition(node, vector());
+          graph.SetRotation(node, glm::normalize(glm::quat(
+                                      uniform(random), uniform(random),
+                                      uniform(random), uniform(random))));
+        }
+      } else if (roll < 95) {
+        graph.SetParent(pick(), random() % 5 == 0 ? Handle() : pick());
+      } else {
+        graph.Destroy(pick());
+      }
+    }
+    ASSERT_LE(graph.UpdateWorldMatrices(), kMaxNodes);
+    ASSERT_TRUE(Consistent(graph, nodes)) << "step " << step;
+  }
+  std::set<uint32_t> indices;
+  size_t alive = 0;
+  for (Handle node : nodes) {
+    if (graph.Contains(node)) {
+      alive++;
+      EXPECT_TRUE(indices.insert(node.index).second);
+    }
+  }
+  EXPECT_EQ(alive, graph.size());
+}
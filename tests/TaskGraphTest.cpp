@@ -0,0 +1,156 @@
+#include "pch.h"
+
+#include <thread>
+#include <vector>
+
+#include "engine/core/TaskGraph.h"
+
+using engine::core::SystemDesc;
+using engine::core::SystemId;
+using engine::core::TaskGraph;
+
+TEST(TaskGraphTest, ConflictingAccessAddsEdges) {
+  TaskGraph graph;
+  const SystemId physics = graph.Register({"physics", {}, {"transforms"}, {}});
+  // reads what physics writes
+  const SystemId render = graph.Register({"render", {"transforms"}, {}, {}});
+  // only reads, no conflict with the other reader
+  const SystemId audio = graph.Register({"audio", {"transforms"}, {}, {}});
+  // writes what both readers read
+  const SystemId editor = graph.Register({"editor", {}, {"transforms"}, {}});
+  // disjoint resources
+  const SystemId ai = graph.Register({"ai", {"navmesh"}, {"agents"}, {}});
+
+  EXPECT_EQ(graph.dependents(physics),
+            (std::vector<SystemId>{render, audio, editor}));
+  EXPECT_EQ(graph.dependents(render), (std::vector<SystemId>{editor}));
+  EXPECT_EQ(graph.dependents(audio), (std::vector<SystemId>{editor}));
+  EXPECT_TRUE(graph.dependents(editor).empty());
+  EXPECT_TRUE(graph.dependents(ai).empty());
+  EXPECT_TRUE(graph.dependents(TaskGraph::kDefaultSystem).empty());
+}
+
+TEST(TaskGraphTest, AfterAddsEdgesToExistingSystems) {
+  TaskGraph graph;
+  const SystemId scene = graph.Register({"scene", {}, {}, {"default"}});
+  EXPECT_EQ(graph.dependents(TaskGraph::kDefaultSystem),
+            (std::vector<SystemId>{scene}));
+  EXPECT_EQ(graph.Register({"late", {}, {}, {"missing"}}),
+            TaskGraph::kInvalidSystem);
+  EXPECT_EQ(graph.Register({"scene", {}, {}, {}}), TaskGraph::kInvalidSystem);
+  EXPECT_EQ(graph.Find("scene"), scene);
+  EXPECT_EQ(graph.Find("late"), TaskGraph::kInvalidSystem);
+  EXPECT_EQ(graph.size(), 2U);
+}
+
+TEST(TaskGraphTest, DefaultSystemCanTouchResources) {
+  TaskGraph graph({"ignored", {}, {"transforms"}, {"missing"}});
+  EXPECT_EQ(graph.Find("default"), TaskGraph::kDefaultSystem);
+  EXPECT_EQ(graph.size(), 1U);
+  const SystemId render = graph.Register({"render", {"transforms"}, {}, {}});
+  const SystemId ai = graph.Register({"ai", {}, {"agents"}, {}});
+  EXPECT_EQ(graph.dependents(TaskGraph::kDefaultSystem),
+            (std::vector<SystemId>{render}));
+  EXPECT_TRUE(graph.dependents(ai).empty());
+}
+
+TEST(TaskGraphTest, DependentsRunOnceAllWorkIsComplete) {
+  TaskGraph graph;
+  const SystemId writer = graph.Register({"writer", {}, {"state"}, {}});
+  const SystemId reader = graph.Register({"reader", {"state"}, {}, {}});
+  graph.Reset(2);
+  EXPECT_TRUE(graph.runnable(TaskGraph::kDefaultSystem));
+  EXPECT_TRUE(graph.runnable(writer));
+  EXPECT_FALSE(graph.runnable(reader));
+
+  graph.Contribute(TaskGraph::kDefaultSystem, 0);
+  graph.ContributionDone(TaskGraph::kDefaultSystem);
+  graph.Contribute(TaskGraph::kDefaultSystem, 0);
+  graph.ContributionDone(TaskGraph::kDefaultSystem);
+
+  // one contributor pushes two tickers, the other none
+  const uint32_t epoch = graph.epoch();
+  graph.Contribute(writer, 2);
+  graph.ContributionDone(writer);
+  graph.Contribute(writer, 0);
+  graph.ContributionDone(writer);
+  graph.CompleteWork(writer);
+  EXPECT_FALSE(graph.runnable(reader));
+  graph.CompleteWork(writer);
+  EXPECT_TRUE(graph.runnable(reader));
+  EXPECT_NE(graph.epoch(), epoch);
+  EXPECT_FALSE(graph.finished());
+
+  graph.Contribute(reader, 0);
+  graph.ContributionDone(reader);
+  graph.Contribute(reader, 0);
+  graph.ContributionDone(reader);
+  EXPECT_TRUE(graph.finished());
+
+  // the next tick starts over
+  graph.Reset(1);
+  EXPECT_FALSE(graph.finished());
+  EXPECT_FALSE(graph.runnable(reader));
+}
+
+TEST(TaskGraphTest, EmptySharesCanBeReportedBeforeTheSystemIsRunnable) {
+  TaskGraph graph;
+  const SystemId writer = graph.Register({"writer", {}, {"state"}, {}});
+  const SystemId reader = graph.Register({"reader", {"state"}, {}, {}});
+  graph.Reset(2);
+
+  // neither contributor has anything due in the reader
+  graph.ContributionDone(reader);
+  graph.ContributionDone(reader);
+  graph.ContributionDone(TaskGraph::kDefaultSystem);
+  graph.ContributionDone(TaskGraph::kDefaultSystem);
+  EXPECT_FALSE(graph.runnable(reader));
+
+  graph.Contribute(writer, 1);
+  graph.ContributionDone(writer);
+  graph.ContributionDone(writer);
+  EXPECT_FALSE(graph.finished());
+  // the reader still waits for the writer
+  const uint32_t epoch = graph.epoch();
+  graph.CompleteWork(writer);
+  EXPECT_TRUE(graph.runnable(reader));
+  EXPECT_NE(graph.epoch(), epoch);
+  EXPECT_TRUE(graph.finished());
+}
+
+TEST(TaskGraphTest, WaitForEpochReturnsOnceASystemIsReleased) {
+  TaskGraph graph;
+  const SystemId writer = graph.Register({"writer", {}, {"state"}, {}});
+  graph.Register({"reader", {"state"}, {}, {}});
+  graph.Reset(1);
+  graph.ContributionDone(TaskGraph::kDefaultSystem);
+  graph.Contribute(writer, 1);
+  graph.ContributionDone(writer);
+
+  const uint32_t epoch = graph.epoch();
+  std::thread waiter([&graph, epoch]() {
+    while (graph.epoch() == epoch) {
+      graph.WaitForEpoch(epoch);
+    }
+  });
+  graph.CompleteWork(writer);
+  waiter.join();
+  EXPECT_NE(graph.epoch(), epoch);
+}
+
+TEST(TaskGraphTest, FinishingTheLastSystemBumpsTheEpoch) {
+  TaskGraph graph;
+  graph.Reset(1);
+  const uint32_t epoch = graph.epoch();
+  graph.Contribute(TaskGraph::kDefaultSystem, 1);
+  graph.ContributionDone(TaskGraph::kDefaultSystem);
+  EXPECT_EQ(graph.epoch(), epoch);
+  graph.CompleteWork(TaskGraph::kDefaultSystem);
+  EXPECT_TRUE(graph.finished());
+  // wakes the threads waiting for more work of the round
+  EXPECT_NE(graph.epoch(), epoch);
+
+  const uint32_t notified = graph.epoch();
+  graph.Notify();
+  EXPECT_NE(graph.epoch(), notified);
+}
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include "pch.h"
+
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "engine/core/Task.h"
+#include "engine/core/TaskScheduler.h"
+
+using engine::core::AsyncResult;
+using engine::core::next_tick;
+using engine::core::Task;
+using engine::core::TaskScheduler;
+using engine::core::ticks;
+using engine::core::when_all;
+
+namespace {
+// Runs ticks [first, last) on a single update thread, as the Core does.
+void RunTicks(TaskScheduler& scheduler, uint64_t first, uint64_t last) {
+  for (uint64_t tick = first; tick < last; tick++) {
+    scheduler.BeginRound(tick, true);
+    scheduler.RunDue(0, true);
+  }
+}
+
+Task Record(std::vector<int>& log, int id, uint64_t wait) {
+  log.push_back(id);
+  co_await ticks(wait);
+  log.push_back(id + 100);
+}
+
+Task Sleep(uint64_t count, std::vector<uint64_t>& finished, uint64_t& now) {
+  co_await ticks(count);
+  finished.push_back(now);
+}
+
+Task Hold(std::shared_ptr<int> value) {
+  co_await ticks(1000);
+  *value = 1;
+}
+
+// Coroutine which runs right away on the calling thread, outside of any
+// TaskScheduler.
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() const noexcept { return {}; }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+};
+}  // namespace
+
+TEST(TaskTest, SuspendsAcrossTicks) {
+  TaskScheduler scheduler(1);
+  uint64_t now = 0;
+  std::vector<uint64_t> resumed;
+  auto body = [&]() -> Task {
+    resumed.push_back(now);
+    co_await next_tick;
+    resumed.push_back(now);
+    co_await ticks(0);
+    co_await ticks(5);
+    resumed.push_back(now);
+  };
+  scheduler.Spawn(body());
+  EXPECT_EQ(scheduler.size(), 1U);
+  for (now = 1; now < 20; now++) {
+    RunTicks(scheduler, now, now + 1);
+  }
+  EXPECT_EQ(resumed, (std::vector<uint64_t>{1, 2, 7}));
+  // finished spawned tasks are freed
+  EXPECT_EQ(scheduler.size(), 0U);
+}
+
+TEST(TaskTest, TasksDueOnOneTickResumeInSuspendOrder) {
+  TaskScheduler scheduler(1);
+  std::vector<int> log;
+  scheduler.Spawn(Record(log, 1, 3));
+  scheduler.Spawn(Record(log, 2, 1));
+  scheduler.Spawn(Record(log, 3, 3));
+  RunTicks(scheduler, 1, 2);
+  EXPECT_EQ(log, (std::vector<int>{1, 2, 3}));
+  RunTicks(scheduler, 2, 5);
+  EXPECT_EQ(log, (std::vector<int>{1, 2, 3, 102, 101, 103}));
+}
+
+TEST(TaskTest, AwaitedTaskRunsAsSubroutine) {
+  TaskScheduler scheduler(1);
+  std::vector<int> log;
+  auto parent = [&]() -> Task {
+    log.push_back(0);
+    co_await Record(log, 1, 2);
+    log.push_back(2);
+  };
+  scheduler.Spawn(parent());
+  RunTicks(scheduler, 1, 2);
+  EXPECT_EQ(log, (std::vector<int>{0, 1}));
+  RunTicks(scheduler, 2, 4);
+  EXPECT_EQ(log, (std::vector<int>{0, 1, 101, 2}));
+  EXPECT_EQ(scheduler.size(), 0U);
+}
+
+TEST(TaskTest, WhenAllResumesAfterTheLastTask) {
+  TaskScheduler scheduler(1);
+  uint64_t now = 0;
+  std::vector<uint64_t> finished;
+  uint64_t joined = 0;
+  auto parent = [&]() -> Task {
+    co_await when_all(Sleep(2, finished, now), Sleep(5, finished, now),
+                      Sleep(0, finished, now));
+    joined = now;
+    // an empty when_all doesn't suspend
+    co_await when_all(std::vector<Task>());
+  };
+  scheduler.Spawn(parent());
+  for (now = 1; now < 10; now++) {
+    RunTicks(scheduler, now, now + 1);
+  }
+  EXPECT_EQ(finished, (std::vector<uint64_t>{1, 3, 6}));
+  EXPECT_EQ(joined, 6U);
+  EXPECT_EQ(scheduler.size(), 0U);
+}
+
+TEST(TaskTest, AsyncResultResumesOnTheNextTick) {
+  TaskScheduler scheduler(1);
+  AsyncResult<int> late;
+  AsyncResult<int> early;
+  early.Complete(7);
+  EXPECT_TRUE(early.ready());
+  std::vector<int> values;
+  auto body = [&]() -> Task {
+    // already completed, doesn't suspend
+    values.push_back(co_await early);
+    values.push_back(co_await late);
+  };
+  scheduler.Spawn(body());
+  RunTicks(scheduler, 1, 3);
+  EXPECT_EQ(values, (std::vector<int>{7}));
+  std::thread([late]() mutable {
+    late.Complete(42);
+    // only the first completion counts
+    late.Complete(43);
+  }).join();
+  EXPECT_TRUE(late.ready());
+  RunTicks(scheduler, 3, 4);
+  EXPECT_EQ(values, (std::vector<int>{7, 42}));
+}
+
+TEST(TaskTest, DestroyingSuspendedTasksFreesTheirFrames) {
+  auto value = std::make_shared<int>(0);
+  {
+    // never started
+    Task task = Hold(value);
+    EXPECT_EQ(value.use_count(), 2);
+  }
+  EXPECT_EQ(value.use_count(), 1);
+  {
+    TaskScheduler scheduler(1);
+    scheduler.Spawn(Hold(value));
+    RunTicks(scheduler, 1, 3);
+    // suspended in the sleep heap
+    EXPECT_EQ(value.use_count(), 2);
+    EXPECT_EQ(scheduler.size(), 1U);
+  }
+  EXPECT_EQ(value.use_count(), 1);
+  EXPECT_EQ(*value, 0);
+}
+
+TEST(TaskDeathTest, EscapingExceptionTerminates) {
+  ::testing::GTEST_FLAG(death_test_style) = "threadsafe";
+  auto body = []() -> Task {
+    co_await next_tick;
+    throw std::runtime_error("task failed");
+  };
+  EXPECT_DEATH(
+      {
+        TaskScheduler scheduler(1);
+        scheduler.Spawn(body());
+        RunTicks(scheduler, 1, 3);
+      },
+      "");
+}
+
+TEST(TaskTest, AsyncResultResumesInlineOutsideOfTheScheduler) {
+  AsyncResult<int> result;
+  int value = 0;
+  auto body = [&]() -> Detached { value = co_await result; };
+  body();
+  EXPECT_EQ(value, 0);
+  result.Complete(7);
+  EXPECT_EQ(value, 7);
+}
+
+TEST(TaskTest, WaitingForTicksOutsideOfTheSchedulerTerminates) {
+  ::testing::GTEST_FLAG(death_test_style) = "threadsafe";
+  auto body = []() -> Detached { co_await next_tick; };
+  EXPECT_DEATH(body(), "");
+}
\ No newline at end of file
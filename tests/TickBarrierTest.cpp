@@ -0,0 +1,52 @@
+#include "pch.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "engine/core/TickBarrier.h"
+
+using engine::core::TickBarrier;
+
+TEST(TickBarrierTest, SingleParticipantCompletesAlone) {
+  TickBarrier barrier(1);
+  int completions = 0;
+  barrier.ArriveAndComplete([&] { completions++; });
+  barrier.ArriveAndComplete([&] { completions++; });
+  EXPECT_EQ(completions, 2);
+  EXPECT_EQ(barrier.phase(), 2U);
+}
+
+TEST(TickBarrierTest, CompletionSeesEveryArrival) {
+  constexpr int kThreads = 8;
+  constexpr int kPhases = 20000;
+  // a short spin so the futex path is exercised too
+  TickBarrier barrier(kThreads, 64);
+  std::atomic<int> arrivals = 0;
+  int completions = 0;
+  int mismatches = 0;
+  std::vector<std::thread> threads;
+  for (int i = 1; i < kThreads; i++) {
+    threads.emplace_back([&] {
+      for (int phase = 0; phase < kPhases; phase++) {
+        arrivals++;
+        barrier.ArriveAndWait();
+      }
+    });
+  }
+  for (int phase = 0; phase < kPhases; phase++) {
+    arrivals++;
+    barrier.ArriveAndComplete([&] {
+      if (arrivals.load() != kThreads * (phase + 1)) {
+        mismatches++;
+      }
+      completions++;
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(mismatches, 0);
+  EXPECT_EQ(completions, kPhases);
+  EXPECT_EQ(barrier.phase(), static_cast<uint32_t>(kPhases));
+}
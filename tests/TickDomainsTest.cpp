@@ -0,0 +1,92 @@
+#include "pch.h"
+
+#include <vector>
+
+#include "engine/core/TickDomains.h"
+
+using engine::core::DomainId;
+using engine::core::TickDomains;
+
+namespace {
+constexpr int64_t kSecond = 1'000'000'000;
+
+// Advances by elapsed nanoseconds and runs every round.
+uint32_t Step(TickDomains& domains, int64_t elapsed,
+              std::vector<uint64_t>& ticks) {
+  const uint32_t rounds = domains.Advance(elapsed);
+  for (uint32_t round = 0; round < rounds; round++) {
+    domains.BeginRound(round, ticks);
+  }
+  return rounds;
+}
+}  // namespace
+
+TEST(TickDomainsTest, RegistersUniqueNamesWithNonZeroRates) {
+  TickDomains domains(64);
+  EXPECT_EQ(domains.Find("default"), TickDomains::kDefaultDomain);
+  const DomainId physics = domains.Register({"physics", 240, 8});
+  EXPECT_NE(physics, TickDomains::kInvalidDomain);
+  EXPECT_EQ(domains.Find("physics"), physics);
+  EXPECT_EQ(domains.Register({"physics", 120, 8}),
+            TickDomains::kInvalidDomain);
+  EXPECT_EQ(domains.Register({"zero", 0, 8}), TickDomains::kInvalidDomain);
+  EXPECT_EQ(domains.Find("zero"), TickDomains::kInvalidDomain);
+  EXPECT_EQ(domains.size(), 2U);
+  EXPECT_EQ(domains.rates(), (std::vector<uint32_t>{64, 240}));
+}
+
+TEST(TickDomainsTest, WholeNanosecondIntervalsDoNotDrift) {
+  // 60 Hz doesn't divide a second, interval deadlines are rounded down
+  TickDomains domains(60);
+  const DomainId fast = domains.Register({"fast", 240, 4});
+  const DomainId slow = domains.Register({"slow", 7, 4});
+  std::vector<uint64_t> ticks;
+  int64_t previous = 0;
+  for (int64_t interval = 1; interval <= 6000; interval++) {
+    const int64_t deadline = interval * kSecond / 60;
+    EXPECT_EQ(Step(domains, deadline - previous, ticks), 4U);
+    previous = deadline;
+    ASSERT_EQ(domains.tick(TickDomains::kDefaultDomain),
+              static_cast<uint64_t>(interval));
+    ASSERT_EQ(domains.tick(fast), static_cast<uint64_t>(interval * 4));
+    ASSERT_EQ(domains.tick(slow), static_cast<uint64_t>(interval * 7 / 60));
+  }
+  EXPECT_EQ(domains.dropped(TickDomains::kDefaultDomain), 0);
+  EXPECT_EQ(domains.dropped(fast), 0);
+  EXPECT_EQ(domains.dropped(slow), 0);
+}
+
+TEST(TickDomainsTest, RoundsStepDomainsWithStepsLeft) {
+  TickDomains domains(64);
+  const DomainId physics = domains.Register({"physics", 256, 8});
+  std::vector<uint64_t> ticks;
+  ASSERT_EQ(domains.Advance(kSecond / 64), 4U);
+  domains.BeginRound(0, ticks);
+  EXPECT_EQ(ticks, (std::vector<uint64_t>{0, 0}));
+  domains.BeginRound(1, ticks);
+  EXPECT_EQ(ticks[TickDomains::kDefaultDomain], TickDomains::kIdle);
+  EXPECT_EQ(ticks[physics], 1U);
+  domains.BeginRound(2, ticks);
+  domains.BeginRound(3, ticks);
+  EXPECT_EQ(ticks[TickDomains::kDefaultDomain], TickDomains::kIdle);
+  EXPECT_EQ(ticks[physics], 3U);
+}
+
+TEST(TickDomainsTest, CapsCatchUpAndKeepsThePhase) {
+  TickDomains domains(64);
+  std::vector<uint64_t> ticks;
+  // half a step accumulated
+  Step(domains, kSecond / 128, ticks);
+  EXPECT_EQ(domains.tick(TickDomains::kDefaultDomain), 0U);
+  EXPECT_NEAR(domains.alpha(TickDomains::kDefaultDomain), 0.5, 1e-6);
+
+  // a one second stall owes 64 steps, only max_steps are taken
+  EXPECT_EQ(Step(domains, kSecond, ticks), 4U);
+  EXPECT_EQ(domains.tick(TickDomains::kDefaultDomain), 4U);
+  EXPECT_EQ(domains.dropped(TickDomains::kDefaultDomain), kSecond * 60 / 64);
+  EXPECT_NEAR(domains.alpha(TickDomains::kDefaultDomain), 0.5, 1e-6);
+
+  // and the next interval runs at the normal rate again
+  EXPECT_EQ(Step(domains, kSecond / 64, ticks), 1U);
+  EXPECT_EQ(domains.tick(TickDomains::kDefaultDomain), 5U);
+}
@@ -0,0 +1,84 @@
+#include "pch.h"
+
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "engine/core/TickProfiler.h"
+
+using engine::core::ProfileEvent;
+using engine::core::TickProfiler;
+
+namespace {
+size_t CountOccurrences(std::string const& text, std::string const& what) {
+  size_t rv = 0;
+  for (size_t pos = text.find(what); pos != std::string::npos;
+       pos = text.find(what, pos + what.size())) {
+    rv++;
+  }
+  return rv;
+}
+
+ProfileEvent MakeEvent(uint64_t tick) {
+  ProfileEvent event;
+  event.begin = tick * 10;
+  event.end = tick * 10 + 5;
+  event.tick = tick;
+  event.name = "Ticker";
+  return event;
+}
+}  // namespace
+
+TEST(TickProfilerTest, WritesEventsOfTheRequestedTicks) {
+  TickProfiler profiler(2);
+  profiler.Start(16);
+  for (uint64_t tick = 0; tick < 10; tick++) {
+    profiler.Record(0, MakeEvent(tick));
+  }
+  ProfileEvent wait = MakeEvent(3);
+  wait.type = ProfileEvent::Type::kBarrierWait;
+  profiler.Record(1, wait);
+  std::ostringstream out;
+  profiler.WriteChromeTrace(out, 2, 5);
+  const std::string trace = out.str();
+  EXPECT_EQ(CountOccurrences(trace, "\"cat\":\"update\""), 4U);
+  EXPECT_EQ(CountOccurrences(trace, "\"cat\":\"barrier\""), 1U);
+  EXPECT_EQ(CountOccurrences(trace, "\"ph\":\"M\""), 2U);
+}
+
+TEST(TickProfilerTest, FullRingKeepsTheNewestEvents) {
+  TickProfiler profiler(1);
+  profiler.Start(8);
+  for (uint64_t tick = 0; tick < 20; tick++) {
+    profiler.Record(0, MakeEvent(tick));
+  }
+  std::ostringstream out;
+  profiler.WriteChromeTrace(out, 0, 100);
+  const std::string trace = out.str();
+  // the oldest slot may be mid-write, so only capacity - 1 events are kept
+  EXPECT_EQ(CountOccurrences(trace, "\"cat\":\"update\""), 7U);
+  EXPECT_EQ(CountOccurrences(trace, "\"tick\":12,"), 0U);
+  for (uint64_t tick = 13; tick < 20; tick++) {
+    EXPECT_EQ(CountOccurrences(trace, "\"tick\":" + std::to_string(tick) + ","),
+              1U);
+  }
+}
+
+TEST(TickProfilerTest, ReadsWhileRecording) {
+  TickProfiler profiler(1);
+  profiler.Start(64);
+  std::atomic<bool> done = false;
+  std::thread writer([&] {
+    for (uint64_t tick = 0; !done.load(std::memory_order_relaxed); tick++) {
+      profiler.Record(0, MakeEvent(tick));
+    }
+  });
+  for (int i = 0; i < 200; i++) {
+    std::ostringstream out;
+    profiler.WriteChromeTrace(out, 0, UINT64_MAX);
+    EXPECT_LE(CountOccurrences(out.str(), "\"cat\":\"update\""), 63U);
+  }
+  done = true;
+  writer.join();
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include "pch.h"
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "engine/core/TickerRegistry.h"
+
+using engine::core::Handle;
+using engine::core::Ticker;
+using engine::core::TickerRegistry;
+
+namespace {
+class CountingTicker : public Ticker {
+ public:
+  using Ticker::Ticker;
+
+  void Update(const uint64_t /*tick*/) override { updates++; }
+
+  void Rate(uint32_t tickrate) { SetTickrate(tickrate); }
+  void Disable() { DisableUpdating(); }
+  void Enable() { EnableUpdating(); }
+
+  int updates = 0;
+};
+
+// a second type, so tickers of one rate land in several buckets
+class OtherTicker final : public CountingTicker {
+ public:
+  using CountingTicker::CountingTicker;
+};
+
+// Runs the rounds [first, last) of the default domain.
+void RunRounds(TickerRegistry& registry, uint64_t first, uint64_t last) {
+  for (uint64_t tick = first; tick < last; tick++) {
+    registry.ForEachDue({tick}, [tick](Ticker& object, bool /*pinned*/) {
+      object.Update(tick);
+    });
+  }
+}
+}  // namespace
+
+TEST(TickerRegistryTest, UpdatesEveryTickerOnItsDueTicks) {
+  TickerRegistry registry;
+  std::vector<std::shared_ptr<CountingTicker>> tickers;
+  for (uint32_t i = 0; i < 100; i++) {
+    const uint32_t tickrate = 1 + i % 7;
+    if (i % 2 == 0) {
+      tickers.push_back(std::make_shared<CountingTicker>(tickrate));
+    } else {
+      tickers.push_back(std::make_shared<OtherTicker>(tickrate));
+    }
+    registry.Add(tickers.back());
+  }
+  EXPECT_EQ(registry.size(), 100U);
+  // 420 is a multiple of every tickrate
+  RunRounds(registry, 0, 420);
+  for (auto const& ticker : tickers) {
+    EXPECT_EQ(ticker->updates, static_cast<int>(420 / ticker->tickrate()));
+  }
+}
+
+TEST(TickerRegistryTest, DropsExpiredAndRemovedTickers) {
+  TickerRegistry registry;
+  std::vector<std::shared_ptr<CountingTicker>> tickers;
+  std::vector<Handle> handles;
+  for (uint32_t i = 0; i < 10; i++) {
+    tickers.push_back(std::make_shared<CountingTicker>(1 + i % 3));
+    handles.push_back(registry.Add(tickers.back()));
+  }
+  // expired tickers are found when their bucket is due
+  for (size_t i = 0; i < 4; i++) {
+    tickers[i].reset();
+  }
+  RunRounds(registry, 0, 6);
+  EXPECT_EQ(registry.size(), 6U);
+  for (size_t i = 0; i < 4; i++) {
+    EXPECT_FALSE(registry.Contains(handles[i]));
+  }
+
+  registry.Remove(handles[4]);
+  EXPECT_TRUE(registry.Contains(handles[4]));
+  registry.Flush();
+  EXPECT_FALSE(registry.Contains(handles[4]));
+  EXPECT_EQ(registry.size(), 5U);
+
+  const int updates = tickers[4]->updates;
+  RunRounds(registry, 6, 12);
+  EXPECT_EQ(tickers[4]->updates, updates);
+  // the remaining tickers keep their handles across the swaps
+  for (size_t i = 5; i < 10; i++) {
+    EXPECT_TRUE(registry.Contains(handles[i]));
+    EXPECT_EQ(tickers[i]->updates,
+              static_cast<int>(12 / tickers[i]->tickrate()));
+  }
+}
+
+TEST(TickerRegistryTest, ReleasesTickersOnceTheirOwnersAreGone) {
+  TickerRegistry registry;
+  auto ticker = std::make_shared<CountingTicker>(3);
+  std::weak_ptr<CountingTicker> observer = ticker;
+  const Handle handle = registry.Add(ticker);
+  ticker.reset();
+  // the registry still holds it until its bucket is due
+  EXPECT_FALSE(observer.expired());
+  RunRounds(registry, 0, 1);
+  EXPECT_TRUE(observer.expired());
+  EXPECT_FALSE(registry.Contains(handle));
+  EXPECT_EQ(registry.size(), 0U);
+}
+
+TEST(TickerRegistryTest, FollowsTickrateChanges) {
+  TickerRegistry registry;
+  auto ticker = std::make_shared<CountingTicker>(2);
+  const Handle handle = registry.Add(ticker);
+  RunRounds(registry, 0, 10);
+  EXPECT_EQ(ticker->updates, 5);
+
+  ticker->Rate(5);
+  // the ticker is moved to its new bucket once its old one is due
+  RunRounds(registry, 10, 12);
+  ticker->updates = 0;
+  RunRounds(registry, 12, 42);
+  EXPECT_EQ(ticker->updates, 6);
+  EXPECT_TRUE(registry.Contains(handle));
+}
+
+TEST(TickerRegistryTest, ParksDisabledTickers) {
+  TickerRegistry registry;
+  auto ticker = std::make_shared<CountingTicker>(1);
+  const Handle handle = registry.Add(ticker);
+  RunRounds(registry, 0, 3);
+  EXPECT_EQ(ticker->updates, 3);
+
+  ticker->Disable();
+  RunRounds(registry, 3, 10);
+  EXPECT_EQ(ticker->updates, 3);
+  EXPECT_TRUE(registry.Contains(handle));
+  int visited = 0;
+  registry.ForEach([&](Ticker& /*object*/) { visited++; });
+  EXPECT_EQ(visited, 1);
+
+  ticker->Enable();
+  RunRounds(registry, 10, 15);
+  EXPECT_EQ(ticker->updates, 8);
+}
+
+
+TEST(TickerRegistryTest, EnablingAfterTheRegistryIsGoneDoesNothing) {
+  auto ticker = std::make_shared<CountingTicker>(1);
+  auto removed = std::make_shared<CountingTicker>(1);
+  {
+    TickerRegistry registry;
+    registry.Add(ticker);
+    const Handle handle = registry.Add(removed);
+    ticker->Disable();
+    removed->Disable();
+    RunRounds(registry, 0, 2);
+    EXPECT_EQ(ticker->updates, 0);
+    // a parked ticker which is removed no longer wakes the registry
+    registry.Remove(handle);
+    registry.Flush();
+    EXPECT_FALSE(registry.Contains(handle));
+    removed->Enable();
+    RunRounds(registry, 2, 4);
+    EXPECT_EQ(removed->updates, 0);
+  }
+  // as after Core::Stop and ~Core, the wake-up queue is destroyed
+  ticker->Enable();
+  EXPECT_TRUE(ticker->needs_update());
+  // and the ticker can be parked by another registry later
+  TickerRegistry registry;
+  registry.Add(ticker);
+  RunRounds(registry, 0, 2);
+  EXPECT_EQ(ticker->updates, 2);
+  ticker->Disable();
+  RunRounds(registry, 2, 4);
+  ticker->Enable();
+  RunRounds(registry, 4, 6);
+  EXPECT_EQ(ticker->updates, 4);
+}
+
+TEST(TickerRegistryTest, EnablingRacesWithRegistryTeardown) {
+  for (int i = 0; i < 200; i++) {
+    auto ticker = std::make_shared<CountingTicker>(1);
+    auto registry = std::make_unique<TickerRegistry>();
+    registry->Add(ticker);
+    ticker->Disable();
+    RunRounds(*registry, 0, 2);
+    std::thread enabler([&ticker] { ticker->Enable(); });
+    registry.reset();
+    enabler.join();
+    EXPECT_TRUE(ticker->needs_update());
+  }
+}
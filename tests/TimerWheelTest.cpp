@@ -0,0 +1,75 @@
+#include "pch.h"
+
+#include <map>
+#include <random>
+#include <vector>
+
+#include "engine/core/TimerWheel.h"
+
+using engine::core::TimerWheel;
+
+TEST(TimerWheelTest, FiresInDueOrder) {
+  TimerWheel<int> wheel;
+  wheel.Schedule(5, 5);
+  wheel.Schedule(1, 1);
+  wheel.Schedule(200, 200);
+  wheel.Schedule(5000, 5000);
+  EXPECT_EQ(wheel.size(), 4U);
+  std::vector<int> fired;
+  wheel.Advance(10000, [&](int value) { fired.push_back(value); });
+  EXPECT_EQ(fired, (std::vector<int>{1, 5, 200, 5000}));
+  EXPECT_EQ(wheel.size(), 0U);
+  EXPECT_EQ(wheel.now(), 10000U);
+}
+
+TEST(TimerWheelTest, PastDueFiresOnNextAdvance) {
+  TimerWheel<int> wheel;
+  wheel.Advance(100, [](int) {});
+  wheel.Schedule(50, 1);
+  int fired = 0;
+  wheel.Advance(100, [&](int) { fired++; });
+  EXPECT_EQ(fired, 1);
+}
+
+TEST(TimerWheelTest, EveryEntryFiresOnItsTick) {
+  TimerWheel<uint64_t> wheel;
+  std::mt19937_64 random(1);
+  std::multimap<uint64_t, uint64_t> pending;
+  uint64_t now = 1000000;
+  wheel.Advance(now, [](uint64_t) {});
+  uint64_t errors = 0;
+  for (int step = 0; step < 300000; step++) {
+    if (random() % 4 == 0) {
+      // mostly near entries, some past the top level into the overflow
+      const uint64_t due = now + 1 + (random() % 8 == 0
+                                          ? random() % (uint64_t(1) << 26)
+                                          : random() % 300);
+      wheel.Schedule(due, due);
+      pending.emplace(due, due);
+    }
+    now++;
+    wheel.Advance(now, [&](uint64_t due) {
+      auto it = pending.find(due);
+      if (due != now || it == pending.end()) {
+        errors++;
+        return;
+      }
+      pending.erase(it);
+    });
+  }
+  EXPECT_EQ(errors, 0U);
+  EXPECT_EQ(wheel.size(), pending.size());
+  // jumping far ahead flushes the overflow too
+  uint64_t unknown = 0;
+  wheel.Advance(now + (uint64_t(1) << 27), [&](uint64_t due) {
+    auto it = pending.find(due);
+    if (it == pending.end()) {
+      unknown++;
+      return;
+    }
+    pending.erase(it);
+  });
+  EXPECT_EQ(unknown, 0U);
+  EXPECT_TRUE(pending.empty());
+  EXPECT_EQ(wheel.size(), 0U);
+}
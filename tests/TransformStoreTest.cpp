@@ -0,0 +1,150 @@
+#include "pch.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "engine/core/TransformStore.h"
+
+using engine::core::Handle;
+using engine::core::TransformStore;
+
+namespace {
+// translation * rotation * scale, built with glm
+glm::mat4 Reference(TransformStore const& store, Handle handle) {
+  glm::mat4 model = glm::mat4_cast(store.rotation(handle));
+  const glm::vec3 scale = store.scale(handle);
+  model[0] *= scale.x;
+  model[1] *= scale.y;
+  model[2] *= scale.z;
+  model[3] = glm::vec4(store.position(handle), 1.0F);
+  return model;
+}
+
+float MaxError(glm::mat4 const& a, glm::mat4 const& b) {
+  float error = 0.0F;
+  for (int column = 0; column < 4; column++) {
+    for (int row = 0; row < 4; row++) {
+      error = std::max(error, std::fabs(a[column][row] - b[column][row]));
+    }
+  }
+  return error;
+}
+
+class TransformStoreTest : public ::testing::Test {
+ protected:
+  glm::vec3 RandomVector() {
+    return glm::vec3(uniform_(random_), uniform_(random_), uniform_(random_));
+  }
+  glm::quat RandomRotation() {
+    return glm::normalize(glm::quat(uniform_(random_), uniform_(random_),
+                                    uniform_(random_), uniform_(random_)));
+  }
+
+  std::mt19937 random_{3};
+  std::uniform_real_distribution<float> uniform_{-2.0F, 2.0F};
+};
+}  // namespace
+
+// UpdateMatrices uses the SIMD kernel the host supports, the reference is
+// scalar glm code.
+TEST_F(TransformStoreTest, KernelMatchesScalarReference) {
+  TransformStore store;
+  std::vector<Handle> handles;
+  // not a multiple of the kernel group, the tail is built too
+  for (int i = 0; i < 1003; i++) {
+    handles.push_back(
+        store.Create(RandomVector(), RandomRotation(), RandomVector()));
+  }
+  EXPECT_EQ(store.UpdateMatrices(), handles.size());
+  float error = 0.0F;
+  for (Handle handle : handles) {
+    EXPECT_FALSE(store.dirty(handle));
+    error = std::max(error,
+                     MaxError(store.model_matrix(handle),
+                              Reference(store, handle)));
+  }
+  EXPECT_LT(error, 1e-5F);
+}
+
+TEST_F(TransformStoreTest, RebuildsOnlyDirtyTransforms) {
+  TransformStore store;
+  std::vector<Handle> handles;
+  for (int i = 0; i < 500; i++) {
+    handles.push_back(store.Create(RandomVector()));
+  }
+  store.UpdateMatrices();
+  EXPECT_EQ(store.UpdateMatrices(), 0U);
+
+  store.SetPosition(handles[3], glm::vec3(1.0F, 2.0F, 3.0F));
+  store.SetRotation(handles[200], RandomRotation());
+  store.SetScale(handles[499], glm::vec3(2.0F));
+  EXPECT_TRUE(store.dirty(handles[3]));
+  EXPECT_FALSE(store.dirty(handles[4]));
+  EXPECT_EQ(store.UpdateMatrices(), 3U);
+  EXPECT_EQ(store.model_matrix(handles[3])[3][0], 1.0F);
+  EXPECT_EQ(store.model_matrix(handles[3])[3][1], 2.0F);
+  EXPECT_EQ(store.model_matrix(handles[3])[3][2], 3.0F);
+  for (Handle handle : {handles[200], handles[499]}) {
+    EXPECT_LT(MaxError(store.model_matrix(handle), Reference(store, handle)),
+              1e-5F);
+  }
+}
+
+TEST_F(TransformStoreTest, RangesCoverDisjointTransforms) {
+  TransformStore store;
+  std::vector<Handle> handles;
+  for (int i = 0; i < 300; i++) {
+    handles.push_back(
+        store.Create(RandomVector(), RandomRotation(), RandomVector()));
+  }
+  size_t built = 0;
+  for (size_t first = 0; first < store.size();
+       first += TransformStore::kRangeAlignment) {
+    built += store.UpdateMatrices(first,
+                                  first + TransformStore::kRangeAlignment);
+  }
+  EXPECT_EQ(built, handles.size());
+  for (Handle handle : handles) {
+    EXPECT_LT(MaxError(store.model_matrix(handle), Reference(store, handle)),
+              1e-5F);
+  }
+}
+
+TEST_F(TransformStoreTest, DestroyKeepsOtherHandlesValid) {
+  TransformStore store;
+  std::vector<Handle> handles;
+  for (int i = 0; i < 100; i++) {
+    handles.push_back(store.Create(glm::vec3(float(i), 0.0F, 0.0F)));
+  }
+  for (int i = 0; i < 100; i += 3) {
+    store.Destroy(handles[i]);
+  }
+  // stale handles are ignored
+  store.Destroy(handles[0]);
+  EXPECT_EQ(store.size(), 66U);
+  store.UpdateMatrices();
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(store.Contains(handles[i]), i % 3 != 0);
+    if (i % 3 != 0) {
+      EXPECT_EQ(store.position(handles[i]).x, float(i));
+      EXPECT_EQ(store.model_matrix(handles[i])[3][0], float(i));
+    }
+  }
+}
+
+TEST_F(TransformStoreTest, ClearKeepsTheStoreUsable) {
+  TransformStore store;
+  const Handle old = store.Create(glm::vec3(1.0F, 0.0F, 0.0F));
+  store.Create(glm::vec3(2.0F, 0.0F, 0.0F));
+  store.Clear();
+  EXPECT_EQ(store.size(), 0U);
+  EXPECT_FALSE(store.Contains(old));
+  EXPECT_EQ(store.UpdateMatrices(), 0U);
+  const Handle handle = store.Create(glm::vec3(3.0F, 0.0F, 0.0F));
+  EXPECT_EQ(store.UpdateMatrices(), 1U);
+  EXPECT_EQ(store.model_matrix(handle)[3][0], 3.0F);
+}
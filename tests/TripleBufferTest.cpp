@@ -0,0 +1,59 @@
+#include "pch.h"
+
+#include <array>
+#include <atomic>
+#include <thread>
+
+#include "engine/core/TripleBuffer.h"
+
+using engine::core::TripleBuffer;
+
+TEST(TripleBufferTest, ReaderTakesLatestPublish) {
+  TripleBuffer<int> buffer;
+  EXPECT_EQ(buffer.Acquire(), 0);
+
+  buffer.back() = 1;
+  buffer.Publish();
+  buffer.back() = 2;
+  buffer.Publish();
+  EXPECT_EQ(buffer.Acquire(), 2);
+  // nothing new, the reader keeps its buffer
+  EXPECT_EQ(buffer.Acquire(), 2);
+  EXPECT_EQ(buffer.front(), 2);
+
+  // the writer never gets the reader's buffer back
+  buffer.back() = 3;
+  buffer.Publish();
+  EXPECT_NE(&buffer.back(), &buffer.front());
+  buffer.back() = 4;
+  EXPECT_EQ(buffer.front(), 2);
+  EXPECT_EQ(buffer.Acquire(), 3);
+}
+
+TEST(TripleBufferTest, ReaderNeverSeesTornOrOlderStates) {
+  constexpr uint64_t kPublishes = 200000;
+  // filled with one value per publish, a torn read mixes two
+  TripleBuffer<std::array<uint64_t, 16>> buffer;
+  std::atomic<bool> done = false;
+  std::thread writer([&] {
+    for (uint64_t value = 1; value <= kPublishes; value++) {
+      buffer.back().fill(value);
+      buffer.Publish();
+    }
+    done = true;
+  });
+  uint64_t last = 0;
+  uint64_t torn = 0;
+  uint64_t backwards = 0;
+  while (!done.load() || last != kPublishes) {
+    auto const& state = buffer.Acquire();
+    for (uint64_t value : state) {
+      torn += value != state[0] ? 1 : 0;
+    }
+    backwards += state[0] < last ? 1 : 0;
+    last = state[0];
+  }
+  writer.join();
+  EXPECT_EQ(torn, 0U);
+  EXPECT_EQ(backwards, 0U);
+}
@@ -0,0 +1,102 @@
+#include "pch.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "engine/core/UpdateStats.h"
+
+using engine::core::LatencyHistogram;
+using engine::core::UpdateStats;
+
+TEST(LatencyHistogramTest, BucketValueIsWithinAnEighth) {
+  EXPECT_EQ(LatencyHistogram::BucketOf(0), 0U);
+  EXPECT_EQ(LatencyHistogram::BucketOf(127), 0U);
+  EXPECT_EQ(LatencyHistogram::BucketOf(int64_t(1) << 40),
+            LatencyHistogram::kBuckets - 1);
+  size_t previous = 0;
+  for (int64_t ns = 128; ns < (int64_t(1) << 35); ns += ns / 37 + 1) {
+    const size_t bucket = LatencyHistogram::BucketOf(ns);
+    ASSERT_LT(bucket, LatencyHistogram::kBuckets);
+    ASSERT_GE(bucket, previous) << ns;
+    previous = bucket;
+    const int64_t value = LatencyHistogram::BucketValue(bucket);
+    ASSERT_LE(std::abs(value - ns), ns / 8) << ns;
+  }
+}
+
+TEST(LatencyHistogramTest, Percentiles) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.Percentile(0.5), 0);
+  for (int i = 0; i < 900; i++) {
+    histogram.Record(1'000);
+  }
+  for (int i = 0; i < 100; i++) {
+    histogram.Record(1'000'000);
+  }
+  EXPECT_NEAR(double(histogram.Percentile(0)), 1e3, 1e3 / 8);
+  EXPECT_NEAR(double(histogram.Percentile(0.5)), 1e3, 1e3 / 8);
+  EXPECT_NEAR(double(histogram.Percentile(0.95)), 1e6, 1e6 / 8);
+  EXPECT_NEAR(double(histogram.Percentile(1)), 1e6, 1e6 / 8);
+  // the static overload over summed counts agrees
+  std::vector<uint64_t> counts(LatencyHistogram::kBuckets);
+  histogram.AddTo(counts);
+  histogram.AddTo(counts);
+  EXPECT_EQ(LatencyHistogram::Percentile(counts, 0.5),
+            histogram.Percentile(0.5));
+}
+
+TEST(LatencyHistogramTest, DecayFollowsRecentSamples) {
+  LatencyHistogram histogram;
+  for (uint32_t i = 0; i < LatencyHistogram::kDecayPeriod; i++) {
+    histogram.Record(1'000);
+  }
+  std::vector<uint64_t> counts(LatencyHistogram::kBuckets);
+  histogram.AddTo(counts);
+  EXPECT_EQ(counts[LatencyHistogram::BucketOf(1'000)],
+            LatencyHistogram::kDecayPeriod / 2);
+  // the same number of slower samples outweighs the halved old ones
+  for (uint32_t i = 0; i < LatencyHistogram::kDecayPeriod; i++) {
+    histogram.Record(1'000'000);
+  }
+  EXPECT_NEAR(double(histogram.Percentile(0.5)), 1e6, 1e6 / 8);
+  EXPECT_NEAR(double(histogram.Percentile(0.2)), 1e3, 1e3 / 8);
+}
+
+TEST(UpdateStatsTest, AllocatesTheHistogramOnlyOnRequest) {
+  UpdateStats stats;
+  for (int i = 0; i < 100; i++) {
+    stats.Record(5'000'000, false);
+  }
+  EXPECT_EQ(stats.histogram(), nullptr);
+  EXPECT_EQ(stats.p50(), 0);
+  EXPECT_EQ(stats.p99(), 0);
+  stats.Record(1'000, true);
+  auto const* histogram = stats.histogram();
+  ASSERT_NE(histogram, nullptr);
+  // later updates use the same histogram whether or not they ask for it
+  stats.Record(1'000, false);
+  EXPECT_EQ(stats.histogram(), histogram);
+  // percentiles cover only the updates since the allocation
+  EXPECT_NEAR(stats.p99(), 1e-6, 1e-6 / 8);
+}
+
+TEST(UpdateStatsTest, DecayedMeanAndMax) {
+  UpdateStats stats;
+  EXPECT_EQ(stats.mean(), 0);
+  // the first sample sets the mean
+  stats.Record(1'000'000'000, false);
+  EXPECT_DOUBLE_EQ(stats.mean(), 1.0);
+  double expected = 1.0;
+  for (int i = 0; i < 64; i++) {
+    stats.Record(0, false);
+    expected -= expected / UpdateStats::kMeanWindow;
+  }
+  EXPECT_NEAR(stats.mean(), expected, 1e-12);
+  // after two windows the old sample weighs about e^-2
+  EXPECT_NEAR(stats.mean(), std::exp(-2.0), 0.01);
+  EXPECT_DOUBLE_EQ(stats.max(), 1.0);
+  EXPECT_EQ(stats.max_ns(), 1'000'000'000);
+  stats.Record(2'000'000'000, false);
+  EXPECT_EQ(stats.max_ns(), 2'000'000'000);
+}
\ No newline at end of file
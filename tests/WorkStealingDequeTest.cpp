@@ -0,0 +1,75 @@
+#include "pch.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "engine/core/WorkStealingDeque.h"
+
+using engine::core::WorkStealingDeque;
+
+TEST(WorkStealingDequeTest, OwnerPopsNewestThievesStealOldest) {
+  WorkStealingDeque<int> deque(4);
+  for (int i = 0; i < 3; i++) {
+    deque.Push(i);
+  }
+  int item = -1;
+  ASSERT_TRUE(deque.Steal(item));
+  EXPECT_EQ(item, 0);
+  ASSERT_TRUE(deque.Pop(item));
+  EXPECT_EQ(item, 2);
+  ASSERT_TRUE(deque.Pop(item));
+  EXPECT_EQ(item, 1);
+  EXPECT_FALSE(deque.Pop(item));
+  EXPECT_FALSE(deque.Steal(item));
+  EXPECT_TRUE(deque.Empty());
+}
+
+TEST(WorkStealingDequeTest, GrowsPastInitialCapacity) {
+  WorkStealingDeque<int> deque(2);
+  for (int i = 0; i < 1000; i++) {
+    deque.Push(i);
+  }
+  EXPECT_EQ(deque.size(), 1000U);
+  int item = -1;
+  for (int i = 999; i >= 0; i--) {
+    ASSERT_TRUE(deque.Pop(item));
+    EXPECT_EQ(item, i);
+  }
+}
+
+TEST(WorkStealingDequeTest, EveryItemIsTakenExactlyOnce) {
+  constexpr int kItems = 200000;
+  WorkStealingDeque<int> deque(4);
+  std::vector<std::atomic<int>> taken(kItems);
+  std::atomic<bool> done = false;
+  auto thief = [&] {
+    int item;
+    while (!done.load() || !deque.Empty()) {
+      if (deque.Steal(item)) {
+        taken[item]++;
+      }
+    }
+  };
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < 3; i++) {
+    thieves.emplace_back(thief);
+  }
+  int item;
+  for (int i = 0; i < kItems; i++) {
+    deque.Push(i);
+    if (i % 3 == 0 && deque.Pop(item)) {
+      taken[item]++;
+    }
+  }
+  while (deque.Pop(item)) {
+    taken[item]++;
+  }
+  done = true;
+  for (auto& thread : thieves) {
+    thread.join();
+  }
+  for (int i = 0; i < kItems; i++) {
+    ASSERT_EQ(taken[i].load(), 1) << "item " << i;
+  }
+}